@@ -0,0 +1,573 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * aggregate.c
+ *
+ * Read all the snapshots of a directory (as written by "-e bin", typically one
+ * per host) on a pool of threads and show rollups by file system type, mount
+ * point pattern and host, followed by the fullest file systems.
+ * Rows are never kept: each thread adds them up into its own rollups and top
+ * list as they are read, which are merged once all the files are read. Memory
+ * use thus depends on the number of groups, not on the number of rows.
+ */
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "aggregate.h"
+#include "dfc.h"
+#include "rollup.h"
+#include "snapshot.h"
+
+#ifdef NLS_ENABLED
+#include <libintl.h>
+#endif
+
+/* upper bound of the number of threads reading snapshots */
+#define AGG_MAXTHREADS 64
+
+/* one of the fullest file systems */
+struct top_entry {
+	char *fsname;
+	char *fstype;
+	char *where;		/* host:mount point */
+	double perctused;
+	uint64_t total;
+	uint64_t avail;
+	uint64_t used;
+	int64_t files;
+	int64_t favail;
+};
+
+/* min-heap of the AGG_TOPK fullest file systems */
+struct topk {
+	struct top_entry heap[AGG_TOPK];
+	size_t n;
+};
+
+/* state shared by all the threads */
+struct agg_shared {
+	pthread_mutex_t lock;	/* protects dir */
+	DIR *dir;
+	const char *path;
+	const char *fstfilter;
+	const char *fsnfilter;
+};
+
+/* state of one thread */
+struct agg_state {
+	struct agg_shared *shared;
+	struct rollup bytype;
+	struct rollup bymount;
+	struct rollup byhost;
+	struct topk top;
+	int err;
+};
+
+/* one line of the output */
+struct agg_row {
+	struct row r;
+	char count[32];
+};
+
+/* static function declaration */
+static void top_swap(struct topk *t, size_t i, size_t j);
+static void top_push(struct topk *t, struct top_entry *e);
+static void top_free_entry(struct top_entry *e);
+static int topcmp(const void *a, const void *b);
+static char *mount_pattern(const char *mntdir);
+static int add_row(void *arg, const char *host, char *const str[],
+    const uint64_t num[]);
+static char *next_file(struct agg_shared *shared);
+static void *worker(void *arg);
+static void state_init(struct agg_state *st, struct agg_shared *shared);
+static void state_merge(struct agg_state *dst, struct agg_state *src);
+static void state_free(struct agg_state *st);
+static void group_rows(struct agg_row *rows, size_t *n,
+    const struct rollup *r, const char *dimension);
+
+static void
+top_swap(struct topk *t, size_t i, size_t j)
+{
+	struct top_entry tmp = t->heap[i];
+
+	t->heap[i] = t->heap[j];
+	t->heap[j] = tmp;
+}
+
+/*
+ * Free the strings of a top entry
+ */
+static void
+top_free_entry(struct top_entry *e)
+{
+	free(e->fsname);
+	free(e->fstype);
+	free(e->where);
+}
+
+/*
+ * Add `e` to the fullest file systems if it is one of them. The top takes
+ * ownership of the strings of `e`, which are freed if it is not kept.
+ * @t: fullest file systems
+ * @e: file system to add
+ */
+static void
+top_push(struct topk *t, struct top_entry *e)
+{
+	size_t i, child;
+
+	if (t->n < AGG_TOPK) {
+		/* sift up */
+		i = t->n++;
+		t->heap[i] = *e;
+		while (i > 0 &&
+		    t->heap[i].perctused < t->heap[(i - 1) / 2].perctused) {
+			top_swap(t, i, (i - 1) / 2);
+			i = (i - 1) / 2;
+		}
+		return;
+	}
+
+	/* not fuller than the least full one kept */
+	if (e->perctused <= t->heap[0].perctused) {
+		top_free_entry(e);
+		return;
+	}
+
+	/* replace the least full one and sift down */
+	top_free_entry(&t->heap[0]);
+	t->heap[0] = *e;
+	for (i = 0; (child = 2 * i + 1) < t->n; i = child) {
+		if (child + 1 < t->n &&
+		    t->heap[child + 1].perctused < t->heap[child].perctused)
+			child++;
+		if (t->heap[i].perctused <= t->heap[child].perctused)
+			break;
+		top_swap(t, i, child);
+	}
+}
+
+/*
+ * Compare two top entries, fullest first
+ */
+static int
+topcmp(const void *a, const void *b)
+{
+	const struct top_entry *ea = a;
+	const struct top_entry *eb = b;
+
+	if (ea->perctused > eb->perctused)
+		return -1;
+	return ea->perctused < eb->perctused;
+}
+
+/*
+ * Return a pattern matching `mntdir` and similar mount points: every run of
+ * digits is replaced by a '*', so that /srv/disk1 and /srv/disk12 both give
+ * /srv/disk*. Return NULL if it fails.
+ * @mntdir: mount point
+ */
+static char *
+mount_pattern(const char *mntdir)
+{
+	char *pat, *p;
+
+	if ((pat = malloc(strlen(mntdir) + 1)) == NULL)
+		return NULL;
+
+	for (p = pat; *mntdir != '\0'; mntdir++) {
+		if (*mntdir >= '0' && *mntdir <= '9') {
+			if (p == pat || p[-1] != '*')
+				*p++ = '*';
+		} else {
+			*p++ = *mntdir;
+		}
+	}
+	*p = '\0';
+
+	return pat;
+}
+
+/*
+ * Add a row of a snapshot to the rollups and top of a thread
+ * Return -1 if it fails, 0 otherwise.
+ * @arg: state of the thread
+ * @host: name of the host the row was taken on
+ * @str: string columns of the row
+ * @num: numeric columns of the row
+ */
+static int
+add_row(void *arg, const char *host, char *const str[], const uint64_t num[])
+{
+	struct agg_state *st = arg;
+	struct fsmntinfo fmi = fmi_init();
+	struct rollup_entry val;
+	struct top_entry e;
+	char *pat;
+	size_t len;
+	int ret;
+
+	snapshot_fmi(&fmi, str, num);
+
+	if (is_filtered(&fmi, st->shared->fstfilter, st->shared->fsnfilter))
+		return 0;
+
+	(void)memset(&val, 0, sizeof(val));
+	val.count  = 1;
+	val.total  = (bigsize_t)fmi.total;
+	val.avail  = (bigsize_t)fmi.avail;
+	val.used   = (bigsize_t)fmi.used;
+	val.files  = (int64_t)fmi.files;
+	val.favail = (int64_t)fmi.favail;
+
+	if ((pat = mount_pattern(fmi.mntdir)) == NULL)
+		goto nomem;
+	ret = rollup_add(&st->bymount, pat, &val);
+	free(pat);
+	if (ret == -1 ||
+	    rollup_add(&st->bytype, fmi.fstype, &val) == -1 ||
+	    rollup_add(&st->byhost, host, &val) == -1)
+		goto nomem;
+
+	/* only copy the names of the fullest ones */
+	if (st->top.n == AGG_TOPK &&
+	    fmi.perctused <= st->top.heap[0].perctused)
+		return 0;
+
+	e.perctused = fmi.perctused;
+	e.total     = fmi.total;
+	e.avail     = fmi.avail;
+	e.used      = fmi.used;
+	e.files     = val.files;
+	e.favail    = val.favail;
+	e.fsname    = strdup(fmi.fsname);
+	e.fstype    = strdup(fmi.fstype);
+	len = strlen(host) + strlen(fmi.mntdir) + 2;
+	if ((e.where = malloc(len)) != NULL)
+		(void)snprintf(e.where, len, "%s:%s", host, fmi.mntdir);
+	if (e.fsname == NULL || e.fstype == NULL || e.where == NULL) {
+		top_free_entry(&e);
+		goto nomem;
+	}
+	top_push(&st->top, &e);
+
+	return 0;
+
+nomem:
+	(void)fputs("Error while allocating memory to aggregate snapshots\n",
+		stderr);
+	return -1;
+}
+
+/*
+ * Return the path of the next snapshot to read, NULL when there is none left
+ * or if it fails
+ * @shared: state shared by the threads
+ */
+static char *
+next_file(struct agg_shared *shared)
+{
+	struct dirent *ent;
+	char *path = NULL;
+	size_t len;
+
+	(void)pthread_mutex_lock(&shared->lock);
+	do {
+		ent = readdir(shared->dir);
+	} while (ent != NULL && ent->d_name[0] == '.');
+	if (ent != NULL) {
+		len = strlen(shared->path) + strlen(ent->d_name) + 2;
+		if ((path = malloc(len)) != NULL)
+			(void)snprintf(path, len, "%s/%s", shared->path,
+				ent->d_name);
+		else
+			(void)fputs("Error while allocating memory to "
+				"aggregate snapshots\n", stderr);
+	}
+	(void)pthread_mutex_unlock(&shared->lock);
+
+	return path;
+}
+
+/*
+ * Thread reading snapshots until there is none left
+ * @arg: state of the thread
+ */
+static void *
+worker(void *arg)
+{
+	struct agg_state *st = arg;
+	char *path;
+
+	while ((path = next_file(st->shared)) != NULL) {
+		if (read_snapshot_rows(path, add_row, st) == -1)
+			st->err = 1;
+		free(path);
+	}
+
+	return NULL;
+}
+
+static void
+state_init(struct agg_state *st, struct agg_shared *shared)
+{
+	(void)memset(st, 0, sizeof(*st));
+	st->shared = shared;
+	rollup_init(&st->bytype);
+	rollup_init(&st->bymount);
+	rollup_init(&st->byhost);
+}
+
+/*
+ * Merge the rollups and top of `src` into `dst`
+ */
+static void
+state_merge(struct agg_state *dst, struct agg_state *src)
+{
+	size_t i;
+
+	if (rollup_merge(&dst->bytype, &src->bytype) == -1 ||
+	    rollup_merge(&dst->bymount, &src->bymount) == -1 ||
+	    rollup_merge(&dst->byhost, &src->byhost) == -1) {
+		(void)fputs("Error while allocating memory to aggregate "
+			"snapshots\n", stderr);
+		dst->err = 1;
+	}
+
+	/* the entries now belong to dst */
+	for (i = 0; i < src->top.n; i++)
+		top_push(&dst->top, &src->top.heap[i]);
+	src->top.n = 0;
+
+	dst->err |= src->err;
+}
+
+static void
+state_free(struct agg_state *st)
+{
+	size_t i;
+
+	rollup_free(&st->bytype);
+	rollup_free(&st->bymount);
+	rollup_free(&st->byhost);
+	for (i = 0; i < st->top.n; i++)
+		top_free_entry(&st->top.heap[i]);
+	st->top.n = 0;
+}
+
+/*
+ * Append a row per group to `rows`, sorted by name
+ * @rows: rows to display
+ * @n: number of rows, updated
+ * @r: groups
+ * @dimension: what the groups are made on
+ */
+static void
+group_rows(struct agg_row *rows, size_t *n, const struct rollup *r,
+    const char *dimension)
+{
+	struct rollup_entry **groups;
+	struct agg_row *row;
+	size_t i;
+
+	if ((groups = rollup_sorted(r)) == NULL) {
+		(void)fputs("Error while allocating memory to aggregate "
+			"snapshots\n", stderr);
+		return;
+	}
+
+	for (i = 0; i < r->n; i++) {
+		row = &rows[(*n)++];
+		(void)snprintf(row->count, sizeof(row->count), "%lu fs",
+			groups[i]->count);
+		row->r.fsname    = strview(groups[i]->key);
+		row->r.fstype    = strview(dimension);
+		row->r.mntdir    = strview(row->count);
+		/* mount options do not make sense for groups */
+		row->r.mntopts   = strview("");
+		row->r.perctused = rollup_perct(groups[i]);
+		row->r.total     = groups[i]->total;
+		row->r.avail     = groups[i]->avail;
+		row->r.used      = groups[i]->used;
+		row->r.files     = groups[i]->files;
+		row->r.favail    = groups[i]->favail;
+	}
+
+	free(groups);
+}
+
+/*
+ * Read all the snapshots of a directory and display rollups by file system
+ * type, mount point pattern and host, followed by the fullest file systems.
+ * Return -1 if a snapshot could not be read, 0 otherwise.
+ * @path: directory of snapshots
+ * @fstfilter: fstype to filter (can be NULL)
+ * @fsnfilter: fsname to filter (can be NULL)
+ * @sinks: display structures
+ * @nsinks: number of display structures
+ */
+int
+disp_aggregate(const char *path, const char *fstfilter, const char *fsnfilter,
+    struct display *sinks, size_t nsinks)
+{
+	struct agg_shared shared;
+	struct agg_state *states;
+	struct agg_row *rows;
+	struct row *lines;
+	pthread_t *threads;
+	size_t nrows, i;
+	long nthreads, started;
+	struct row sum, r;
+	int ret;
+
+	if ((shared.dir = opendir(path)) == NULL) {
+		(void)fprintf(stderr, _("Cannot read directory %s"), path);
+		perror(" ");
+		return -1;
+	}
+	shared.path = path;
+	shared.fstfilter = fstfilter;
+	shared.fsnfilter = fsnfilter;
+	(void)pthread_mutex_init(&shared.lock, NULL);
+
+	/* reading snapshots is mostly waiting for I/O: one thread per CPU */
+	nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthreads < 1)
+		nthreads = 1;
+	else if (nthreads > AGG_MAXTHREADS)
+		nthreads = AGG_MAXTHREADS;
+
+	states = calloc((size_t)nthreads, sizeof(*states));
+	threads = calloc((size_t)nthreads, sizeof(*threads));
+	if (states == NULL || threads == NULL) {
+		(void)fputs("Error while allocating memory to aggregate "
+			"snapshots\n", stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+
+	for (started = 0; started < nthreads; started++) {
+		state_init(&states[started], &shared);
+		if (pthread_create(&threads[started], NULL, worker,
+		    &states[started]) != 0)
+			break;
+	}
+	for (i = 0; i < (size_t)started; i++)
+		(void)pthread_join(threads[i], NULL);
+
+	/* could not start any thread: do the work here */
+	if (started == 0) {
+		(void)worker(&states[0]);
+		started = 1;
+	}
+
+	for (i = 1; i < (size_t)started; i++) {
+		state_merge(&states[0], &states[i]);
+		state_free(&states[i]);
+	}
+
+	(void)pthread_mutex_destroy(&shared.lock);
+	(void)closedir(shared.dir);
+
+	qsort(states[0].top.heap, states[0].top.n, sizeof(struct top_entry),
+		topcmp);
+
+	nrows = states[0].bytype.n + states[0].bymount.n + states[0].byhost.n +
+		states[0].top.n;
+	if ((rows = calloc(nrows + 1, sizeof(*rows))) == NULL ||
+	    (lines = calloc(nrows + 1, sizeof(*lines))) == NULL) {
+		(void)fputs("Error while allocating memory to aggregate "
+			"snapshots\n", stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+
+	nrows = 0;
+	group_rows(rows, &nrows, &states[0].bytype, "type");
+	group_rows(rows, &nrows, &states[0].bymount, "mount");
+	group_rows(rows, &nrows, &states[0].byhost, "host");
+	for (i = 0; i < states[0].top.n; i++) {
+		struct top_entry *e = &states[0].top.heap[i];
+
+		rows[nrows].r.fsname    = strview(e->fsname);
+		rows[nrows].r.fstype    = strview("top");
+		rows[nrows].r.mntdir    = strview(e->where);
+		rows[nrows].r.mntopts   = strview("");
+		rows[nrows].r.perctused = e->perctused;
+		rows[nrows].r.total     = (bigsize_t)e->total;
+		rows[nrows].r.avail     = (bigsize_t)e->avail;
+		rows[nrows].r.used      = (bigsize_t)e->used;
+		rows[nrows].r.files     = e->files;
+		rows[nrows].r.favail    = e->favail;
+		nrows++;
+	}
+
+	/* widths were not computed while reading */
+	init_maxwidths();
+	for (i = 0; i < nrows; i++) {
+		row_maxwidth(&rows[i].r);
+		lines[i] = rows[i].r;
+	}
+
+	/* every file system is in exactly one group of each rollup */
+	if (sflag) {
+		row_sum_init(&sum);
+		for (i = 0; i < states[0].bytype.nslots; i++) {
+			const struct rollup_entry *e = &states[0].bytype.slots[i];
+
+			if (e->key == NULL)
+				continue;
+			r.total  = e->total;
+			r.avail  = e->avail;
+			r.used   = e->used;
+			r.files  = e->files;
+			r.favail = e->favail;
+			row_add(&sum, &r);
+		}
+	}
+
+	ret = disp_table(sinks, nsinks, lines, nrows, sflag ? &sum : NULL);
+	if (states[0].err)
+		ret = -1;
+
+	free(lines);
+	free(rows);
+	state_free(&states[0]);
+	free(states);
+	free(threads);
+
+	return ret;
+}
@@ -0,0 +1,657 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * column.c
+ *
+ * Table of the columns which can be shown. The columns to show are chosen
+ * once, from the options or from --output, and every line is displayed by
+ * going through them: each one hands its value to the display interface
+ * according to its kind, so that exports do not need to know about columns
+ * (except for their title and key).
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "column.h"
+#include "extern.h"
+#include "util.h"
+#include "export/display.h"
+
+#ifdef NLS_ENABLED
+#include <libintl.h>
+#endif
+
+/* static function declaration */
+static void render_source(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_fstype(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_bar(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_pcent(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_used(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_avail(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_size(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_held(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_itotal(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_iavail(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_iused(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_ipcent(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_target(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_namespaces(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_options(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static void render_status(struct display *sdisp,
+    const struct column *col, const struct row *r);
+static int text_width(const struct strview *s, int shorten);
+static void add_column(struct display *sdisp, enum column_id id);
+
+static const struct column column_table[COL_NCOLUMNS] = {
+	{ COL_SOURCE, "source", N_("FILESYSTEM"), "filesystem", COLK_TEXT,
+	    &max.fsname, render_source },
+	{ COL_FSTYPE, "fstype", N_("TYPE"), "type", COLK_TEXT,
+	    &max.fstype, render_fstype },
+	{ COL_BAR, "bar", N_("USAGE"), "bar", COLK_BAR,
+	    &max.bar, render_bar },
+	{ COL_PCENT, "pcent", N_("%USED"), "usage", COLK_PERCT,
+	    &max.perctused, render_pcent },
+	{ COL_USED, "used", N_("USED"), "used", COLK_SIZE,
+	    &max.used, render_used },
+	{ COL_AVAIL, "avail", N_("AVAILABLE"), "available", COLK_SIZE,
+	    &max.avail, render_avail },
+	{ COL_SIZE, "size", N_("TOTAL"), "total", COLK_SIZE,
+	    &max.total, render_size },
+	{ COL_HELD, "held", N_("HELD"), "held", COLK_SIZE,
+	    &max.held, render_held },
+	{ COL_ITOTAL, "itotal", N_("#INODES"), "inodes_count", COLK_COUNT,
+	    &max.nbinodes, render_itotal },
+	{ COL_IAVAIL, "iavail", N_("AV.INODES"), "inodes_available",
+	    COLK_COUNT, &max.avinodes, render_iavail },
+	{ COL_IUSED, "iused", N_("US.INODES"), "inodes_used", COLK_COUNT,
+	    &max.usinodes, render_iused },
+	{ COL_IPCENT, "ipcent", N_("%IUSED"), "inodes_usage", COLK_PERCT,
+	    &max.perctinodes, render_ipcent },
+	{ COL_TARGET, "target", N_("MOUNTED ON"), "mount_point", COLK_TEXT,
+	    &max.mntdir, render_target },
+	{ COL_NAMESPACES, "namespaces", N_("NAMESPACES"), "namespaces",
+	    COLK_TEXT, &max.namespaces, render_namespaces },
+	{ COL_OPTIONS, "options", N_("MOUNT OPTIONS"), "mount_options",
+	    COLK_TEXT, &max.mntopts, render_options },
+	{ COL_STATUS, "status", N_("STATUS"), "status", COLK_TEXT,
+	    &max.status, render_status }
+};
+
+static void
+render_source(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_text(sdisp, col, r->fsname.str, r->fsname.len);
+}
+
+static void
+render_fstype(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_text(sdisp, col, r->fstype.str, r->fstype.len);
+}
+
+static void
+render_bar(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_bar(sdisp, col, r->perctused);
+}
+
+static void
+render_pcent(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_perct(sdisp, col, r->perctused);
+}
+
+static void
+render_used(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_size(sdisp, col, r->used, r->perctused);
+}
+
+static void
+render_avail(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_size(sdisp, col, r->avail, r->perctused);
+}
+
+static void
+render_size(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_size(sdisp, col, r->total, r->perctused);
+}
+
+static void
+render_held(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_size(sdisp, col, r->held, r->perctused);
+}
+
+static void
+render_itotal(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_count(sdisp, col, r->files);
+}
+
+static void
+render_iavail(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_count(sdisp, col, r->favail);
+}
+
+static void
+render_iused(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_count(sdisp, col, r->files - r->favail);
+}
+
+static void
+render_ipcent(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_perct(sdisp, col, row_ipcent(r));
+}
+
+static void
+render_target(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_text(sdisp, col, r->mntdir.str, r->mntdir.len);
+}
+
+static void
+render_namespaces(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_text(sdisp, col, r->namespaces.str, r->namespaces.len);
+}
+
+static void
+render_options(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_text(sdisp, col, r->mntopts.str, r->mntopts.len);
+}
+
+static void
+render_status(struct display *sdisp, const struct column *col,
+    const struct row *r)
+{
+	sdisp->print_text(sdisp, col, r->status.str, r->status.len);
+}
+
+/*
+ * Return the percentage of inodes in use of a line
+ * @r: line
+ */
+double
+row_ipcent(const struct row *r)
+{
+	if (r->files <= 0)
+		return 0.0;
+
+	return (double)(r->files - r->favail) / (double)r->files * 100.0;
+}
+
+/*
+ * Return the level of a line given the thresholds of its file system: the
+ * higher one of its bytes and of its inodes
+ * @r: line
+ */
+enum level
+row_level(const struct row *r)
+{
+	const struct limits *lim;
+	enum level level, ilevel;
+
+	lim = r->lim != NULL ? r->lim : policy_default();
+	level = policy_level(lim, r->perctused, 0);
+	if (r->files > 0) {
+		ilevel = policy_level(lim, row_ipcent(r), 1);
+		if (ilevel > level)
+			level = ilevel;
+	}
+
+	return level;
+}
+
+/*
+ * Return the width required to show a string, 0 for none
+ * @s: string
+ * @shorten: whether the string is shortened to STRMAXLEN when displayed
+ */
+static int
+text_width(const struct strview *s, int shorten)
+{
+	size_t len = s->len;
+
+	if (s->str == NULL)
+		return 0;
+	if (shorten && len > STRMAXLEN)
+		len = STRMAXLEN;
+
+	/* + 1 for a space between each column */
+	return (int)len + 1;
+}
+
+/*
+ * Show a column after the ones already shown, unless it already is
+ * @sdisp: display interface
+ * @id: column
+ */
+static void
+add_column(struct display *sdisp, enum column_id id)
+{
+	if (!column_shown(sdisp, id))
+		sdisp->columns[sdisp->ncolumns++] = &column_table[id];
+}
+
+/*
+ * Choose the columns to show, either from the options (-T, -b, -d, -i, -M,
+ * -o, --held) or from a comma separated list of column names (--output). The
+ * status of differences is always shown last with --diff and the bar is never
+ * shown by exports which cannot draw it.
+ * Return -1 if a column name is unknown or cannot be filled, 0 otherwise.
+ * @sdisp: display interface in use
+ * @spec: argument of --output, NULL to use the options
+ */
+int
+columns_init(struct display *sdisp, const char *spec)
+{
+	size_t len;
+	int i;
+
+	sdisp->ncolumns = 0;
+
+	if (spec == NULL) {
+		add_column(sdisp, COL_SOURCE);
+		if (Tflag)
+			add_column(sdisp, COL_FSTYPE);
+		if (!bflag)
+			add_column(sdisp, COL_BAR);
+		add_column(sdisp, COL_PCENT);
+		if (dflag)
+			add_column(sdisp, COL_USED);
+		add_column(sdisp, COL_AVAIL);
+		add_column(sdisp, COL_SIZE);
+		if (heldflag)
+			add_column(sdisp, COL_HELD);
+		if (iflag) {
+			add_column(sdisp, COL_ITOTAL);
+			add_column(sdisp, COL_IAVAIL);
+		}
+		if (!Mflag)
+			add_column(sdisp, COL_TARGET);
+		if (allnsflag)
+			add_column(sdisp, COL_NAMESPACES);
+		if (oflag)
+			add_column(sdisp, COL_OPTIONS);
+	}
+
+	while (spec != NULL && *spec != '\0') {
+		len = strcspn(spec, ",");
+		for (i = 0; i < COL_NCOLUMNS; i++) {
+			if (strlen(column_table[i].name) == len &&
+			    strncmp(spec, column_table[i].name, len) == 0)
+				break;
+		}
+		if (i == COL_NCOLUMNS) {
+			(void)fprintf(stderr, _("--output: unknown column "
+				"%.*s\n"), (int)len, spec);
+			return -1;
+		}
+		/* the deleted files are only looked for with --held */
+		if (i == COL_HELD && !heldflag) {
+			(void)fputs(_("--output: the held column needs "
+				"--held\n"), stderr);
+			return -1;
+		}
+		if (i == COL_NAMESPACES && !allnsflag) {
+			(void)fputs(_("--output: the namespaces column needs "
+				"--all-namespaces\n"), stderr);
+			return -1;
+		}
+		add_column(sdisp, (enum column_id)i);
+		spec += len;
+		if (*spec == ',')
+			spec++;
+	}
+
+	if (diffflag)
+		add_column(sdisp, COL_STATUS);
+	if (sdisp->print_bar == NULL)
+		(void)column_drop(sdisp, COL_BAR);
+
+	return 0;
+}
+
+/*
+ * Tell whether a column is shown
+ * Return 1 if it is, 0 otherwise.
+ * @sdisp: display interface
+ * @id: column
+ */
+int
+column_shown(const struct display *sdisp, enum column_id id)
+{
+	size_t i;
+
+	for (i = 0; i < sdisp->ncolumns; i++) {
+		if (sdisp->columns[i]->id == id)
+			return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Return the title of a column, translated the first time it is asked for
+ * @col: column
+ */
+const char *
+column_title(const struct column *col)
+{
+	static const char *titles[COL_NCOLUMNS];
+
+	if (titles[col->id] == NULL)
+		titles[col->id] = _(col->title);
+
+	return titles[col->id];
+}
+
+/*
+ * Set the width required by each column to the one of its title, + 1 to have
+ * a space between each column. The bar is left alone. Titles are not
+ * translated when only machine readable formats, which do not align columns,
+ * are exported.
+ */
+void
+column_title_widths(void)
+{
+	const struct column *col;
+	size_t i;
+
+	for (i = 0; i < COL_NCOLUMNS; i++) {
+		col = &column_table[i];
+		if (col->kind == COLK_BAR)
+			continue;
+		*col->width = (int)strlen(rawflag ? col->title :
+		    column_title(col)) + 1;
+	}
+}
+
+/*
+ * Stop showing a column
+ * Return the width it took in text export, 0 if it was not shown.
+ * @sdisp: display interface
+ * @id: column
+ */
+int
+column_drop(struct display *sdisp, enum column_id id)
+{
+	size_t i;
+	int width;
+
+	for (i = 0; i < sdisp->ncolumns; i++) {
+		if (sdisp->columns[i]->id == id)
+			break;
+	}
+	if (i == sdisp->ncolumns)
+		return 0;
+
+	width = *sdisp->columns[i]->width;
+	for (sdisp->ncolumns--; i < sdisp->ncolumns; i++)
+		sdisp->columns[i] = sdisp->columns[i + 1];
+
+	return width;
+}
+
+/*
+ * Return a view of a string
+ * @str: string, may be NULL
+ */
+struct strview
+strview(const char *str)
+{
+	struct strview s;
+
+	s.str = str;
+	s.len = str == NULL ? 0 : strlen(str);
+
+	return s;
+}
+
+/*
+ * Fill a line with the information about a file system
+ * @r: line to fill
+ * @p: file system
+ */
+void
+row_of_fmi(struct row *r, const struct fsmntinfo *p)
+{
+	r->fsname    = strview(p->fsname);
+	r->fstype    = strview(p->fstype);
+	r->mntdir    = strview(p->mntdir);
+	r->mntopts   = strview(p->mntopts);
+	r->namespaces = strview(p->namespaces);
+	r->status    = strview(NULL);
+	r->perctused = p->perctused;
+	r->used      = (bigsize_t)p->used;
+	r->avail     = (bigsize_t)p->avail;
+	r->total     = (bigsize_t)p->total;
+	r->held      = (bigsize_t)p->held;
+	r->files     = (int64_t)p->files;
+#if defined(__linux__) || defined(__GLIBC__)
+	r->favail    = (int64_t)p->favail;
+#else
+	r->favail    = (int64_t)p->ffree;
+#endif /* __linux__ */
+	r->lim       = policy_match(p->fsname, p->fstype, p->mntdir);
+	r->sum       = 0;
+}
+
+/*
+ * Start the sum of the lines (-s)
+ * @sum: sum of the lines
+ */
+void
+row_sum_init(struct row *sum)
+{
+	static const char *label = NULL;
+
+	/* machine readable formats do not display it */
+	if (label == NULL)
+		label = rawflag ? "SUM:" : _("SUM:");
+
+	(void)memset(sum, 0, sizeof(*sum));
+	sum->fsname = strview(label);
+	sum->perctused = 100.0;
+	sum->sum = 1;
+}
+
+/*
+ * Add the sizes and inodes of a line to the sum of the lines, which usage is
+ * computed again
+ * @sum: sum of the lines (see row_sum_init)
+ * @r: line to add
+ */
+void
+row_add(struct row *sum, const struct row *r)
+{
+	sum->used   += r->used;
+	sum->avail  += r->avail;
+	sum->total  += r->total;
+	sum->held   += r->held;
+	sum->files  += r->files;
+	sum->favail += r->favail;
+
+	if (sum->total == 0)
+		sum->perctused = 100.0;
+	else
+		sum->perctused = (double)sum->used / (double)sum->total *
+			100.0;
+}
+
+/*
+ * Update the widths required by the columns in text export to show a line
+ * @r: line
+ */
+void
+row_maxwidth(const struct row *r)
+{
+	char buf[SIZE_BUFLEN];
+
+	max.fsname = imax(text_width(&r->fsname, !Wflag), max.fsname);
+	max.fstype = imax(text_width(&r->fstype, !Wflag), max.fstype);
+	max.mntdir = imax(text_width(&r->mntdir, !Wflag), max.mntdir);
+	max.namespaces = imax(text_width(&r->namespaces, 0), max.namespaces);
+	max.mntopts = imax(text_width(&r->mntopts, 0), max.mntopts);
+	max.status = imax(text_width(&r->status, 0), max.status);
+
+	max.used = imax(get_req_width(r->used), max.used);
+	max.avail = imax(get_req_width(r->avail), max.avail);
+	max.total = imax(get_req_width(r->total), max.total);
+	max.held = imax(get_req_width(r->held), max.held);
+
+	fmt_count(buf, sizeof(buf), r->files);
+	max.nbinodes = imax(2 + (int)strlen(buf), max.nbinodes);
+	fmt_count(buf, sizeof(buf), r->favail);
+	max.avinodes = imax(3 + (int)strlen(buf), max.avinodes);
+	fmt_count(buf, sizeof(buf), r->files - r->favail);
+	max.usinodes = imax(2 + (int)strlen(buf), max.usinodes);
+}
+
+/*
+ * Display a line, going through the columns shown
+ * @sdisp: display interface
+ * @r: line
+ */
+void
+print_row(struct display *sdisp, const struct row *r)
+{
+	const struct column *const *columns = sdisp->columns;
+	size_t i, n = sdisp->ncolumns;
+
+	/* the sum has no strings but its name: leave out the last ones */
+	while (r->sum && n > 0 && columns[n - 1]->kind == COLK_TEXT &&
+	    columns[n - 1]->id != COL_SOURCE)
+		n--;
+
+	sdisp->in_sum = r->sum;
+	sdisp->lim = r->lim != NULL ? r->lim : policy_default();
+	sdisp->first_cell = 1;
+	sdisp->print_ln_start(sdisp, r);
+	for (i = 0; i < n; i++) {
+		if (i > 0)
+			sdisp->print_sep(sdisp, columns[i - 1], columns[i]);
+		columns[i]->render(sdisp, columns[i], r);
+	}
+	sdisp->print_ln_end(sdisp);
+	sdisp->nlines++;
+}
+
+/*
+ * Start a table, which lines are then displayed one by one (see print_row)
+ * @sdisp: display interface
+ */
+void
+print_table_start(struct display *sdisp)
+{
+	sdisp->nlines = 0;
+	sdisp->in_sum = 0;
+
+	/* only required for html, json, tex and bin export */
+	if (sdisp->init)
+		sdisp->init(sdisp);
+
+	/* legend on top */
+	if (!nflag)
+		sdisp->print_header(sdisp);
+}
+
+/*
+ * End a table started with print_table_start
+ * @sdisp: display interface
+ * @sum: sum of the lines, NULL not to display it
+ */
+void
+print_table_end(struct display *sdisp, const struct row *sum)
+{
+	if (sum != NULL)
+		print_row(sdisp, sum);
+
+	if (sdisp->deinit)
+		sdisp->deinit(sdisp);
+}
+
+/*
+ * Display a whole table: header, lines and their sum
+ * @sdisp: display interface
+ * @rows: lines
+ * @n: number of lines
+ * @sum: sum of the lines, NULL not to display it
+ */
+void
+print_table(struct display *sdisp, const struct row *rows, size_t n,
+    const struct row *sum)
+{
+	size_t i;
+
+	print_table_start(sdisp);
+	for (i = 0; i < n; i++)
+		print_row(sdisp, &rows[i]);
+	print_table_end(sdisp, sum);
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef H_COLUMN
+#define H_COLUMN
+/*
+ * column.h
+ *
+ * Columns of the table and the lines they are made of
+ */
+
+#include <stddef.h>
+
+#include "list.h"
+#include "policy.h"
+
+/* names longer than this are shortened in text export (see --truncate) */
+#define STRMAXLEN 24
+
+/* columns which can be shown, in their default order */
+enum column_id {
+	COL_SOURCE = 0,
+	COL_FSTYPE,
+	COL_BAR,
+	COL_PCENT,
+	COL_USED,
+	COL_AVAIL,
+	COL_SIZE,
+	COL_HELD,
+	COL_ITOTAL,
+	COL_IAVAIL,
+	COL_IUSED,
+	COL_IPCENT,
+	COL_TARGET,
+	COL_NAMESPACES,
+	COL_OPTIONS,
+	COL_STATUS,
+	COL_NCOLUMNS
+};
+
+/* how the values of a column are shown */
+enum column_kind {
+	COLK_TEXT,	/* left aligned string */
+	COLK_BAR,	/* usage graph */
+	COLK_PERCT,	/* percentage */
+	COLK_SIZE,	/* size in bytes */
+	COLK_COUNT	/* number of inodes */
+};
+
+/*
+ * String of a line and its length, computed once: it points to the string of
+ * the file system, which is neither copied nor shortened
+ */
+struct strview {
+	const char *str;	/* NULL for none */
+	size_t len;
+};
+
+/* values of a line of the table, whatever it is made from */
+struct row {
+	struct strview fsname;
+	struct strview fstype;
+	struct strview mntdir;
+	struct strview mntopts;
+	struct strview namespaces;	/* NULL unless --all-namespaces */
+	struct strview status;	/* NULL unless showing differences */
+	double perctused;
+	bigsize_t used;
+	bigsize_t avail;
+	bigsize_t total;
+	bigsize_t held;		/* held by deleted files still open */
+	int64_t files;
+	int64_t favail;
+	/* thresholds of the usage, NULL for the default ones */
+	const struct limits *lim;
+	int sum;		/* 1 for the sum of the other lines (-s) */
+};
+
+struct display;
+
+struct column {
+	enum column_id id;
+	const char *name;	/* name given to --output */
+	const char *title;	/* header, to be translated */
+	const char *key;	/* key in JSON export */
+	enum column_kind kind;
+	int *width;		/* width required in text export */
+	/* show the value of a line through the display interface */
+	void (*render)(struct display *, const struct column *,
+	    const struct row *);
+};
+
+/* function declaration */
+int columns_init(struct display *sdisp, const char *spec);
+int column_shown(const struct display *sdisp, enum column_id id);
+int column_drop(struct display *sdisp, enum column_id id);
+const char *column_title(const struct column *col);
+void column_title_widths(void);
+struct strview strview(const char *str);
+void row_of_fmi(struct row *r, const struct fsmntinfo *p);
+double row_ipcent(const struct row *r);
+enum level row_level(const struct row *r);
+void row_sum_init(struct row *sum);
+void row_add(struct row *sum, const struct row *r);
+void row_maxwidth(const struct row *r);
+void print_row(struct display *sdisp, const struct row *r);
+void print_table_start(struct display *sdisp);
+void print_table_end(struct display *sdisp, const struct row *sum);
+void print_table(struct display *sdisp, const struct row *rows, size_t n,
+    const struct row *sum);
+
+#endif /* ndef H_COLUMN */
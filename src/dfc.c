@@ -35,15 +35,27 @@
  * Displays free disk space in an elegant manner.
  */
 
+#include <errno.h>
+#include <getopt.h>
+#include <limits.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "aggregate.h"
 #include "dfc.h"
+#include "diff.h"
+#include "drill.h"
+#include "events.h"
+#include "held.h"
+#include "groupby.h"
+#include "snapshot.h"
+#include "sortkey.h"
+#include "where.h"
 
 #ifdef NLS_ENABLED
-#include <locale.h>
 #include <libintl.h>
 #endif /* NLS_ENABLED */
 
@@ -55,14 +67,59 @@ struct maxwidths max;
 int aflag, bflag, cflag, dflag, eflag, fflag, hflag, iflag, lflag, mflag,
     nflag, oflag, pflag, qflag, sflag, tflag, uflag, vflag, wflag;
 int Mflag, Tflag, Wflag;
+int truncflag;
+int rawflag;
+int diffflag;
+int automountflag;
+int watchflag;
+int heldflag;
+int allnsflag;
 char unitflag;
 
+/* table displayed while the file systems are fetched (see stream_start) */
+struct stream {
+	struct display *sinks;
+	size_t nsinks;
+	char *tmp[MAXSINKS];	/* file written by each display, if any */
+	const char *fstfilter;
+	const char *fsnfilter;
+	struct row sum;
+	size_t nhigh;		/* lines at their high threshold */
+	int ret;		/* -1 if an export could not be written */
+};
+
+/* first file systems kept while they are fetched (see select_fs) */
+struct selection {
+	struct sort_heap heap;
+	const char *fstfilter;
+	const char *fsnfilter;
+	double over;		/* usage threshold, negative for none */
+	size_t nover;		/* file systems over the threshold */
+};
+
+/* static function declaration */
+static int parse_sinks(char *arg, struct display *sinks, int *textout);
+static int sink_open(struct display *d, char **tmp);
+static int sink_close(struct display *d, char *tmp);
+static void stream_start(struct stream *st, struct display *sinks,
+    size_t nsinks, const char *fstfilter, const char *fsnfilter);
+static int stream_fs(void *arg, struct fsmntinfo *p);
+static int stream_end(struct stream *st);
+static void stream_abort(struct stream *st);
+static int select_fs(void *arg, struct fsmntinfo *p);
+static size_t check_list(const struct list *lst);
+
 int
 main(int argc, char *argv[])
 {
 	struct list queue;
-	struct display sdisp;
-	int ch;
+	struct stream st;
+	struct selection sel;
+	struct display sinks[MAXSINKS];
+	size_t nsinks = 0, nover, i;
+	int ch, n;
+	int textout = 1;
+	int streamed, selected;
 	int tty_width;
 	int ret = EXIT_SUCCESS;
 	char *fsnfilter = NULL;
@@ -70,20 +127,78 @@ main(int argc, char *argv[])
 	char *subopts;
 	char *value;
 	char *cfgfile;
+	FILE *cfgfd;
+	char *snapfile = NULL;
+	char *diffold = NULL;
+	char *aggdir = NULL;
+	char *drilldir = NULL;
+	long depth = -1;
+	char *end;
+	int nsflag = 0;
+	long nspid = 0;
+	char *rootdir = NULL;
+	long interval = 0, count = 0, sample;
+	int eventsflag = 0;
+	struct groupby groupby;
+	int gflag = 0;
+	long top = 0;
+	double over = -1.0;
+	int checkflag = 0;
+	char *outspec = NULL;
+
+	/* long only options, out of the range of the short ones */
+	enum {
+		OREAD = 256,
+		ODIFF,
+		OAGGREGATE,
+		OALLNS,
+		OPID,
+		OROOT,
+		OAUTOMOUNT,
+		OWATCH,
+		OCOUNT,
+		OGROUPBY,
+		OTOP,
+		OOVER,
+		OWHERE,
+		OOUTPUT,
+		OTRUNCATE,
+		OEVENTS,
+		OCHECK,
+		OHELD,
+		ODRILL,
+		ODEPTH
+	};
+
+	static const struct option long_opts[] = {
+		{ "read", required_argument, NULL, OREAD },
+		{ "diff", required_argument, NULL, ODIFF },
+		{ "aggregate", required_argument, NULL, OAGGREGATE },
+		{ "all-namespaces", no_argument, NULL, OALLNS },
+		{ "pid", required_argument, NULL, OPID },
+		{ "root", required_argument, NULL, OROOT },
+		{ "automount", no_argument, NULL, OAUTOMOUNT },
+		{ "watch", required_argument, NULL, OWATCH },
+		{ "count", required_argument, NULL, OCOUNT },
+		{ "group-by", required_argument, NULL, OGROUPBY },
+		{ "top", required_argument, NULL, OTOP },
+		{ "over", required_argument, NULL, OOVER },
+		{ "where", required_argument, NULL, OWHERE },
+		{ "output", required_argument, NULL, OOUTPUT },
+		{ "truncate", required_argument, NULL, OTRUNCATE },
+		{ "events", no_argument, NULL, OEVENTS },
+		{ "check", no_argument, NULL, OCHECK },
+		{ "held", no_argument, NULL, OHELD },
+		{ "drill", required_argument, NULL, ODRILL },
+		{ "depth", required_argument, NULL, ODEPTH },
+		{ NULL, 0, NULL, 0 }
+	};
 
 	/* enum for suboptions flags; first letter corresponds to option flag */
 	enum {
 		CALWAYS = 0,
 		CNEVER = 1,
 		CAUTO = 2,
-		ETEXT = 0,
-		ECSV = 1,
-		EHTML = 2,
-		ETEX = 3,
-		EJSON = 4,
-		SFSNAME = 0,
-		SFSTYPE = 1,
-		SFSDIR = 2,
 		UH = 0,
 		UB = 1,
 		UK = 2,
@@ -106,30 +221,6 @@ main(int argc, char *argv[])
 		NULL
 	};
 
-	static char text_str[] = "text";
-	static char csv_str[] = "csv";
-	static char html_str[] = "html";
-	static char tex_str[] = "tex";
-	static char json_str[] = "json";
-	char *const export_opts[] = {
-		text_str,
-		csv_str,
-		html_str,
-		tex_str,
-		json_str,
-		NULL
-	};
-
-	static char name_str[] = "name";
-	static char type_str[] = "type";
-	static char mount_str[] = "mount";
-	char *const sort_opts[] = {
-		name_str,
-		type_str,
-		mount_str,
-		NULL
-	};
-
 	static char h_str[] = "h";
 	static char b_str[] = "b";
 	static char k_str[] = "k";
@@ -154,26 +245,6 @@ main(int argc, char *argv[])
 		NULL
 	};
 
-#ifdef NLS_ENABLED
-	/* translation support */
-	if (setlocale(LC_ALL, "") == NULL) {
-		(void)fputs("Locale cannot be set\n", stderr);
-		ret = EXIT_FAILURE;
-	}
-	if (bindtextdomain(PACKAGE, LOCALEDIR) == NULL) {
-		(void)fputs("Cannot bind locale\n", stderr);
-		ret = EXIT_FAILURE;
-	}
-	if (bind_textdomain_codeset(PACKAGE, "") == NULL) {
-		(void)fputs("Cannot bind locale codeset\n", stderr);
-		ret = EXIT_FAILURE;
-	}
-	if (textdomain(PACKAGE) == NULL) {
-		(void)fputs("Cannot set translation domain\n", stderr);
-		ret = EXIT_FAILURE;
-	}
-#endif /* NLS_ENABLED */
-
 	/* default value for those globals */
 	cflag = 1; /* color enabled by default */
 
@@ -187,7 +258,8 @@ main(int argc, char *argv[])
 	 /* Init default colors and symbol sign */
 	init_conf(&cnf);
 
-	while ((ch = getopt(argc, argv, "abc:de:fhilmMnop:q:st:Tu:vwW")) != -1) {
+	while ((ch = getopt_long(argc, argv, "abc:de:fhilmMnop:q:st:Tu:vwW",
+					long_opts, NULL)) != -1) {
 		switch (ch) {
 		case 'a':
 			aflag = 1;
@@ -222,38 +294,12 @@ main(int argc, char *argv[])
 			dflag = 1;
 			break;
 		case 'e':
-			eflag = 1;
-			subopts = optarg;
-			while (*subopts) {
-				switch (getsubopt(&subopts, export_opts, &value)) {
-				case ETEXT:
-					eflag = 0;
-					break;
-				case ECSV:
-					Wflag = 1;
-					init_disp_csv(&sdisp);
-					break;
-				case EHTML:
-					Wflag = 1;
-					init_disp_html(&sdisp);
-					break;
-				case ETEX:
-					Wflag = 1;
-					init_disp_tex(&sdisp);
-					break;
-				case EJSON:
-					Wflag = 1;
-					init_disp_json(&sdisp);
-					break;
-				case -1: /* FALLTHROUGH */
-				default:
-					(void)fprintf(stderr,
-						_("-e: illegal sub option %s\n"),
-						subopts);
-					ret = EXIT_FAILURE;
-					goto out;
-				}
+			/* the last -e wins, as for any other option */
+			if ((n = parse_sinks(optarg, sinks, &textout)) == -1) {
+				ret = EXIT_FAILURE;
+				goto out;
 			}
+			nsinks = (size_t)n;
 			break;
 		case 'f':
 			fflag = 1;
@@ -284,27 +330,14 @@ main(int argc, char *argv[])
 			fsnfilter = strdup(optarg);
 			break;
 		case 'q':
-			subopts = optarg;
-			while (*subopts) {
-				switch (getsubopt(&subopts, sort_opts, &value)) {
-				case SFSNAME:
-					qflag = 1;
-					break;
-				case SFSTYPE:
-					qflag = 2;
-					break;
-				case SFSDIR:
-					qflag = 3;
-					break;
-				case -1: /* FALLTHROUGH */
-				default:
-					(void)fprintf(stderr,
-						_("-q: illegal sub option %s\n"),
-						subopts);
-					ret = EXIT_FAILURE;
-					goto out;
-				}
+			if (sort_parse(optarg) == -1) {
+				(void)fprintf(stderr,
+					_("-q: illegal sub option %s\n"),
+					optarg);
+				ret = EXIT_FAILURE;
+				goto out;
 			}
+			qflag = 1;
 			break;
 		case 's':
 			sflag = 1;
@@ -376,6 +409,140 @@ main(int argc, char *argv[])
 		case 'W':
 			Wflag = 1;
 			break;
+		case OREAD:
+			free(snapfile);
+			snapfile = strdup(optarg);
+			break;
+		case ODIFF:
+			diffflag = 1;
+			diffold = optarg;
+			break;
+		case OAGGREGATE:
+			aggdir = optarg;
+			break;
+		case OALLNS:
+			nsflag = allnsflag = 1;
+			nspid = 0;
+			break;
+		case OPID:
+			nsflag = 1;
+			allnsflag = 0;
+			errno = 0;
+			nspid = strtol(optarg, &end, 10);
+			if (errno != 0 || *end != '\0' || end == optarg ||
+			    nspid <= 0) {
+				(void)fprintf(stderr,
+					_("--pid: illegal process id %s\n"),
+					optarg);
+				usage(EXIT_FAILURE);
+				/* NOTREACHED */
+			}
+			break;
+		case OROOT:
+			rootdir = optarg;
+			break;
+		case OAUTOMOUNT:
+			automountflag = 1;
+			break;
+		case OWATCH: /* FALLTHROUGH */
+		case OCOUNT:
+			errno = 0;
+			sample = strtol(optarg, &end, 10);
+			if (errno != 0 || *end != '\0' || end == optarg ||
+			    sample <= 0 || sample > INT_MAX) {
+				(void)fprintf(stderr,
+					_("--%s: illegal value %s\n"),
+					ch == OWATCH ? "watch" : "count",
+					optarg);
+				usage(EXIT_FAILURE);
+				/* NOTREACHED */
+			}
+			if (ch == OWATCH)
+				interval = sample;
+			else
+				count = sample;
+			break;
+		case OGROUPBY:
+			if (groupby_parse(optarg, &groupby) == -1) {
+				(void)fprintf(stderr,
+					_("--group-by: illegal group %s\n"),
+					optarg);
+				usage(EXIT_FAILURE);
+				/* NOTREACHED */
+			}
+			gflag = 1;
+			break;
+		case OTOP:
+			errno = 0;
+			top = strtol(optarg, &end, 10);
+			if (errno != 0 || *end != '\0' || end == optarg ||
+			    top <= 0) {
+				(void)fprintf(stderr,
+					_("--top: illegal value %s\n"), optarg);
+				usage(EXIT_FAILURE);
+				/* NOTREACHED */
+			}
+			break;
+		case OOVER:
+			errno = 0;
+			over = strtod(optarg, &end);
+			if (errno != 0 || *end != '\0' || end == optarg ||
+			    !(over >= 0.0 && over <= 100.0)) {
+				(void)fprintf(stderr,
+					_("--over: illegal value %s\n"),
+					optarg);
+				usage(EXIT_FAILURE);
+				/* NOTREACHED */
+			}
+			break;
+		case OWHERE:
+			if (where_compile(optarg) == -1) {
+				usage(EXIT_FAILURE);
+				/* NOTREACHED */
+			}
+			break;
+		case OOUTPUT:
+			outspec = optarg;
+			break;
+		case OTRUNCATE:
+			if (strcmp(optarg, "left") == 0) {
+				truncflag = TRUNC_LEFT;
+			} else if (strcmp(optarg, "middle") == 0) {
+				truncflag = TRUNC_MIDDLE;
+			} else if (strcmp(optarg, "none") == 0) {
+				Wflag = 1;
+			} else {
+				(void)fprintf(stderr,
+					_("--truncate: illegal value %s\n"),
+					optarg);
+				usage(EXIT_FAILURE);
+				/* NOTREACHED */
+			}
+			break;
+		case OEVENTS:
+			eventsflag = 1;
+			break;
+		case OCHECK:
+			checkflag = 1;
+			break;
+		case OHELD:
+			heldflag = 1;
+			break;
+		case ODRILL:
+			drilldir = optarg;
+			break;
+		case ODEPTH:
+			errno = 0;
+			depth = strtol(optarg, &end, 10);
+			if (errno != 0 || *end != '\0' || end == optarg ||
+			    depth < 0 || depth > INT_MAX) {
+				(void)fprintf(stderr,
+					_("--depth: illegal value %s\n"),
+					optarg);
+				usage(EXIT_FAILURE);
+				/* NOTREACHED */
+			}
+			break;
 		case '?':
 		default:
 			usage(EXIT_FAILURE);
@@ -385,12 +552,124 @@ main(int argc, char *argv[])
 	if (hflag)
 		usage(EXIT_SUCCESS);
 
+	/* --top shows the fullest file systems unless told otherwise */
+	if (top && !qflag) {
+		(void)sort_parse("usage:desc");
+		qflag = 1;
+	}
+
 	if (vflag) {
 		(void)printf("%s %s\n", PACKAGE, VERSION);
 		ret = EXIT_SUCCESS;
 		goto out;
 	}
 
+	/* --diff OLD NEW: NEW is the only operand */
+	if (diffflag) {
+		if (optind != argc - 1 || snapfile) {
+			usage(EXIT_FAILURE);
+			/* NOTREACHED */
+		}
+		if (eflag == 2) {
+			(void)fputs(_("Differences cannot be exported to a "
+				"snapshot\n"), stderr);
+			ret = EXIT_FAILURE;
+			goto out;
+		}
+		/* sizes, inodes and options are what may change */
+		dflag = iflag = oflag = 1;
+		/* a bar or a sum of differences does not make sense */
+		bflag = 1;
+		sflag = 0;
+	}
+
+	if (count > 0 && interval == 0) {
+		usage(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	watchflag = interval > 0;
+	/* a snapshot, a difference or a rollup does not change */
+	if (watchflag && (snapfile || diffflag || aggdir)) {
+		usage(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	/* events are about single file systems, from a sample to the next */
+	if (eventsflag && (!watchflag || nsinks > 0 || qflag || gflag ||
+	    top || over >= 0.0 || checkflag)) {
+		usage(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+
+	/* open files are the ones of our processes, on our file systems */
+	if (heldflag && (snapfile || diffflag || aggdir || nsflag ||
+	    rootdir || gflag || eventsflag)) {
+		usage(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+
+	/* a walk of a tree is shown once, as it is */
+	if (depth >= 0 && !drilldir) {
+		usage(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	if (drilldir && (snapfile || diffflag || aggdir || nsflag ||
+	    rootdir || watchflag || eventsflag || heldflag || gflag || qflag ||
+	    top || over >= 0.0 || checkflag || optind < argc)) {
+		usage(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+
+	/* paths only make sense when looking at the live mount table */
+	if (!diffflag && optind < argc &&
+	    (snapfile || aggdir || nsflag || rootdir)) {
+		usage(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	/* only one source of mount points at a time */
+	if ((nsflag || rootdir) &&
+	    ((nsflag && rootdir) || diffflag || snapfile || aggdir)) {
+		usage(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+
+	/* differences and rollups are not file systems to group or select */
+	if ((gflag || top || over >= 0.0 || checkflag) &&
+	    (diffflag || aggdir)) {
+		usage(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+
+	if (aggdir) {
+		if (diffflag || snapfile) {
+			usage(EXIT_FAILURE);
+			/* NOTREACHED */
+		}
+		if (eflag == 2) {
+			(void)fputs(_("Rollups cannot be exported to a "
+				"snapshot\n"), stderr);
+			ret = EXIT_FAILURE;
+			goto out;
+		}
+		/* the type column tells what the rows are grouped by */
+		Tflag = 1;
+	}
+
+	if (drilldir) {
+		if (eflag == 2) {
+			(void)fputs(_("Directories cannot be exported to a "
+				"snapshot\n"), stderr);
+			ret = EXIT_FAILURE;
+			goto out;
+		}
+		/* every line is on the same file system and they overlap */
+		dflag = Tflag = Mflag = 1;
+		sflag = 0;
+	}
+
+	/* the names of groups are keys, which are never shortened */
+	if (gflag || aggdir)
+		Wflag = 1;
+
 	/* init default max required width */
 	init_maxwidths();
 
@@ -401,8 +680,8 @@ main(int argc, char *argv[])
 		cflag = 0;
 
 	/* change cnf value according to config file, if it exists */
-	if ((cfgfile = config_file()) != NULL) {
-		if (update_conf(cfgfile) == -1) {
+	if ((cfgfile = config_file(&cfgfd)) != NULL) {
+		if (update_conf(cfgfd) == -1) {
 			(void)fprintf(stderr, _("Error reading the configuration"
 					" file: %s\n"), cfgfile);
 			ret = EXIT_FAILURE;
@@ -411,23 +690,189 @@ main(int argc, char *argv[])
 	}
 
 	/* if nothing specified, text output is default */
-	if (!eflag)
-		init_disp_text(&sdisp);
+	if (nsinks == 0) {
+		(void)memset(&sinks[0], 0, sizeof(sinks[0]));
+		init_disp_text(&sinks[0]);
+		nsinks = 1;
+	}
 
-	/* initializes the queue */
-	init_queue(&queue);
+	/* a snapshot always holds every column */
+	if (outspec && eflag == 2) {
+		usage(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	for (i = 0; i < nsinks; i++) {
+		if (sinks[i].dest == NULL) {
+			sinks[i].color = cflag;
+			/* cannot display all information if tty is too narrow */
+			if (textout && !fflag)
+				sinks[i].width = tty_width;
+		} else {
+			/* a file is not a terminal */
+			sinks[i].color = cflag == 2;
+		}
+		if (columns_init(&sinks[i], outspec) == -1) {
+			usage(EXIT_FAILURE);
+			/* NOTREACHED */
+		}
+	}
 
-	/* fetch information about the currently mounted filesystems */
-	fetch_info(&queue);
+	if (diffflag) {
+		if (disp_diff(diffold, argv[optind], fstfilter, fsnfilter,
+		    sinks, nsinks) == -1)
+			ret = EXIT_FAILURE;
+		goto out;
+	}
 
-	/* cannot display all information if tty is too narrow */
-	if (!fflag && tty_width > 0 && !eflag)
-		auto_adjust(tty_width);
+	if (aggdir) {
+		if (disp_aggregate(aggdir, fstfilter, fsnfilter, sinks,
+		    nsinks) == -1)
+			ret = EXIT_FAILURE;
+		goto out;
+	}
 
-	/* actually displays the info we have got */
-	disp(&queue, fstfilter, fsnfilter, &sdisp);
+	if (drilldir) {
+		if (disp_drill(drilldir, depth >= 0 ? (int)depth : DRILL_DEPTH,
+		    sinks, nsinks) == -1)
+			ret = EXIT_FAILURE;
+		goto out;
+	}
+
+	/*
+	 * lines are displayed as soon as their file system is stated unless
+	 * they have to be sorted, grouped, selected or aligned on the widest
+	 * one, or the deleted files still open have to be found first
+	 */
+	streamed = !eventsflag && !heldflag && !qflag && !gflag && top == 0 &&
+	    over < 0.0;
+	for (i = 0; i < nsinks; i++) {
+		if (sinks[i].aligned)
+			streamed = 0;
+	}
+	/* otherwise only the first top ones are kept while they are fetched */
+	selected = !streamed && top > 0 && !gflag && !eventsflag;
+
+	/* with --watch, sample again every interval seconds */
+	for (sample = 1;; sample++) {
+		/* initializes the queue */
+		init_queue(&queue);
+		if (streamed) {
+			stream_start(&st, sinks, nsinks, fstfilter, fsnfilter);
+			queue.stream = stream_fs;
+			queue.arg = &st;
+		} else if (selected) {
+			sort_heap_init(&sel.heap, (size_t)top);
+			sel.fstfilter = fstfilter;
+			sel.fsnfilter = fsnfilter;
+			sel.over = over;
+			sel.nover = 0;
+			queue.stream = select_fs;
+			queue.arg = &sel;
+		}
+
+		if (snapfile) {
+			/* information comes from a snapshot taken earlier */
+			if (read_snapshot(snapfile, &queue) == -1) {
+				if (streamed)
+					stream_abort(&st);
+				ret = EXIT_FAILURE;
+				goto out;
+			}
+		} else if (rootdir) {
+			/* look at the host which root is under rootdir */
+			if (fetch_info_root(&queue, rootdir) == -1) {
+				if (streamed)
+					stream_abort(&st);
+				ret = EXIT_FAILURE;
+				goto out;
+			}
+		} else if (nsflag) {
+			/* look into the mount namespaces of other processes */
+			if (fetch_info_ns(&queue, (pid_t)nspid) == -1) {
+				if (streamed)
+					stream_abort(&st);
+				ret = EXIT_FAILURE;
+				goto out;
+			}
+		} else {
+			/*
+			 * fetch information about the currently mounted
+			 * filesystems, restricted to the ones holding the
+			 * given paths, if any
+			 */
+			if (optind < argc)
+				aflag = 1; /* show what was asked for */
+			if (fetch_info(&queue, argv + optind,
+			    argc - optind) == -1)
+				ret = EXIT_FAILURE;
+		}
+
+		if (streamed) {
+			if (stream_end(&st) == -1)
+				ret = EXIT_FAILURE;
+			else if (checkflag && st.nhigh > 0 &&
+			    ret == EXIT_SUCCESS)
+				ret = EXIT_OVER;
+			goto next;
+		}
+
+		if (selected) {
+			queue.stream = NULL;
+			sort_heap_list(&sel.heap, &queue);
+		}
+
+		/* only what changed since the previous sample */
+		if (eventsflag) {
+			filter_list(&queue, fstfilter, fsnfilter);
+			if (events_update(&queue) == -1)
+				ret = EXIT_FAILURE;
+			goto next;
+		}
+
+		filter_list(&queue, fstfilter, fsnfilter);
+
+		/* the groups stand in for the file systems they hold */
+		if (gflag)
+			group_list(&queue, &groupby);
+
+		nover = select_list(&queue, (size_t)top, over);
+		/* the ones over the threshold were counted when fetched */
+		if (selected)
+			nover = sel.nover;
+		if (nover > 0 && ret == EXIT_SUCCESS)
+			ret = EXIT_OVER;
+
+		/* after selecting: only the file systems shown are stated */
+		if (heldflag && held_update(&queue) == -1)
+			ret = EXIT_FAILURE;
+
+		if (checkflag && check_list(&queue) > 0 &&
+		    ret == EXIT_SUCCESS)
+			ret = EXIT_OVER;
+
+		/* actually displays the info we have got */
+		if (disp(&queue, sinks, nsinks) == -1)
+			ret = EXIT_FAILURE;
+
+		/* and which deleted files hold their space */
+		if (heldflag && textout)
+			held_report(stdout);
+
+next:
+		if (!watchflag || sample == count)
+			break;
+		/* show each sample as soon as it is complete */
+		(void)fflush(stdout);
+		(void)sleep((unsigned int)interval);
+		init_maxwidths();
+		if (textout && !eventsflag)
+			(void)putchar('\n');
+	}
 
 out:
+	events_free();
+	held_free();
+	free(snapfile);
 	free(fstfilter);
 	free(fsnfilter);
 
@@ -445,17 +890,31 @@ usage(int status)
 		(void)fputs(_("Try dfc -h for more information\n"), stderr);
 	else {
 		/* 2 fputs because string length limit is 509 */
-		(void)fputs(_("Usage:  dfc [OPTION(S)] [-c WHEN] [-e FORMAT] "
-					"[-p FSNAME] [-q SORTBY] [-t FSTYPE] "
-					"[-u UNIT]\n"
+		(void)fputs(_("Usage:  dfc [OPTION(S)] [-c WHEN] "
+					"[-e FORMAT[:FILE],...] [-p FSNAME] "
+					"[-q SORTBY] [-t FSTYPE] "
+					"[-u UNIT] [--read FILE] "
+					"[--diff OLD NEW] "
+					"[--aggregate DIR] "
+					"[--all-namespaces | --pid PID | "
+					"--root PREFIX] "
+					"[--watch SECONDS [--count N]] "
+					"[--group-by GROUP] "
+					"[--top N] [--over PCT] "
+					"[--where EXPR] "
+					"[--output COLUMNS] "
+					"[--truncate MODE] [--events] "
+					"[--check] [--held] "
+					"[--drill DIR [--depth N]] "
+					"[PATH...]\n"
 			"Available options:\n"
 			"\t-a\tprint all mounted filesystem\n"
 			"\t-b\tdo not show the graph bar\n"
 			"\t-c\tchoose color mode. Read the manpage for "
 			"details\n"
 			"\t-d\tshow used size\n"
-			"\t-e\texport to specified format. Read the manpage "
-			"for details\n"
+			"\t-e\texport to specified formats or files. Read the "
+			"manpage for details\n"
 			"\t-f\tdisable auto-adjust mode (force display)\n"
 			"\t-h\tprint this message\n"
 			"\t-i\tinfo about inodes\n"
@@ -481,158 +940,584 @@ usage(int status)
 			"\t-w\tuse a wider bar\n"
 			"\t-W\twide filename (un truncate)\n"),
 		stdout);
+		(void)fputs(_(
+			"\t--read FILE\tshow the file systems stored in a "
+			"snapshot taken with -e bin\n"
+			"\t--diff OLD NEW\tshow what changed between two "
+			"snapshots taken with -e bin\n"
+			"\t--aggregate DIR\tshow rollups of all the snapshots "
+			"of a directory\n"
+			"\t--all-namespaces\tshow the file systems of all "
+			"the mount namespaces\n"
+			"\t--pid PID\tshow the file systems of the mount "
+			"namespace of a process\n"
+			"\t--root PREFIX\tshow the file systems of the host "
+			"which root is mounted on PREFIX\n"
+			"\t--automount\tstat autofs trigger points, which "
+			"mounts them\n"
+			"\t--watch SECONDS\tshow the file systems again every "
+			"SECONDS seconds\n"
+			"\t--count N\tstop after N samples with --watch\n"
+			"\t--events\twith --watch, only write what changed "
+			"as JSON Lines\n"
+			"\t--group-by GROUP\tshow subtotals by type, device, "
+			"mountprefix:N or option:NAME\n"
+			"\t--top N\tonly show the first N file systems, the "
+			"fullest ones by default\n"
+			"\t--over PCT\tonly show the file systems used at "
+			"PCT percent or more and exit with status 2 if any\n"
+			"\t--check\texit with status 2 if a file system is "
+			"over its high threshold\n"
+			"\t--held\tshow the space held by deleted files "
+			"which are still open\n"
+			"\t--drill DIR\tshow the largest directories and "
+			"files under DIR, on its file system\n"
+			"\t--depth N\trank the directories down to N levels "
+			"under DIR with --drill (default: 1)\n"
+			"\t--where EXPR\tonly show the file systems matching "
+			"EXPR. Read the manpage for details\n"
+			"\t--output COLUMNS\tshow the given columns, in "
+			"order. Read the manpage for details\n"
+			"\t--truncate MODE\tshorten long names by their "
+			"left (default) or middle, or not at all (none)\n"),
+		stdout);
 	}
 	exit(status);
 	/* NOTREACHED */
 }
 
 /*
- * Actually displays infos in nice manner
+ * Parse the argument of -e: a comma separated list of export formats, each one
+ * optionally followed by a colon and the file to write it to instead of the
+ * standard output
+ * Return the number of exports, -1 on error.
+ * @arg: argument to parse, modified
+ * @sinks: displays to set up, MAXSINKS at most
+ * @textout: set to whether text is written to the standard output
+ */
+static int
+parse_sinks(char *arg, struct display *sinks, int *textout)
+{
+	static const struct {
+		const char *name;
+		void (*init)(struct display *);
+		int raw;	/* machine readable, nothing is translated */
+	} formats[] = {
+		{ "text", init_disp_text, 0 },
+		{ "csv", init_disp_csv, 0 },
+		{ "html", init_disp_html, 0 },
+		{ "tex", init_disp_tex, 0 },
+		{ "json", init_disp_json, 1 },
+		{ "bin", init_disp_bin, 1 }
+	};
+	const size_t nformats = sizeof(formats) / sizeof(formats[0]);
+	char *fmt, *dest, *save;
+	size_t i;
+	int n = 0, nstdout = 0;
+
+	eflag = 0;
+	rawflag = 1;
+	*textout = 0;
+	for (fmt = strtok_r(arg, ",", &save); fmt != NULL;
+	    fmt = strtok_r(NULL, ",", &save)) {
+		if ((dest = strchr(fmt, ':')) != NULL)
+			*dest++ = '\0';
+		for (i = 0; i < nformats; i++) {
+			if (strcmp(fmt, formats[i].name) == 0)
+				break;
+		}
+		if (i == nformats) {
+			(void)fprintf(stderr, _("-e: illegal sub option %s\n"),
+				fmt);
+			return -1;
+		}
+		if (n == MAXSINKS) {
+			(void)fprintf(stderr, _("-e: at most %d exports can be "
+				"given\n"), MAXSINKS);
+			return -1;
+		}
+		if (dest == NULL || *dest == '\0') {
+			if (nstdout++) {
+				(void)fputs(_("-e: only one export can be "
+					"written to the standard output\n"),
+					stderr);
+				return -1;
+			}
+			dest = NULL;
+			*textout = i == 0;
+		}
+
+		(void)memset(&sinks[n], 0, sizeof(sinks[n]));
+		formats[i].init(&sinks[n]);
+		sinks[n++].dest = dest;
+
+		if (i != 0 && !eflag)
+			eflag = 1;
+		if (!formats[i].raw)
+			rawflag = 0;
+		/* a snapshot holds every column of a row, untruncated */
+		if (formats[i].init == init_disp_bin)
+			eflag = 2;
+	}
+
+	if (n == 0) {
+		(void)fputs(_("-e: no export format given\n"), stderr);
+		return -1;
+	}
+
+	return n;
+}
+
+/*
+ * Actually displays infos in nice manner, skipping the file systems marked
+ * as ignored (see filter_list), and empty the queue
+ * Return -1 if an export could not be written, 0 otherwise.
  * @lst: queue containing all required information
- * @fstfilter: fstype to filter (can be NULL)
- * @fsnfilter: fsname to filter (can be NULL)
- * @sdisp: display structure that points to the respective functions regarding
- *	  the selected output type
+ * @sinks: display structures that point to the respective functions regarding
+ *	  the selected output types
+ * @nsinks: number of display structures
  */
-void
-disp(struct list *lst, const char *fstfilter, const char *fsnfilter,
-    struct display *sdisp)
+int
+disp(struct list *lst, struct display *sinks, size_t nsinks)
 {
-	struct fsmntinfo *p = NULL;
-	int n;
-	int nmt = 0;
-	int nmn = 0;
-	double stot, atot, utot, ifitot, ifatot;
+	struct fsmntinfo *p;
+	struct row *rows, sum;
+	size_t n = 0;
+	int ret;
 
-	stot = atot = utot = ifitot = ifatot = n = 0;
+	for (p = lst->head; p != NULL; p = p->next)
+		n++;
+	if ((rows = malloc((n + 1) * sizeof(*rows))) == NULL) {
+		(void)fputs("Error while allocating memory to display\n",
+			stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
 
-	/* activate negative matching on fs type? */
-	if (tflag) {
-		if (fstfilter && fstfilter[0] == '-') {
-			nmt = 1;
-			fstfilter++;
-		}
+	/* the lines point into the queue: it is emptied once displayed */
+	row_sum_init(&sum);
+	n = 0;
+	for (p = lst->head; p != NULL; p = p->next) {
+		if (p->ignored)
+			continue;
+		row_of_fmi(&rows[n], p);
+		if (sflag)
+			row_add(&sum, &rows[n]);
+		n++;
 	}
 
-	/* activate negative matching on fs name? */
-	if (pflag) {
-		if (fsnfilter && fsnfilter[0] == '-') {
-			nmn = 1;
-			fsnfilter++;
+	ret = disp_table(sinks, nsinks, rows, n, sflag ? &sum : NULL);
+
+	free(rows);
+	for (p = lst->head; p != NULL;)
+		p = delete_struct_and_get_next(p);
+	init_queue(lst);
+
+	return ret;
+}
+
+/*
+ * Display a table through every display: on the standard output or into a
+ * file, which is only replaced once it is complete
+ * Return -1 if a file could not be written, 0 otherwise.
+ * @sinks: display structures
+ * @nsinks: number of display structures
+ * @rows: lines of the table
+ * @n: number of lines
+ * @sum: sum of the lines, NULL not to display it
+ */
+int
+disp_table(struct display *sinks, size_t nsinks, const struct row *rows,
+    size_t n, const struct row *sum)
+{
+	struct display *d;
+	char *tmp;
+	size_t i;
+	int bar = max.bar;
+	int ret = 0;
+
+	for (i = 0; i < nsinks; i++) {
+		d = &sinks[i];
+
+		/* the bar is only narrowed for the terminal */
+		if (d->shortbar)
+			max.bar = GRAPHBAR_SHORT;
+		if (d->width > 0)
+			auto_adjust(d, d->width);
+
+		if (sink_open(d, &tmp) == -1) {
+			ret = -1;
+		} else {
+			print_table(d, rows, n, sum);
+			if (sink_close(d, tmp) == -1)
+				ret = -1;
 		}
+		max.bar = bar;
 	}
 
-	/* only required for html, json and tex export */
-	if (sdisp->init)
-		sdisp->init();
+	return ret;
+}
 
-	/* legend on top */
-	if (!nflag)
-		sdisp->print_header();
+/*
+ * Start writing through a display: to the standard output or to a temporary
+ * file, which replaces its destination once complete (see sink_close)
+ * Return -1 if the file could not be created, 0 otherwise.
+ * @d: display structure
+ * @tmp: set to the temporary file, NULL when writing to the standard output
+ */
+static int
+sink_open(struct display *d, char **tmp)
+{
+	size_t len;
+	mode_t mask;
+	int fd;
 
-	 /* sort the list */
-	if (qflag)
-		lst->head = msort(lst->head);
+	*tmp = NULL;
+	if (d->dest == NULL) {
+		d->out = stdout;
+		return 0;
+	}
+
+	len = strlen(d->dest) + 8;
+	if ((*tmp = malloc(len)) == NULL) {
+		(void)fputs("Error while allocating memory to export\n",
+			stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	/* unique, so that runs exporting to the same file do not mix */
+	(void)snprintf(*tmp, len, "%s.XXXXXX", d->dest);
+	if ((fd = mkstemp(*tmp)) == -1) {
+		(void)fprintf(stderr, _("Cannot write %s"), d->dest);
+		perror(" ");
+		free(*tmp);
+		*tmp = NULL;
+		return -1;
+	}
+	/* the export gets the permissions fopen(3) would have given it */
+	mask = umask(0);
+	(void)umask(mask);
+	(void)fchmod(fd, 0666 & ~mask);
+	if ((d->out = fdopen(fd, "w")) == NULL) {
+		(void)fprintf(stderr, _("Cannot write %s"), d->dest);
+		perror(" ");
+		(void)close(fd);
+		(void)unlink(*tmp);
+		free(*tmp);
+		*tmp = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Stop writing through a display opened with sink_open
+ * Return -1 if the file could not be written, 0 otherwise.
+ * @d: display structure
+ * @tmp: temporary file, NULL for the standard output
+ */
+static int
+sink_close(struct display *d, char *tmp)
+{
+	int ret = 0;
+
+	if (tmp == NULL)
+		return 0;
+
+	/* readers of the file never see a partial export */
+	if (fclose(d->out) == EOF || rename(tmp, d->dest) == -1) {
+		(void)fprintf(stderr, _("Cannot write %s"), d->dest);
+		perror(" ");
+		(void)unlink(tmp);
+		ret = -1;
+	}
+	free(tmp);
+
+	return ret;
+}
+
+/*
+ * Start a table through every display, which lines are then displayed as
+ * soon as their file system is fetched (see stream_fs) instead of being
+ * queued: only the sum of the lines is kept.
+ * @st: table to start
+ * @sinks: display structures, none of them aligned
+ * @nsinks: number of display structures
+ * @fstfilter: fstype to filter (can be NULL)
+ * @fsnfilter: fsname to filter (can be NULL)
+ */
+static void
+stream_start(struct stream *st, struct display *sinks, size_t nsinks,
+    const char *fstfilter, const char *fsnfilter)
+{
+	size_t i;
 
-	for (p = lst->head; p; p = p->next) {
-		/* ignored unless proven otherwise */
-		p->ignored = 1;
+	st->sinks = sinks;
+	st->nsinks = nsinks;
+	st->fstfilter = fstfilter;
+	st->fsnfilter = fsnfilter;
+	st->nhigh = 0;
+	st->ret = 0;
+	row_sum_init(&st->sum);
 
-		/* ignore when needed */
-		if (!aflag && (is_mnt_ignore(p) == 1)) {
+	for (i = 0; i < nsinks; i++) {
+		if (sink_open(&sinks[i], &st->tmp[i]) == -1) {
+			/* nothing is written through it */
+			sinks[i].out = NULL;
+			st->ret = -1;
 			continue;
 		}
+		print_table_start(&sinks[i]);
+	}
+}
 
-		/* filtering on fs type */
-		if (tflag && (fsfilter(p->fstypeog, fstfilter, nmt) == 0)) {
-			continue;
+/*
+ * Display a file system through every display of a table, unless it is
+ * filtered out, and release it: this is the stream of the queue
+ * Return 0.
+ * @arg: table started with stream_start
+ * @p: file system
+ */
+static int
+stream_fs(void *arg, struct fsmntinfo *p)
+{
+	struct stream *st = arg;
+	struct display *d;
+	struct row r;
+	size_t i;
+
+	if (!is_filtered(p, st->fstfilter, st->fsnfilter)) {
+		row_of_fmi(&r, p);
+		if (sflag)
+			row_add(&st->sum, &r);
+		if (row_level(&r) == LEVEL_HIGH)
+			st->nhigh++;
+		for (i = 0; i < st->nsinks; i++) {
+			d = &st->sinks[i];
+			if (d->out == NULL)
+				continue;
+			print_row(d, &r);
+			/* a slow file system does not hold back the others */
+			if (st->tmp[i] == NULL)
+				(void)fflush(d->out);
 		}
-		/* filtering on fs name */
-		if (pflag && (fsfilter(p->fsnameog, fsnfilter, nmn) == 0)) {
+	}
+	(void)delete_struct_and_get_next(p);
+
+	return 0;
+}
+
+/*
+ * End a table started with stream_start, with the sum of its lines if asked
+ * for (-s)
+ * Return -1 if an export could not be written, 0 otherwise.
+ * @st: table to end
+ */
+static int
+stream_end(struct stream *st)
+{
+	struct display *d;
+	size_t i;
+
+	for (i = 0; i < st->nsinks; i++) {
+		d = &st->sinks[i];
+		if (d->out == NULL)
 			continue;
-		}
+		print_table_end(d, sflag ? &st->sum : NULL);
+		if (sink_close(d, st->tmp[i]) == -1)
+			st->ret = -1;
+	}
 
-		/* skip remote file systems */
-		if (lflag && is_remote(p)) {
+	return st->ret;
+}
+
+/*
+ * Give up on a table started with stream_start, when its file systems could
+ * not be fetched: exports are left as they were
+ * @st: table to give up on
+ */
+static void
+stream_abort(struct stream *st)
+{
+	struct display *d;
+	size_t i;
+
+	for (i = 0; i < st->nsinks; i++) {
+		d = &st->sinks[i];
+		if (d->out == NULL || st->tmp[i] == NULL)
 			continue;
-		}
+		(void)fclose(d->out);
+		(void)unlink(st->tmp[i]);
+		free(st->tmp[i]);
+		st->tmp[i] = NULL;
+		d->out = NULL;
+	}
+}
+
+/*
+ * Select the file systems to display among the ones which are not ignored:
+ * the ones which usage is at least over percent and, of those, the first top
+ * ones in sort order. Widths are computed again for the selected ones only.
+ * Return the number of file systems over the threshold.
+ * @lst: queue containing all required information
+ * @top: maximum number of file systems to display (0 for no maximum)
+ * @over: usage threshold in percent (negative for no threshold)
+ */
+size_t
+select_list(struct list *lst, size_t top, double over)
+{
+	struct fsmntinfo *p;
+	size_t n = 0, nover = 0;
 
-		p->ignored = 0;
+	if (over >= 0.0) {
+		for (p = lst->head; p != NULL; p = p->next) {
+			if (p->ignored)
+				continue;
+			if (p->perctused < over)
+				p->ignored = 1;
+			else
+				nover++;
+		}
 	}
 
-	p = lst->head;
+	/* only the first top file systems are put in order */
+	if (qflag)
+		sort_list(lst, top);
+
+	if (top == 0 && over < 0.0)
+		return 0;
 
-	while (p != NULL) {
-		if (p->ignored) {
-			p = delete_struct_and_get_next(p);
+	init_maxwidths();
+	for (p = lst->head; p != NULL; p = p->next) {
+		if (p->ignored)
 			continue;
+		if (top > 0 && n == top)
+			p->ignored = 1;
+		else {
+			update_row_maxwidth(p);
+			n++;
 		}
+	}
+
+	return nover;
+}
 
-		/* filesystem */
-		sdisp->print_fs(p->fsname);
+/*
+ * Keep a file system if it is among the first top ones in sort order so far,
+ * once the ones which are filtered out or under the usage threshold are
+ * dropped, and release the ones which are not kept: this is the stream of
+ * the queue with --top (see select_list for the other cases)
+ * Return 0.
+ * @arg: selection started in main
+ * @p: file system
+ */
+static int
+select_fs(void *arg, struct fsmntinfo *p)
+{
+	struct selection *sel = arg;
 
-		/* type */
-		if (Tflag) {
-			sdisp->print_type(p->fstype);
-		}
+	if (is_filtered(p, sel->fstfilter, sel->fsnfilter) ||
+	    (sel->over >= 0.0 && p->perctused < sel->over)) {
+		(void)delete_struct_and_get_next(p);
+		return 0;
+	}
+	if (sel->over >= 0.0)
+		sel->nover++;
 
-		if (sflag) {
-			stot += p->total;
-			atot += p->avail;
-			utot += p->used;
-		}
+	if ((p = sort_heap_push(&sel->heap, p)) != NULL)
+		(void)delete_struct_and_get_next(p);
+
+	return 0;
+}
+
+/*
+ * Count the file systems which are not ignored and reach the high threshold
+ * of their policy, in bytes or in inodes (--check)
+ * Return the number of such file systems.
+ * @lst: queue containing all required information
+ */
+static size_t
+check_list(const struct list *lst)
+{
+	const struct fsmntinfo *p;
+	struct row r;
+	size_t nhigh = 0;
+
+	for (p = lst->head; p != NULL; p = p->next) {
+		if (p->ignored)
+			continue;
+		row_of_fmi(&r, p);
+		if (row_level(&r) == LEVEL_HIGH)
+			nhigh++;
+	}
 
-		if (!bflag)
-			sdisp->print_bar(p->perctused);
+	return nhigh;
+}
+
+/*
+ * Mark the file systems which must not be displayed as ignored
+ * @lst: queue containing all required information
+ * @fstfilter: fstype to filter (can be NULL)
+ * @fsnfilter: fsname to filter (can be NULL)
+ */
+void
+filter_list(struct list *lst, const char *fstfilter, const char *fsnfilter)
+{
+	struct fsmntinfo *p = NULL;
 
-		/* %used */
-		sdisp->print_perct(p->perctused);
+	for (p = lst->head; p; p = p->next)
+		p->ignored = is_filtered(p, fstfilter, fsnfilter);
+}
 
+/*
+ * Return 1 if the file system must not be displayed, 0 otherwise
+ * @p: file system to check
+ * @fstfilter: fstype to filter (can be NULL)
+ * @fsnfilter: fsname to filter (can be NULL)
+ */
+int
+is_filtered(const struct fsmntinfo *p, const char *fstfilter,
+    const char *fsnfilter)
+{
+	int nmt = 0;
+	int nmn = 0;
 
-		/* format to requested format */
-		if (uflag) {
-			p->total = cvrt(p->total);
-			p->avail = cvrt(p->avail);
-			if (dflag)
-				p->used = cvrt(p->used);
+	/* activate negative matching on fs type? */
+	if (tflag) {
+		if (fstfilter && fstfilter[0] == '-') {
+			nmt = 1;
+			fstfilter++;
 		}
+	}
 
-		if (dflag)
-			sdisp->print_used(p->used, p->perctused, max.used);
-		sdisp->print_avail(p->avail, p->perctused, max.avail);
-		sdisp->print_total(p->total, p->perctused, max.total);
-
-		/* info about inodes */
-		if (iflag) {
-			ifitot += (double)p->files;
-			ifatot += (double)p->favail;
-#if defined(__linux__) || defined(__GLIBC__)
-			sdisp->print_inodes((uint64_t)(p->files),
-					(uint64_t)(p->favail));
-#else
-			sdisp->print_inodes((uint64_t)(p->files),
-					(uint64_t)( p->ffree));
-#endif /* __linux__ */
+	/* activate negative matching on fs name? */
+	if (pflag) {
+		if (fsnfilter && fsnfilter[0] == '-') {
+			nmn = 1;
+			fsnfilter++;
 		}
+	}
 
-		/* mounted on */
-		if (!Mflag)
-			sdisp->print_mount(p->mntdir);
+	/* ignore when needed */
+	if (!aflag && (is_mnt_ignore(p) == 1))
+		return 1;
 
-		/* info about mount option */
-		if (oflag)
-			sdisp->print_mopt(p->mntopts);
+	/* filtering on fs type */
+	if (tflag && (fsfilter(p->fstype, fstfilter, nmt) == 0))
+		return 1;
 
-		/* new line character depending on export type */
-		sdisp->print_ln_end();
+	/* filtering on fs name */
+	if (pflag && (fsfilter(p->fsname, fsnfilter, nmn) == 0))
+		return 1;
 
-		p = delete_struct_and_get_next(p);
-	}
+	/* skip remote file systems */
+	if (lflag && is_remote(p))
+		return 1;
 
-	if (sflag)
-		sdisp->print_sum(stot, atot, utot, ifitot, ifatot);
+	/* --where expression */
+	if (where_match(p) == 0)
+		return 1;
 
-	/* only required for html and tex export (csv and text point to NULL) */
-	if (sdisp->deinit)
-		sdisp->deinit();
+	return 0;
 }
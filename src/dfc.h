@@ -45,9 +45,21 @@
 #include "export/export.h"
 #include "platform/services.h"
 
+/* exit status when a file system is over the threshold given to --over */
+#define EXIT_OVER 2
+
+/* maximum number of exports given to -e */
+#define MAXSINKS 8
+
 /* function declaration */
 void usage(int status);
-void disp(struct list *lst, const char *fsfilter, const char *fsnfilter,
-    struct display *sdisp);
+void filter_list(struct list *lst, const char *fstfilter,
+    const char *fsnfilter);
+int is_filtered(const struct fsmntinfo *p, const char *fstfilter,
+    const char *fsnfilter);
+size_t select_list(struct list *lst, size_t top, double over);
+int disp(struct list *lst, struct display *sinks, size_t nsinks);
+int disp_table(struct display *sinks, size_t nsinks, const struct row *rows,
+    size_t n, const struct row *sum);
 
 #endif /* ndef DFC_H */
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * diff.c
+ *
+ * Display the differences between two snapshots taken with "-e bin".
+ * File systems are matched by mount point, device and type: both snapshots are
+ * sorted on those keys and walked once side by side.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diff.h"
+#include "dfc.h"
+#include "snapshot.h"
+
+#ifdef NLS_ENABLED
+#include <libintl.h>
+#endif
+
+/* one line of the output */
+struct diff_row {
+	struct row r;		/* newest known state and differences */
+	char *mntopts;		/* "old -> new" when remounted */
+};
+
+/* static function declaration */
+static int keycmp(const void *a, const void *b);
+static struct fsmntinfo **sorted_array(struct list *lst, size_t *n);
+static void set_row(struct diff_row *row, const struct fsmntinfo *old,
+    const struct fsmntinfo *new);
+static void free_list(struct list *lst);
+
+/*
+ * Compare two file systems on the keys used to match them
+ * @a: pointer to the first fsmntinfo pointer
+ * @b: pointer to the second fsmntinfo pointer
+ */
+static int
+keycmp(const void *a, const void *b)
+{
+	const struct fsmntinfo *fa = *(const struct fsmntinfo * const *)a;
+	const struct fsmntinfo *fb = *(const struct fsmntinfo * const *)b;
+	int ret;
+
+	if ((ret = strcmp(fa->mntdir, fb->mntdir)) != 0)
+		return ret;
+	if ((ret = strcmp(fa->fsname, fb->fsname)) != 0)
+		return ret;
+	return strcmp(fa->fstype, fb->fstype);
+}
+
+/*
+ * Return the file systems of `lst` which are not ignored, sorted by key, or
+ * NULL if it fails
+ * @lst: list of file systems
+ * @n: set to the number of elements of the array
+ */
+static struct fsmntinfo **
+sorted_array(struct list *lst, size_t *n)
+{
+	struct fsmntinfo **arr, *p;
+	size_t i = 0;
+
+	for (p = lst->head; p; p = p->next)
+		if (!p->ignored)
+			i++;
+
+	/* + 1 so that an empty snapshot is not an allocation failure */
+	if ((arr = malloc((i + 1) * sizeof(*arr))) == NULL)
+		return NULL;
+
+	*n = i;
+	i = 0;
+	for (p = lst->head; p; p = p->next)
+		if (!p->ignored)
+			arr[i++] = p;
+
+	qsort(arr, *n, sizeof(*arr), keycmp);
+
+	return arr;
+}
+
+/*
+ * Fill `row` with what changed between `old` and `new`. The row status is
+ * left to NULL when nothing changed.
+ * @row: row to fill in
+ * @old: file system in the old snapshot, NULL if it was added
+ * @new: file system in the new snapshot, NULL if it was removed
+ */
+static void
+set_row(struct diff_row *row, const struct fsmntinfo *old,
+    const struct fsmntinfo *new)
+{
+	size_t len;
+
+	struct row prev;
+
+	(void)memset(row, 0, sizeof(*row));
+
+	if (new) {
+		row_of_fmi(&row->r, new);
+	} else {
+		row_of_fmi(&row->r, old);
+		row->r.total = row->r.avail = row->r.used = 0;
+		row->r.files = row->r.favail = 0;
+	}
+
+	if (old) {
+		row_of_fmi(&prev, old);
+		row->r.total  -= prev.total;
+		row->r.avail  -= prev.avail;
+		row->r.used   -= prev.used;
+		row->r.files  -= prev.files;
+		row->r.favail -= prev.favail;
+	}
+
+	if (!old) {
+		row->r.status = strview(_("added"));
+	} else if (!new) {
+		row->r.status = strview(_("removed"));
+	} else if (strcmp(old->mntopts, new->mntopts) != 0) {
+		row->r.status = strview(_("remounted"));
+		len = strlen(old->mntopts) + strlen(new->mntopts) + 5;
+		if ((row->mntopts = malloc(len)) != NULL) {
+			(void)snprintf(row->mntopts, len, "%s -> %s",
+				old->mntopts, new->mntopts);
+			row->r.mntopts = strview(row->mntopts);
+		}
+	} else if (row->r.total != 0 || row->r.avail != 0 ||
+	    row->r.used != 0 || row->r.files != 0 || row->r.favail != 0) {
+		row->r.status = strview(_("changed"));
+	}
+}
+
+/*
+ * Free all the elements of a list
+ * @lst: list to empty
+ */
+static void
+free_list(struct list *lst)
+{
+	struct fsmntinfo *p = lst->head;
+
+	while (p != NULL)
+		p = delete_struct_and_get_next(p);
+	init_queue(lst);
+}
+
+/*
+ * Display what changed between two snapshots: added and removed file systems,
+ * remounts and the differences of sizes and inodes. File systems for which
+ * nothing changed are not displayed.
+ * Return -1 on error, 0 otherwise.
+ * @oldpath: path of the oldest snapshot
+ * @newpath: path of the newest snapshot
+ * @fstfilter: fstype to filter (can be NULL)
+ * @fsnfilter: fsname to filter (can be NULL)
+ * @sinks: display structures
+ * @nsinks: number of display structures
+ */
+int
+disp_diff(const char *oldpath, const char *newpath, const char *fstfilter,
+    const char *fsnfilter, struct display *sinks, size_t nsinks)
+{
+	struct list oldlst, newlst;
+	struct fsmntinfo **old = NULL, **new = NULL;
+	struct diff_row *rows = NULL;
+	struct row *lines = NULL;
+	size_t nold, nnew, nrows, i, j;
+	int c, ret = -1;
+
+	init_queue(&oldlst);
+	init_queue(&newlst);
+
+	if (read_snapshot(oldpath, &oldlst) == -1 ||
+	    read_snapshot(newpath, &newlst) == -1)
+		goto out;
+
+	filter_list(&oldlst, fstfilter, fsnfilter);
+	filter_list(&newlst, fstfilter, fsnfilter);
+
+	if ((old = sorted_array(&oldlst, &nold)) == NULL ||
+	    (new = sorted_array(&newlst, &nnew)) == NULL ||
+	    (rows = malloc((nold + nnew + 1) * sizeof(*rows))) == NULL ||
+	    (lines = malloc((nold + nnew + 1) * sizeof(*lines))) == NULL) {
+		(void)fputs("Error while allocating memory to compare "
+			"snapshots\n", stderr);
+		goto out;
+	}
+
+	/* widths were computed from the snapshots, not their differences */
+	init_maxwidths();
+
+	nrows = i = j = 0;
+	while (i < nold || j < nnew) {
+		if (j == nnew)
+			c = -1;
+		else if (i == nold)
+			c = 1;
+		else
+			c = keycmp(&old[i], &new[j]);
+
+		if (c < 0)
+			set_row(&rows[nrows], old[i++], NULL);
+		else if (c > 0)
+			set_row(&rows[nrows], NULL, new[j++]);
+		else
+			set_row(&rows[nrows], old[i++], new[j++]);
+
+		if (rows[nrows].r.status.str != NULL) {
+			row_maxwidth(&rows[nrows].r);
+			lines[nrows] = rows[nrows].r;
+			nrows++;
+		}
+	}
+
+	ret = disp_table(sinks, nsinks, lines, nrows, NULL);
+
+	for (i = 0; i < nrows; i++)
+		free(rows[i].mntopts);
+
+out:
+	free(lines);
+	free(rows);
+	free(old);
+	free(new);
+	free_list(&oldlst);
+	free_list(&newlst);
+
+	return ret;
+}
@@ -46,6 +46,8 @@
 #include <limits.h>
 
 #include "dotfile.h"
+#include "fsclass.h"
+#include "policy.h"
 
 #ifdef NLS_ENABLED
 #include <libintl.h>
@@ -73,16 +75,44 @@ get_boolean_value(const char *val)
 }
 
 /*
- * Finds the configuration file and returns its path.
- * NULL is returned when no configuration file is found.
+ * Open a configuration file if it exists
+ * Return 1 if it was opened, 0 if it does not exist or -1 on error.
+ * @conf: path of the configuration file
+ * @fd: set to the opened file
+ */
+static int
+open_conf(const char *conf, FILE **fd)
+{
+	if ((*fd = fopen(conf, "r")) != NULL)
+		return 1;
+	if (errno == ENOENT || errno == ENOTDIR)
+		return 0;
+
+	(void)fprintf(stderr, "Cannot read file %s", conf);
+	perror(" ");
+	return -1;
+}
+
+/*
+ * Finds the configuration file, opens it and returns its path.
+ * NULL is returned when no configuration file is found or when it cannot be
+ * opened. Each candidate is simply opened: there is a single system call for
+ * each one which does not exist and none to check that the file exists
+ * before reading it.
  * Configuration file follows XDG Base Directory Specification
  * http://standards.freedesktop.org/basedir-spec/basedir-spec-latest.html
+ * @fd: set to the opened configuration file
  */
 char *
-config_file(void)
+config_file(FILE **fd)
 {
+	static const char *const homepaths[] = {
+		"/.config/dfc/dfcrc",
+		"/.dfcrc"
+	};
 	char *xdg_home, *home;
 	char conf[PATH_MAX];
+	size_t i;
 	int ret;
 
 	xdg_home = getenv("XDG_CONFIG_HOME");
@@ -92,27 +122,21 @@ config_file(void)
 			return NULL;
 		if ((size_t)ret >= sizeof(conf))
 			goto trunc_err;
-		if (access(conf, F_OK) == 0)
-			return strdup(conf);
+		if ((ret = open_conf(conf, fd)) != 0)
+			return ret == 1 ? strdup(conf) : NULL;
 	}
 
 	home = getenv("HOME");
-	if (home && *home) {
-		ret = snprintf(conf, sizeof(conf), "%s/.config/dfc/dfcrc", home);
+	if (home == NULL || *home == '\0')
+		return NULL;
+	for (i = 0; i < sizeof(homepaths) / sizeof(homepaths[0]); i++) {
+		ret = snprintf(conf, sizeof(conf), "%s%s", home, homepaths[i]);
 		if (ret < 0)
 			return NULL;
 		if ((size_t)ret >= sizeof(conf))
 			goto trunc_err;
-		if (access(conf, F_OK) == 0)
-			return strdup(conf);
-
-		ret = snprintf(conf, sizeof(conf), "%s/.dfcrc", home);
-		if (ret < 0)
-			return NULL;
-		if ((size_t)ret >= sizeof(conf))
-			goto trunc_err;
-		if (access(conf, F_OK) == 0)
-			return strdup(conf);
+		if ((ret = open_conf(conf, fd)) != 0)
+			return ret == 1 ? strdup(conf) : NULL;
 	}
 	return NULL;
 
@@ -127,24 +151,17 @@ trunc_err:
 }
 
 /*
- * Parse the configuration file and update options
+ * Parse the configuration file, which is closed, and update options
  * return -1 in case of error, otherwise, 0 is returned
- * @conf: path to the configuration file
+ * @fd: configuration file opened by config_file()
  */
 int
-update_conf(const char *conf)
+update_conf(FILE *fd)
 {
-	FILE *fd;
 	char line[255];
 	char *key, *val;
 	int ret = 0;
 
-	if ((fd = fopen(conf, "r")) == NULL) {
-		(void)fprintf(stderr, "Cannot read file %s", conf);
-		perror(" ");
-		return -1;
-	}
-
 	while ((fgets(line, (int)sizeof(line), fd)) != NULL) {
 
 		/* skip empty lines and lines beginning with # */
@@ -255,6 +272,36 @@ set_conf(const char *key, const char *val)
 			ret = 0;
 			cnf.ghigh = tmp;
 		}
+	} else if (strcmp(key, "event_hysteresis") == 0) {
+		ret = -1;
+		/* reset errno value for strtol (see strtol(3)) */
+		errno = 0;
+		tmp = (int)strtol(val, (char **) NULL, 10);
+		if (errno)
+			(void)fprintf(stderr, _("Value conversion failed"
+				" for event_hysteresis: %s\n"), val);
+		else if (tmp < 0 || tmp > 100)
+			(void)fprintf(stderr, _("Hysteresis value must be"
+				" between 0 and 100: %s\n"), val);
+		else {
+			ret = 0;
+			cnf.ehyst = tmp;
+		}
+	} else if (strcmp(key, "event_debounce") == 0) {
+		ret = -1;
+		/* reset errno value for strtol (see strtol(3)) */
+		errno = 0;
+		tmp = (int)strtol(val, (char **) NULL, 10);
+		if (errno)
+			(void)fprintf(stderr, _("Value conversion failed"
+				" for event_debounce: %s\n"), val);
+		else if (tmp < 1)
+			(void)fprintf(stderr, _("Debounce value cannot be"
+				" set below 1: %s\n"), val);
+		else {
+			ret = 0;
+			cnf.edebounce = tmp;
+		}
 	} else if (strcmp(key, "graph_symbol") == 0) {
 		if (strlen(val) == 1)
 			cnf.gsymbol = val[0];
@@ -316,6 +363,21 @@ set_conf(const char *key, const char *val)
 					"%s\n"), val);
 			ret = -1;
 		}
+	} else if (strcmp(key, "pseudo_fs") == 0) {
+		if (fsclass_config(val, FSCLASS_PSEUDO) == -1)
+			goto assignment_failed;
+	} else if (strcmp(key, "remote_fs") == 0) {
+		if (fsclass_config(val, FSCLASS_REMOTE) == -1)
+			goto assignment_failed;
+	} else if (strcmp(key, "local_fs") == 0) {
+		if (fsclass_config(val, 0) == -1)
+			goto assignment_failed;
+	} else if (strcmp(key, "policy") == 0) {
+		if (policy_config(val) == -1) {
+			(void)fprintf(stderr, _("Wrong policy rule: %s\n"),
+					val);
+			ret = -1;
+		}
 	} else {
 		(void)fprintf(stderr, _("Error: unknown option in configuration"
 				" file: %s\n"), key);
@@ -356,6 +418,9 @@ init_conf(struct conf *config)
 	config->gmedium	= 50;
 	config->ghigh	= 75;
 
+	config->ehyst	= 2;
+	config->edebounce = 1;
+
 	config->gsymbol	= '=';
 
 	(void)snprintf(config->hcheadbg, sizeof(config->hcheadbg), "%s", "970000");
@@ -41,8 +41,8 @@
 #include "util.h"
 
 /* function declaration */
-char *config_file(void);
-int update_conf(const char *dfcrc);
+char *config_file(FILE **fd);
+int update_conf(FILE *fd);
 void init_conf(struct conf *config);
 
 #endif /* ndef H_DOTFILE */
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * drill.c
+ *
+ * Largest directories and files of a mount (--drill). The tree is walked by
+ * the platform (see fetch_drill) and what it found is shown as lines of the
+ * table: the walked directory first, then the largest directories and the
+ * largest files. The size of a line is the space allocated to it, and below
+ * it, and its usage is the part of the file system this space is.
+ */
+#include <sys/statvfs.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dfc.h"
+#include "drill.h"
+#include "platform/services.h"
+
+/* static function declaration */
+static void drill_row(struct row *r, const struct drill_entry *e,
+    const char *type, const char *path, const struct statvfs *vfs);
+
+/*
+ * Make the line of a directory or a file
+ * @r: line
+ * @e: directory or file
+ * @type: what it is
+ * @path: walked directory
+ * @vfs: file system of the walked directory
+ */
+static void
+drill_row(struct row *r, const struct drill_entry *e, const char *type,
+    const char *path, const struct statvfs *vfs)
+{
+	r->fsname  = strview(e->path);
+	r->fstype  = strview(type);
+	r->mntdir  = strview(path);
+	r->mntopts = strview("");
+	r->total   = (bigsize_t)vfs->f_blocks * (bigsize_t)vfs->f_frsize;
+	r->avail   = (bigsize_t)vfs->f_bavail * (bigsize_t)vfs->f_frsize;
+	r->used    = (bigsize_t)e->size;
+	r->perctused = r->total > 0 ?
+		(double)r->used / (double)r->total * 100.0 : 0.0;
+	r->files   = (int64_t)e->files;
+	r->favail  = 0;
+}
+
+/*
+ * Show the largest directories and files under a directory
+ * Return -1 if the directory cannot be walked, 0 otherwise.
+ * @path: directory, usually a mount point
+ * @depth: depth of the directories to show
+ * @sinks: display structures
+ * @nsinks: number of display structures
+ */
+int
+disp_drill(const char *path, int depth, struct display *sinks, size_t nsinks)
+{
+	struct drill_result res;
+	struct statvfs vfs;
+	struct row *rows;
+	size_t n = 0, i;
+	int ret;
+
+	if (statvfs(path, &vfs) == -1) {
+		perror(path);
+		return -1;
+	}
+	if (fetch_drill(path, depth, DRILL_TOPK, &res) == -1)
+		return -1;
+
+	if ((rows = calloc(res.ndirs + res.nfiles + 1, sizeof(*rows))) ==
+	    NULL) {
+		(void)fputs("Error while allocating memory to walk the tree\n",
+			stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	drill_row(&rows[n++], &res.root, "directory", path, &vfs);
+	for (i = 0; i < res.ndirs; i++)
+		drill_row(&rows[n++], &res.dirs[i], "directory", path, &vfs);
+	for (i = 0; i < res.nfiles; i++)
+		drill_row(&rows[n++], &res.files[i], "file", path, &vfs);
+
+	/* widths were not computed while walking */
+	init_maxwidths();
+	for (i = 0; i < n; i++)
+		row_maxwidth(&rows[i]);
+
+	ret = disp_table(sinks, nsinks, rows, n, NULL);
+
+	free(rows);
+	drill_free(&res);
+
+	return ret;
+}
+
+/*
+ * Free what walking a tree found
+ * @res: what was found
+ */
+void
+drill_free(struct drill_result *res)
+{
+	size_t i;
+
+	free(res->root.path);
+	for (i = 0; i < res->ndirs; i++)
+		free(res->dirs[i].path);
+	free(res->dirs);
+	for (i = 0; i < res->nfiles; i++)
+		free(res->files[i].path);
+	free(res->files);
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef H_DRILL
+#define H_DRILL
+/*
+ * drill.h
+ *
+ * Largest directories and files of a mount (--drill)
+ */
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#include "export/display.h"
+
+/* number of largest directories and files to show */
+#define DRILL_TOPK 10
+
+/* depth of the directories shown, unless given with --depth */
+#define DRILL_DEPTH 1
+
+/* a directory or a file found while walking a mount */
+struct drill_entry {
+	char *path;
+	uint64_t size;		/* bytes allocated to it, and below it */
+	uint64_t files;		/* inodes it is made of */
+};
+
+/* what walking a mount found */
+struct drill_result {
+	struct drill_entry root;	/* the whole tree */
+	struct drill_entry *dirs;	/* largest directories first */
+	size_t ndirs;
+	struct drill_entry *files;	/* largest regular files first */
+	size_t nfiles;
+};
+
+/* function declaration */
+int disp_drill(const char *path, int depth, struct display *sinks,
+    size_t nsinks);
+void drill_free(struct drill_result *res);
+
+#endif /* ndef H_DRILL */
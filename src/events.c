@@ -0,0 +1,378 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * events.c
+ *
+ * Turn the samples taken with --watch into a stream of events, one JSON object
+ * per line and per change: file systems which appear or disappear, are
+ * remounted with other options or cross their usage thresholds (graph_medium
+ * and graph_high or their policy in the configuration file), in either
+ * direction.
+ *
+ * Usage enters a higher level as soon as it reaches its threshold but only
+ * leaves it once it went event_hysteresis points below it, and a new level is
+ * only reported once it held for event_debounce samples in a row: a file
+ * system hovering around a threshold does not flap.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "events.h"
+#include "extern.h"
+#include "policy.h"
+
+static const char *const level_names[] = { "low", "medium", "high" };
+
+/* file system followed from a sample to the next */
+struct tracked {
+	char *fsname;
+	char *fstype;
+	char *mntdir;
+	char *mntopts;
+	const struct limits *lim;	/* thresholds of its usage */
+	enum level level;	/* level last reported */
+	enum level pending;	/* level it is heading to */
+	int npending;		/* samples in a row it was heading there */
+};
+
+/* file systems of the previous sample, sorted by key */
+static struct tracked *tracked;
+static size_t ntracked;
+
+/* static function declaration */
+static int keycmp(const void *a, const void *b);
+static int trackcmp(const struct tracked *t, const struct fsmntinfo *p);
+static char *xstrdup(const char *str);
+static void json_str(const char *str);
+static void json_usage(double perctused);
+static void event_start(time_t now, const char *event,
+    const struct tracked *t);
+static void track(struct tracked *t, const struct fsmntinfo *p, time_t now);
+static void untrack(struct tracked *t, time_t now);
+static void update(struct tracked *t, const struct fsmntinfo *p,
+    time_t now);
+
+/*
+ * Compare two file systems on the keys used to follow them
+ * @a: pointer to the first fsmntinfo pointer
+ * @b: pointer to the second fsmntinfo pointer
+ */
+static int
+keycmp(const void *a, const void *b)
+{
+	const struct fsmntinfo *fa = *(const struct fsmntinfo * const *)a;
+	const struct fsmntinfo *fb = *(const struct fsmntinfo * const *)b;
+	int ret;
+
+	if ((ret = strcmp(fa->mntdir, fb->mntdir)) != 0)
+		return ret;
+	if ((ret = strcmp(fa->fsname, fb->fsname)) != 0)
+		return ret;
+	return strcmp(fa->fstype, fb->fstype);
+}
+
+/*
+ * Compare a followed file system with a file system of the sample, on the
+ * same keys as keycmp
+ * @t: followed file system
+ * @p: file system of the sample
+ */
+static int
+trackcmp(const struct tracked *t, const struct fsmntinfo *p)
+{
+	int ret;
+
+	if ((ret = strcmp(t->mntdir, p->mntdir)) != 0)
+		return ret;
+	if ((ret = strcmp(t->fsname, p->fsname)) != 0)
+		return ret;
+	return strcmp(t->fstype, p->fstype);
+}
+
+/*
+ * Return a copy of a string, exiting if there is no memory left
+ * @str: string to copy
+ */
+static char *
+xstrdup(const char *str)
+{
+	char *dup;
+
+	if ((dup = strdup(str)) == NULL) {
+		(void)fputs("Error while allocating memory to follow file "
+			"systems\n", stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+
+	return dup;
+}
+
+/*
+ * Write a string as a JSON string
+ * @str: string to write
+ */
+static void
+json_str(const char *str)
+{
+	(void)putchar('"');
+	for (; *str != '\0'; str++) {
+		if (*str == '"' || *str == '\\')
+			(void)printf("\\%c", *str);
+		else if ((unsigned char)*str < 0x20)
+			(void)printf("\\u%04x", (unsigned int)*str);
+		else
+			(void)putchar(*str);
+	}
+	(void)putchar('"');
+}
+
+/*
+ * Write the usage of a file system as a JSON number with two decimals: the
+ * locale set for the column titles may use a decimal comma, which printf would
+ * follow
+ * @perctused: usage in percent
+ */
+static void
+json_usage(double perctused)
+{
+	const char *sign = "";
+	unsigned long long n;
+
+	if (perctused < 0.0) {
+		sign = "-";
+		perctused = -perctused;
+	}
+	n = (unsigned long long)(perctused * 100.0 + 0.5);
+	(void)printf(",\"usage\":%s%llu.%02llu", sign, n / 100, n % 100);
+}
+
+/*
+ * Write the beginning of an event: what it is and which file system it is
+ * about, with the same keys as JSON export
+ * @now: time of the sample
+ * @event: what happened
+ * @t: file system
+ */
+static void
+event_start(time_t now, const char *event, const struct tracked *t)
+{
+	(void)printf("{\"time\":%lld,\"event\":\"%s\",\"filesystem\":",
+		(long long)now, event);
+	json_str(t->fsname);
+	(void)fputs(",\"type\":", stdout);
+	json_str(t->fstype);
+	(void)fputs(",\"mount_point\":", stdout);
+	json_str(t->mntdir);
+}
+
+/*
+ * Follow a file system which appeared
+ * @t: followed file system to set
+ * @p: file system of the sample
+ * @now: time of the sample
+ */
+static void
+track(struct tracked *t, const struct fsmntinfo *p, time_t now)
+{
+	t->fsname = xstrdup(p->fsname);
+	t->fstype = xstrdup(p->fstype);
+	t->mntdir = xstrdup(p->mntdir);
+	t->mntopts = xstrdup(p->mntopts);
+	t->lim = policy_match(p->fsname, p->fstype, p->mntdir);
+	t->level = t->pending = policy_level(t->lim, p->perctused, 0);
+	t->npending = 0;
+
+	event_start(now, "appeared", t);
+	(void)fputs(",\"mount_options\":", stdout);
+	json_str(t->mntopts);
+	json_usage(p->perctused);
+	(void)printf(",\"level\":\"%s\"}\n", level_names[t->level]);
+}
+
+/*
+ * Stop following a file system which disappeared
+ * @t: followed file system
+ * @now: time of the sample
+ */
+static void
+untrack(struct tracked *t, time_t now)
+{
+	event_start(now, "disappeared", t);
+	(void)printf(",\"level\":\"%s\"}\n", level_names[t->level]);
+
+	free(t->fsname);
+	free(t->fstype);
+	free(t->mntdir);
+	free(t->mntopts);
+}
+
+/*
+ * Report what changed about a followed file system since the previous sample
+ * @t: followed file system
+ * @p: file system of the sample
+ * @now: time of the sample
+ */
+static void
+update(struct tracked *t, const struct fsmntinfo *p, time_t now)
+{
+	enum level target;
+
+	if (strcmp(t->mntopts, p->mntopts) != 0) {
+		event_start(now, "remounted", t);
+		(void)fputs(",\"from\":", stdout);
+		json_str(t->mntopts);
+		(void)fputs(",\"to\":", stdout);
+		json_str(p->mntopts);
+		(void)fputs("}\n", stdout);
+		free(t->mntopts);
+		t->mntopts = xstrdup(p->mntopts);
+	}
+
+	/* a level is only left once usage is event_hysteresis points below */
+	target = policy_level(t->lim, p->perctused, 0);
+	if (target < t->level) {
+		target = policy_level(t->lim, p->perctused +
+			(double)cnf.ehyst, 0);
+		if (target > t->level)
+			target = t->level;
+	}
+
+	if (target == t->level) {
+		t->npending = 0;
+		return;
+	}
+	if (t->npending == 0 || target != t->pending) {
+		t->pending = target;
+		t->npending = 0;
+	}
+	/* and a new one once it held for event_debounce samples */
+	if (++t->npending < cnf.edebounce)
+		return;
+
+	event_start(now, "level", t);
+	json_usage(p->perctused);
+	(void)printf(",\"from\":\"%s\",\"to\":\"%s\"}\n",
+		level_names[t->level], level_names[target]);
+	t->level = target;
+	t->npending = 0;
+}
+
+/*
+ * Write the events between the previous sample and this one, skipping the
+ * file systems marked as ignored (see filter_list), and empty the queue. The
+ * file systems of the first sample all appear.
+ * Return -1 if the events could not be written, 0 otherwise.
+ * @lst: queue holding the sample
+ */
+int
+events_update(struct list *lst)
+{
+	struct fsmntinfo **arr, *p;
+	struct tracked *next;
+	size_t n = 0, i = 0, j = 0, m = 0;
+	time_t now;
+	int cmp;
+
+	now = time(NULL);
+
+	for (p = lst->head; p != NULL; p = p->next)
+		if (!p->ignored)
+			n++;
+	/* both sorted by key, to be walked at once */
+	if ((arr = malloc((n + 1) * sizeof(*arr))) == NULL ||
+	    (next = malloc((n + 1) * sizeof(*next))) == NULL) {
+		(void)fputs("Error while allocating memory to follow file "
+			"systems\n", stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	n = 0;
+	for (p = lst->head; p != NULL; p = p->next)
+		if (!p->ignored)
+			arr[n++] = p;
+	qsort(arr, n, sizeof(*arr), keycmp);
+
+	while (i < ntracked || j < n) {
+		if (j == n)
+			cmp = -1;
+		else if (i == ntracked)
+			cmp = 1;
+		else
+			cmp = trackcmp(&tracked[i], arr[j]);
+
+		if (cmp < 0) {
+			untrack(&tracked[i++], now);
+		} else if (cmp > 0) {
+			track(&next[m++], arr[j++], now);
+		} else {
+			next[m] = tracked[i++];
+			update(&next[m++], arr[j++], now);
+		}
+	}
+
+	free(tracked);
+	tracked = next;
+	ntracked = m;
+
+	free(arr);
+	for (p = lst->head; p != NULL;)
+		p = delete_struct_and_get_next(p);
+	init_queue(lst);
+
+	/* whoever reads the stream gets each sample as soon as it is taken */
+	if (fflush(stdout) == EOF || ferror(stdout))
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Stop following the file systems, without reporting them as disappeared
+ */
+void
+events_free(void)
+{
+	size_t i;
+
+	for (i = 0; i < ntracked; i++) {
+		free(tracked[i].fsname);
+		free(tracked[i].fstype);
+		free(tracked[i].mntdir);
+		free(tracked[i].mntopts);
+	}
+	free(tracked);
+	tracked = NULL;
+	ntracked = 0;
+}
@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * bin.c
+ *
+ * Binary columnar export functions (see snapshot.h for the format)
+ * NB: the whole table is needed to lay out the columns, so rows are gathered
+ * in memory and written as a single record batch when the display ends.
+ * Sizes are always stored in bytes: unit options are ignored here.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "extern.h"
+#include "export.h"
+#include "display.h"
+#include "list.h"
+#include "snapshot.h"
+#include "util.h"
+
+#ifdef NLS_ENABLED
+#include <libintl.h>
+#endif
+
+#ifndef HOST_NAME_MAX
+#define HOST_NAME_MAX 255
+#endif /* ndef HOST_NAME_MAX */
+
+/* one row of the record batch */
+struct bin_row {
+	uint64_t num[SNAP_NNUMS];
+	uint32_t str[SNAP_NSTRS];
+};
+
+/* record batch being built, private to each display */
+struct batch {
+	struct bin_row *rows;
+	size_t nrows;
+	size_t cap;
+
+	char *strtab;
+	size_t strsize;
+	size_t strcap;
+
+	/* hash table of the offsets of the strings already in strtab */
+	uint32_t *slots;
+	size_t nslots;
+	size_t nstrs;
+};
+
+/* static function declaration */
+static void bin_disp_init(struct display *d);
+static void bin_disp_deinit(struct display *d);
+static void bin_disp_header(struct display *d);
+static void bin_disp_ln_start(struct display *d, const struct row *r);
+static void bin_disp_sep(struct display *d, const struct column *prev,
+		const struct column *next);
+static void bin_disp_text(struct display *d, const struct column *col,
+		const char *str, size_t len);
+static void bin_disp_perct(struct display *d, const struct column *col,
+		double perct);
+static void bin_disp_size(struct display *d, const struct column *col,
+		bigsize_t n, double perct);
+static void bin_disp_count(struct display *d, const struct column *col,
+		int64_t n);
+static void bin_disp_ln_end(struct display *d);
+
+static uint32_t intern(struct batch *b, const struct strview *s);
+static void put_le(unsigned char *buf, uint64_t val, size_t len);
+static void nomem(void);
+
+/* init pointers from display structure to the functions found here */
+void
+init_disp_bin(struct display *disp)
+{
+	disp->init           = bin_disp_init;
+	disp->deinit         = bin_disp_deinit;
+	disp->print_header   = bin_disp_header;
+	disp->print_ln_start = bin_disp_ln_start;
+	disp->print_sep      = bin_disp_sep;
+	disp->print_text     = bin_disp_text;
+	disp->print_bar      = NULL;
+	disp->print_perct    = bin_disp_perct;
+	disp->print_size     = bin_disp_size;
+	disp->print_count    = bin_disp_count;
+	disp->print_ln_end   = bin_disp_ln_end;
+}
+
+/*
+ * Exit when running out of memory: a truncated snapshot is worse than none.
+ */
+static void
+nomem(void)
+{
+	(void)fputs("Error while allocating memory for the binary export\n",
+		stderr);
+	exit(EXIT_FAILURE);
+	/* NOTREACHED */
+}
+
+/*
+ * Store `len` bytes of `val` in little-endian order into `buf`
+ */
+static void
+put_le(unsigned char *buf, uint64_t val, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		buf[i] = (unsigned char)(val & 0xff);
+		val >>= 8;
+	}
+}
+
+/*
+ * Return the offset of `str` in the string table, adding it if it is not
+ * already there. Each distinct string is stored only once.
+ * @b: record batch
+ * @s: string to add
+ */
+static uint32_t
+intern(struct batch *b, const struct strview *s)
+{
+	const char *str = s->str;
+	size_t len = s->len + 1;
+	size_t i, j, mask;
+	uint32_t off;
+	uint32_t *slots;
+
+	/* keep the hash table at most half full */
+	if (b->nstrs * 2 >= b->nslots) {
+		j = b->nslots ? b->nslots * 2 : 64;
+		if ((slots = calloc(j, sizeof(*slots))) == NULL)
+			nomem();
+		/* offsets are stored + 1 so that 0 means an empty slot */
+		for (i = 0; i < b->nslots; i++) {
+			size_t k;
+
+			if (b->slots[i] == 0)
+				continue;
+			k = strhash(b->strtab + b->slots[i] - 1);
+			for (k &= j - 1; slots[k]; k = (k + 1) & (j - 1))
+				;
+			slots[k] = b->slots[i];
+		}
+		free(b->slots);
+		b->slots = slots;
+		b->nslots = j;
+	}
+
+	mask = b->nslots - 1;
+	for (i = strhash(str) & mask; b->slots[i]; i = (i + 1) & mask) {
+		off = b->slots[i] - 1;
+		if (strcmp(b->strtab + off, str) == 0)
+			return off;
+	}
+
+	if (b->strsize + len > UINT32_MAX) {
+		(void)fputs("String table too large for the binary export\n",
+			stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	if (b->strsize + len > b->strcap) {
+		b->strcap = (b->strsize + len) * 2;
+		if ((b->strtab = realloc(b->strtab, b->strcap)) == NULL)
+			nomem();
+	}
+
+	off = (uint32_t)b->strsize;
+	(void)memcpy(b->strtab + off, str, len);
+	b->strsize += len;
+	b->slots[i] = off + 1;
+	b->nstrs++;
+
+	return off;
+}
+
+static void
+bin_disp_init(struct display *d)
+{
+	char host[HOST_NAME_MAX + 1];
+	struct strview s;
+	struct batch *b;
+
+	if ((b = calloc(1, sizeof(*b))) == NULL)
+		nomem();
+	d->priv = b;
+
+	/* the host name comes first in the string table */
+	if (gethostname(host, sizeof(host)) == -1)
+		(void)snprintf(host, sizeof(host), "%s", g_unknown_str);
+	host[sizeof(host) - 1] = '\0';
+	s = strview(host);
+	(void)intern(b, &s);
+}
+
+/*
+ * Write the record batch and release it
+ */
+static void
+bin_disp_deinit(struct display *d)
+{
+	struct batch *b = d->priv;
+	unsigned char *buf, *p;
+	size_t strtablen, len, i;
+	int j;
+	time_t now;
+
+	/* string table zero padded to a multiple of 8 */
+	strtablen = (b->strsize + 7) & ~(size_t)7;
+	len = SNAP_HDRLEN + strtablen +
+		b->nrows * (SNAP_NNUMS * 8 + SNAP_NSTRS * 4);
+	len = (len + 7) & ~(size_t)7;
+
+	if ((buf = calloc(1, len)) == NULL)
+		nomem();
+
+	now = time(NULL);
+
+	(void)memcpy(buf, SNAP_MAGIC, 4);
+	put_le(buf + 4, SNAP_VERSION, 2);
+	put_le(buf + 6, SNAP_NNUMS, 2);
+	put_le(buf + 8, b->nrows, 4);
+	put_le(buf + 12, strtablen, 4);
+	put_le(buf + 16, now == (time_t)-1 ? 0 : (uint64_t)now, 8);
+	put_le(buf + 24, 0, 4); /* host name is the first string */
+
+	p = buf + SNAP_HDRLEN;
+	(void)memcpy(p, b->strtab, b->strsize);
+	p += strtablen;
+
+	for (j = 0; j < SNAP_NNUMS; j++)
+		for (i = 0; i < b->nrows; i++, p += 8)
+			put_le(p, b->rows[i].num[j], 8);
+	for (j = 0; j < SNAP_NSTRS; j++)
+		for (i = 0; i < b->nrows; i++, p += 4)
+			put_le(p, b->rows[i].str[j], 4);
+
+	if (fwrite(buf, 1, len, d->out) != len)
+		perror("Could not write the binary export ");
+
+	free(buf);
+	free(b->rows);
+	free(b->strtab);
+	free(b->slots);
+	free(b);
+	d->priv = NULL;
+}
+
+static void
+bin_disp_header(struct display *d)
+{
+	(void)d;
+	/* DUMMY */
+}
+
+/*
+ * A snapshot holds every column of a row, whatever the columns shown: the
+ * whole row is stored at once and the cells are ignored
+ */
+static void
+bin_disp_ln_start(struct display *d, const struct row *r)
+{
+	struct batch *b = d->priv;
+	struct bin_row *row;
+
+	/* the sum can be computed from the rows */
+	if (r->sum)
+		return;
+
+	if (b->nrows == b->cap) {
+		b->cap = b->cap ? b->cap * 2 : 32;
+		row = realloc(b->rows, b->cap * sizeof(*row));
+		if (row == NULL)
+			nomem();
+		b->rows = row;
+	}
+	row = &b->rows[b->nrows++];
+	(void)memset(row, 0, sizeof(*row));
+	row->str[SNAP_FSNAME] = intern(b, &r->fsname);
+	row->str[SNAP_FSTYPE] = intern(b, &r->fstype);
+	row->str[SNAP_MNTDIR] = intern(b, &r->mntdir);
+	row->str[SNAP_MNTOPTS] = intern(b, &r->mntopts);
+	row->num[SNAP_USED] = (uint64_t)r->used;
+	row->num[SNAP_AVAIL] = (uint64_t)r->avail;
+	row->num[SNAP_TOTAL] = (uint64_t)r->total;
+	row->num[SNAP_FILES] = (uint64_t)r->files;
+	row->num[SNAP_FAVAIL] = (uint64_t)r->favail;
+}
+
+static void
+bin_disp_sep(struct display *d, const struct column *prev,
+    const struct column *next)
+{
+	(void)d;
+	(void)prev;
+	(void)next;
+	/* DUMMY */
+}
+
+static void
+bin_disp_text(struct display *d, const struct column *col, const char *str,
+    size_t len)
+{
+	(void)d;
+	(void)col;
+	(void)str;
+	(void)len;
+	/* DUMMY: see bin_disp_ln_start */
+}
+
+static void
+bin_disp_perct(struct display *d, const struct column *col, double perct)
+{
+	(void)d;
+	(void)col;
+	(void)perct;
+	/* DUMMY: it can be computed from the sizes */
+}
+
+static void
+bin_disp_size(struct display *d, const struct column *col, bigsize_t n,
+    double perct)
+{
+	(void)d;
+	(void)col;
+	(void)n;
+	(void)perct;
+	/* DUMMY: see bin_disp_ln_start */
+}
+
+static void
+bin_disp_count(struct display *d, const struct column *col, int64_t n)
+{
+	(void)d;
+	(void)col;
+	(void)n;
+	/* DUMMY: see bin_disp_ln_start */
+}
+
+static void
+bin_disp_ln_end(struct display *d)
+{
+	(void)d;
+	/* DUMMY: the row is complete once started */
+}
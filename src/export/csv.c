@@ -37,6 +37,7 @@
  * about those
  */
 #include <stdio.h>
+#include <string.h>
 
 #include "extern.h"
 #include "export.h"
@@ -49,238 +50,185 @@
 #endif
 
 /* static function declaration */
-static void csv_disp_header(void);
-static void csv_disp_sum(double stot, double utot, double ftot,
-		double ifitot, double ifatot);
-static void csv_disp_bar(double perct);
-static void csv_disp_uat(double n, double perct, int req_width);
-static void csv_disp_fs(const char *fsname);
-static void csv_disp_type(const char *type);
-static void csv_disp_inodes(uint64_t files, uint64_t favail);
-static void csv_disp_mount(const char *dir);
-static void csv_disp_mopt(const char *opts);
-static void csv_disp_perct(double perct);
-static void csv_disp_ln_end(void);
+static void csv_disp_header(struct display *d);
+static void csv_disp_ln_start(struct display *d,
+		const struct row *r);
+static void csv_disp_sep(struct display *d, const struct column *prev,
+		const struct column *next);
+static void csv_disp_text(struct display *d, const struct column *col,
+		const char *str, size_t len);
+static void csv_disp_perct(struct display *d, const struct column *col,
+		double perct);
+static void csv_disp_size(struct display *d, const struct column *col,
+		bigsize_t n, double perct);
+static void csv_disp_count(struct display *d, const struct column *col,
+		int64_t n);
+static void csv_disp_ln_end(struct display *d);
 
 /* init pointers from display structure to the functions found here */
 void
 init_disp_csv(struct display *disp)
 {
-    disp->init         = NULL; /* not required --> not implemented here */
-    disp->deinit       = NULL; /* not required --> not implemented here */
-    disp->print_header = csv_disp_header;
-    disp->print_sum    = csv_disp_sum;
-    disp->print_bar    = csv_disp_bar;
-    disp->print_used   = csv_disp_uat;
-    disp->print_avail  = csv_disp_uat;
-    disp->print_total  = csv_disp_uat;
-    disp->print_fs     = csv_disp_fs;
-    disp->print_type   = csv_disp_type;
-    disp->print_inodes = csv_disp_inodes;
-    disp->print_mount  = csv_disp_mount;
-    disp->print_mopt   = csv_disp_mopt;
-    disp->print_perct  = csv_disp_perct;
-    disp->print_ln_end = csv_disp_ln_end;
+    disp->init           = NULL; /* not required --> not implemented here */
+    disp->deinit         = NULL; /* not required --> not implemented here */
+    disp->print_header   = csv_disp_header;
+    disp->print_ln_start = csv_disp_ln_start;
+    disp->print_sep      = csv_disp_sep;
+    disp->print_text     = csv_disp_text;
+    disp->print_bar      = NULL; /* a graph makes no sense in CSV */
+    disp->print_perct    = csv_disp_perct;
+    disp->print_size     = csv_disp_size;
+    disp->print_count    = csv_disp_count;
+    disp->print_ln_end   = csv_disp_ln_end;
 }
 
 /*
  * Display header
  */
 static void
-csv_disp_header(void)
+csv_disp_header(struct display *d)
 {
-	(void)printf(_("FILESYSTEM%c"), cnf.csvsep);
+	size_t i;
 
-	if (Tflag)
-		(void)printf(_("TYPE%c"), cnf.csvsep);
-
-	(void)printf(_("%%USED%c"), cnf.csvsep);
-
-	if (dflag)
-		(void)printf(_("USED%c"), cnf.csvsep);
-
-	(void)printf(_("AVAILABLE%c"), cnf.csvsep);
-
-	(void)printf(_("TOTAL"));
-
-	if (iflag) {
-		(void)printf(_("%c#INODES%c"), cnf.csvsep, cnf.csvsep);
-		(void)printf(_("AV.INODES"));
+	for (i = 0; i < d->ncolumns; i++) {
+		if (i > 0)
+			(void)fprintf(d->out, "%c", cnf.csvsep);
+		(void)fprintf(d->out, "%s", column_title(d->columns[i]));
 	}
 
-	if (!Mflag)
-		(void)printf("%c%s", cnf.csvsep, _("MOUNTED ON"));
-
-	if (oflag)
-		(void)printf(_("%cMOUNT OPTIONS"), cnf.csvsep);
-
-	(void)printf("\n");
+	(void)fprintf(d->out, "\n");
 }
 
 /*
- * Display the sum (useful when -s option is used
- * @stot: total size of "total"
- * @atot: total size of "available"
- * @utot: total size of "used"
- * @ifitot: total number of inodes
- * @ifatot: total number of available inodes
+ * Start a line: there is nothing to do in CSV
+ * @r: ignored here
  */
 static void
-csv_disp_sum(double stot, double atot, double utot, double ifitot, double ifatot)
+csv_disp_ln_start(struct display *d, const struct row *r)
 {
-	double ptot = 0;
-
-	if ((int)stot == 0)
-		ptot = 100.0;
-	else
-		ptot = (utot / stot) * 100.0;
-	(void)printf(_("SUM:%c"), cnf.csvsep);
-
-	if (Tflag)
-		(void)printf("%c", cnf.csvsep);
-
-	csv_disp_perct(ptot);
-
-	if (uflag) {
-		stot = cvrt(stot);
-		atot = cvrt(atot);
-		if (dflag)
-			utot = cvrt(utot);
-	}
-
-	if (dflag)
-		csv_disp_uat(utot, ptot, 0);
-	csv_disp_uat(atot, ptot, 0);
-	csv_disp_uat(stot, ptot, 0);
-
-	if (iflag)
-		csv_disp_inodes((uint64_t)ifitot, (uint64_t)ifatot);
-
-	(void)printf("\n");
+	(void)d;
+	(void)r;
 }
 
 /*
- * Should display the nice usage bar but this makes no sense in CSV export
- * Therefore, this is a dummy function that does nothing when called from
- * dfc.c but it is required in order to avoid stupid checks in dfc.c
- * @perct: is ignored
+ * Separate two cells
+ * @prev: ignored here
+ * @next: ignored here
  */
 static void
-csv_disp_bar(double perct)
+csv_disp_sep(struct display *d, const struct column *prev,
+    const struct column *next)
 {
-	(void)perct;
-	/* DUMMY */
+	(void)prev;
+	(void)next;
+
+	(void)fprintf(d->out, "%c", cnf.csvsep);
 }
 
 /*
- * Display available and total correctly formatted
- * @n: number to print
- * @perct: ignored here
- * @req_width: ignored here
+ * Display a string, quoted when it contains the separator, a quote or a new
+ * line (mount options are always quoted as they typically contain commas)
+ * @col: column
+ * @str: string, NULL if the column does not apply to the line
+ * @len: length of the string
  */
 static void
-csv_disp_uat(double n, double perct, int req_width)
+csv_disp_text(struct display *d, const struct column *col, const char *str,
+    size_t len)
 {
-	int i;
+	size_t i;
 
-	(void)perct;
-	(void)req_width;
+	if (str == NULL)
+		return;
 
-	(void)printf("%c", cnf.csvsep);
+	for (i = 0; i < len; i++) {
+		if (str[i] == cnf.csvsep || str[i] == '"' || str[i] == '\n')
+			break;
+	}
+	if (col->id != COL_OPTIONS && i == len) {
+		(void)fprintf(d->out, "%.*s", (int)len, str);
+		return;
+	}
 
-	if (unitflag == 'h') {
-		i = humanize(&n);
-		(void)printf(i == 0 ? "%.f" : "%.1f", n);
-		print_unit(i, 1);
-	} else {
-		if (unitflag == 'b')
-			(void)printf("%f", n);
-		else if (unitflag == 'k')
-			(void)printf("%f", n);
-		else
-			(void)printf("%.1f", n);
-		print_unit(0, 1);
+	(void)fprintf(d->out, "\"");
+	for (i = 0; i < len; i++) {
+		/* quotes are escaped by doubling them */
+		if (str[i] == '"')
+			(void)fprintf(d->out, "\"");
+		(void)fprintf(d->out, "%c", str[i]);
 	}
+	(void)fprintf(d->out, "\"");
 }
 
 /*
- * Display file system
- * @fsname: list of the file system to print
+ * Display used, available and total correctly formatted
+ * @col: ignored here
+ * @n: number to print
+ * @perct: ignored here
  */
 static void
-csv_disp_fs(const char *fsname)
+csv_disp_size(struct display *d, const struct column *col, bigsize_t n,
+    double perct)
 {
-	(void)printf("%s%c",fsname, cnf.csvsep);
-}
+	char buf[SIZE_BUFLEN];
+	int i, prec;
 
-/*
- * Display file system type
- * @type: the file system type to print
- */
-static void
-csv_disp_type(const char *type)
-{
-	(void)printf("%s%c", type, cnf.csvsep);
+	(void)col;
+	(void)perct;
+
+	i = size_exp(n);
+	if (unitflag == 'h')
+		prec = (i == 0) ? 0 : 1;
+	else
+		prec = (unitflag == 'b' || unitflag == 'k') ? 0 : 1;
+	fmt_size(buf, sizeof(buf), n, i, prec);
+
+	(void)fprintf(d->out, "%s", buf);
+	print_unit(d->out, i, 1);
 }
 
 /*
- * Display inodes
- *@files: number of inodes
- *@favail: number of available inodes
+ * Display a number of inodes
+ * @col: ignored here
+ * @n: number of inodes
  */
 static void
-csv_disp_inodes(uint64_t files, uint64_t favail)
+csv_disp_count(struct display *d, const struct column *col, int64_t n)
 {
+	char buf[SIZE_BUFLEN];
 	int i;
 
+	(void)col;
+
 	if (unitflag == 'h') {
-		i = humanize_i(&files);
-		(void)printf("%c%" PRIu64, cnf.csvsep, files);
-		print_unit(i, 0);
-		i = humanize_i(&favail);
-		(void)printf("%c%" PRIu64, cnf.csvsep, favail);
-		print_unit(i, 0);
+		i = humanize_i(&n);
+		fmt_count(buf, sizeof(buf), n);
+		(void)fprintf(d->out, "%s", buf);
+		print_unit(d->out, i, 0);
 	} else {
-		(void)printf("%c%" PRIu64, cnf.csvsep, files);
-		(void)printf("%c%" PRIu64, cnf.csvsep, favail);
+		fmt_count(buf, sizeof(buf), n);
+		(void)fprintf(d->out, "%s", buf);
 	}
 }
 
-/*
- * Display mount point
- * @dir: mount point
- */
-static void
-csv_disp_mount(const char *dir)
-{
-	(void)printf("%c%s", cnf.csvsep, dir);
-}
-
-/*
- * Display mount options
- * @opts: mount options
- */
-static void
-csv_disp_mopt(const char *opts)
-{
-	(void)printf("%c\"%s\"", cnf.csvsep, opts);
-}
-
 /*
  * Display percentage
+ * @col: ignored here
  * @perct: percentage
  */
 static void
-csv_disp_perct(double perct)
+csv_disp_perct(struct display *d, const struct column *col, double perct)
 {
-	(void)printf("%.f%%", perct);
+	(void)col;
+
+	(void)fprintf(d->out, "%.f%%", perct);
 }
 
 /*
  * Display line ending
  */
 static void
-csv_disp_ln_end(void)
+csv_disp_ln_end(struct display *d)
 {
-	(void)printf("\n");
+	(void)fprintf(d->out, "\n");
 }
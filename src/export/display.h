@@ -34,27 +34,59 @@
 
 #include <sys/types.h>
 #include <inttypes.h>
+#include <stdio.h>
 
-/* Structure to handle the display interface. */
+#include "column.h"
+#include "list.h"
+
+/*
+ * Structure to handle the display interface.
+ * Lines are displayed cell by cell, in the order of the columns shown (see
+ * column.c): cells are printed according to the kind of their column, which
+ * is given for its title, its key or its width.
+ * Several displays may be used at once (-e text,json:FILE): each one writes
+ * to its own stream and keeps its own state.
+ */
 struct display
 {
+	FILE *out;		/* stream the export is written to */
+	const char *dest;	/* file to write to, NULL for stdout */
+	int color;		/* use colors */
+	int width;		/* terminal width to adjust to, 0 not to */
+	int shortbar;		/* bar narrowed to fit the terminal */
+	int aligned;		/* columns are as wide as their widest value */
+
+	/* columns shown, in order */
+	const struct column *columns[COL_NCOLUMNS];
+	size_t ncolumns;
+
+	/* state while displaying a table (see print_row) */
+	size_t nlines;		/* lines displayed so far */
+	int in_sum;		/* displaying the sum of the lines */
+	const struct limits *lim;	/* thresholds of the line */
+	int first_cell;		/* no cell displayed yet on the line */
+	void *priv;		/* data private to the interface */
+
 	/* Some interfaces may need to initialize/deinitialize stuff */
-	void (*init)         (void);
-	void (*deinit)       (void);
-
-	void (*print_header) (void);
-	void (*print_sum)    (double, double, double, double, double);
-	void (*print_bar)    (double);
-	void (*print_used)   (double, double, int);
-	void (*print_avail)  (double, double, int);
-	void (*print_total)  (double, double, int);
-	void (*print_fs)     (const char *);
-	void (*print_type)   (const char *);
-	void (*print_inodes) (uint64_t, uint64_t);
-	void (*print_mount)  (const char *);
-	void (*print_mopt)   (const char *);
-	void (*print_perct)  (double);
-	void (*print_ln_end) (void);
+	void (*init)           (struct display *);
+	void (*deinit)         (struct display *);
+
+	void (*print_header)   (struct display *);
+	void (*print_ln_start) (struct display *, const struct row *);
+	void (*print_sep)      (struct display *, const struct column *,
+				const struct column *);
+	void (*print_text)     (struct display *, const struct column *,
+				const char *, size_t);
+	/* NULL when the interface cannot draw a bar */
+	void (*print_bar)      (struct display *, const struct column *,
+				double);
+	void (*print_perct)    (struct display *, const struct column *,
+				double);
+	void (*print_size)     (struct display *, const struct column *,
+				bigsize_t, double);
+	void (*print_count)    (struct display *, const struct column *,
+				int64_t);
+	void (*print_ln_end)   (struct display *);
 };
 
 #endif /* ndef H_DISPLAY */
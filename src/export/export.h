@@ -39,6 +39,7 @@
 
 #include "display.h"
 
+void init_disp_bin(struct display *disp);
 void init_disp_csv(struct display *disp);
 void init_disp_html(struct display *disp);
 void init_disp_json(struct display *disp);
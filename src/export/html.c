@@ -49,98 +49,96 @@
 #endif
 
 /* static functions declaration */
-static void html_disp_init(void);
-static void html_disp_deinit(void);
-static void html_disp_header(void);
-static void html_disp_sum(double stot, double utot, double ftot,
-                   double ifitot, double ifatot);
-static void html_disp_bar(double perct);
-static void html_disp_uat(double n, double perct, int req_width);
-static void html_disp_fs(const char *fsname);
-static void html_disp_type(const char *type);
-static void html_disp_inodes(uint64_t files, uint64_t favail);
-static void html_disp_mount(const char *dir);
-static void html_disp_mopt(const char *opts);
-static void html_disp_perct(double perct);
-static void html_disp_ln_end(void);
+static void html_disp_init(struct display *d);
+static void html_disp_deinit(struct display *d);
+static void html_disp_header(struct display *d);
+static void html_disp_ln_start(struct display *d,
+		const struct row *r);
+static void html_disp_sep(struct display *d, const struct column *prev,
+		const struct column *next);
+static void html_disp_text(struct display *d, const struct column *col,
+		const char *str, size_t len);
+static void html_disp_bar(struct display *d, const struct column *col,
+		double perct);
+static void html_disp_perct(struct display *d, const struct column *col,
+		double perct);
+static void html_disp_size(struct display *d, const struct column *col,
+		bigsize_t n, double perct);
+static void html_disp_count(struct display *d, const struct column *col,
+		int64_t n);
+static void html_disp_ln_end(struct display *d);
 
 /* init pointers from display structure to the functions found here */
 void
 init_disp_html(struct display *disp)
 {
-	disp->init         = html_disp_init;
-	disp->deinit       = html_disp_deinit;
-	disp->print_header = html_disp_header;
-	disp->print_sum    = html_disp_sum;
-	disp->print_bar    = html_disp_bar;
-	disp->print_used   = html_disp_uat;
-	disp->print_avail  = html_disp_uat;
-	disp->print_total  = html_disp_uat;
-	disp->print_fs     = html_disp_fs;
-	disp->print_type   = html_disp_type;
-	disp->print_inodes = html_disp_inodes;
-	disp->print_mount  = html_disp_mount;
-	disp->print_mopt   = html_disp_mopt;
-	disp->print_perct  = html_disp_perct;
-	disp->print_ln_end = html_disp_ln_end;
+	disp->init           = html_disp_init;
+	disp->deinit         = html_disp_deinit;
+	disp->print_header   = html_disp_header;
+	disp->print_ln_start = html_disp_ln_start;
+	disp->print_sep      = html_disp_sep;
+	disp->print_text     = html_disp_text;
+	disp->print_bar      = html_disp_bar;
+	disp->print_perct    = html_disp_perct;
+	disp->print_size     = html_disp_size;
+	disp->print_count    = html_disp_count;
+	disp->print_ln_end   = html_disp_ln_end;
 }
 
 /*
  * Print DOCTYPE and everything that is required before the html body
  */
 static void
-html_disp_init(void)
+html_disp_init(struct display *d)
 {
-	(void)puts("<!DOCTYPE html>");
-	(void)puts("<html>");
-	(void)puts("  <head>");
-	(void)puts("    <meta http-equiv=\"Content-Type\" content=\"text/html; "
-			"charset=utf-8\"/>");
-	(void)puts("    <meta name=\"author\" content=\"Robin Hahling\"/>");
-	(void)printf("    <meta name=\"description\" content=\"%s-%s - Display "
+	(void)fputs("<!DOCTYPE html>\n", d->out);
+	(void)fputs("<html>\n", d->out);
+	(void)fputs("  <head>\n", d->out);
+	(void)fputs("    <meta http-equiv=\"Content-Type\" content=\"text/html; "
+			"charset=utf-8\"/>\n", d->out);
+	(void)fputs("    <meta name=\"author\" content=\"Robin Hahling\"/>\n", d->out);
+	(void)fprintf(d->out, "    <meta name=\"description\" content=\"%s-%s - Display "
 			"file system space usage using graph and colors\"/>\n",
 			PACKAGE, VERSION);
-	(void)puts("    <meta name=\"keywords\" content=\"dfc,file system, usage, "
-			"display, cli, df\"/>");
-	(void)puts("    <style type=\"text/css\">");
-	(void)puts("\ttable { border-collapse: collapse; border: 1px solid #333; }");
-	(void)puts("\ttd, th { padding: 0.5em; border: 1px #BBBBBB solid; }");
-	if (cflag) {
-		(void)printf("\tthead, tfoot { background-color: #%s; color: #%s; }\n",
+	(void)fputs("    <meta name=\"keywords\" content=\"dfc,file system, usage, "
+			"display, cli, df\"/>\n", d->out);
+	(void)fputs("    <style type=\"text/css\">\n", d->out);
+	(void)fputs("\ttable { border-collapse: collapse; border: 1px solid #333; }\n", d->out);
+	(void)fputs("\ttd, th { padding: 0.5em; border: 1px #BBBBBB solid; }\n", d->out);
+	if (d->color) {
+		(void)fprintf(d->out, "\tthead, tfoot { background-color: #%s; color: #%s; }\n",
 			cnf.hcheadbg, cnf.hcheadfg);
-		(void)printf("\ttbody { background-color: #%s; color: #%s }\n",
+		(void)fprintf(d->out, "\ttbody { background-color: #%s; color: #%s }\n",
 			cnf.hccellbg, cnf.hccellfg);
-		(void)printf("\ttbody tr:hover { background-color: #%s; color: #%s; }\n",
+		(void)fprintf(d->out, "\ttbody tr:hover { background-color: #%s; color: #%s; }\n",
 			cnf.hchoverbg, cnf.hchoverfg);
 	} else {
-		(void)puts("\tthead, tfoot { background-color: gray; color: #FFFFFF; }");
-		(void)puts("\ttbody { background-color: #E9E9E9; color: #000000 }");
-		(void)puts("\ttbody tr:hover { background-color: #FFFFFF; color: #000000; }");
+		(void)fputs("\tthead, tfoot { background-color: gray; color: #FFFFFF; }\n", d->out);
+		(void)fputs("\ttbody { background-color: #E9E9E9; color: #000000 }\n", d->out);
+		(void)fputs("\ttbody tr:hover { background-color: #FFFFFF; color: #000000; }\n", d->out);
 	}
-	(void)puts("    </style>");
-	(void)printf("    <title>%s-%s</title>", PACKAGE, VERSION);
-	(void)puts("  </head>\n  <body>");
+	(void)fputs("    </style>\n", d->out);
+	(void)fprintf(d->out, "    <title>%s-%s</title>", PACKAGE, VERSION);
+	(void)fputs("  </head>\n  <body>\n", d->out);
 }
 
 /*
  * Close all open html tag that need to be closed after html body
  */
 static void
-html_disp_deinit(void)
+html_disp_deinit(struct display *d)
 {
-    (void)puts("\t</tr>");
-    if (sflag)
-	    (void)puts("\t</tfoot>");
-    (void)puts("    </table>\n  </body>\n</html>");
+    (void)fputs("    </table>\n  </body>\n</html>\n", d->out);
 }
 
 /*
  * Display header
  */
 static void
-html_disp_header(void)
+html_disp_header(struct display *d)
 {
 	char *date;
+	size_t i;
 
 	if ((date = fetchdate()) == NULL) {
 		if ((date = strdup(_("Unknown date"))) == NULL) {
@@ -150,251 +148,193 @@ html_disp_header(void)
 		}
 	}
 
-	(void)printf("    <table>\n    <caption style = \"caption-side: bottom;\">");
-	(void)printf(_("Generated by %s-%s on %s"), PACKAGE, VERSION, date);
-	(void)puts("</caption>");
-	(void)puts("\t<thead>\n\t<tr>");
-	(void)printf("\t  <th>%s</th>\n", _("FILESYSTEM"));
-
-	if (Tflag)
-		(void)printf("\t  <th>%s</th>\n", _("TYPE"));
-	if (!bflag)
-		(void)printf("\t  <th>USAGE</th>\n");
-
-	(void)printf("\t  <th>%s</th>\n", _("%USED"));
-	if (dflag)
-		(void)printf("\t  <th>%s</th>\n", _("USED"));
-	(void)printf("\t  <th>%s</th>\n", _("AVAILABLE"));
-	(void)printf("\t  <th>%s</th>\n", _("TOTAL"));
-
-	if (iflag) {
-		(void)printf("\t  <th>%s</th>\n", _("#INODES"));
-		(void)printf("\t  <th>%s</th>\n", _("AV.INODES"));
-	}
-
-	if (!Mflag)
-		(void)printf("\t  <th>%s</th>\n", _("MOUNTED ON"));
-
-	if (oflag)
-		(void)printf("\t  <th>%s</th>\n", _("MOUNT OPTIONS"));
-
-	(void)puts("\t</tr>\n\t</thead>");
+	(void)fprintf(d->out, "    <table>\n    <caption style = \"caption-side: bottom;\">");
+	(void)fprintf(d->out, _("Generated by %s-%s on %s"), PACKAGE, VERSION, date);
+	(void)fputs("</caption>\n", d->out);
+	(void)fputs("\t<thead>\n\t<tr>\n", d->out);
+	for (i = 0; i < d->ncolumns; i++)
+		(void)fprintf(d->out, "\t  <th>%s</th>\n",
+			column_title(d->columns[i]));
+	(void)fputs("\t</tr>\n\t</thead>\n", d->out);
 	free(date);
 }
 
 /*
- * Display the sum (useful when -s option is used
- * @stot: total size of "total"
- * @atot: total size of "available"
- * @utot: total size of "used"
- * @ifitot: total number of inodes
- * @ifatot: total number of available inodes
+ * Start a line, which is in the footer of the table for the sum
+ * @r: ignored here
  */
 static void
-html_disp_sum(double stot, double atot, double utot,
-              double ifitot, double ifatot)
+html_disp_ln_start(struct display *d, const struct row *r)
 {
-	double ptot = 0;
+	(void)r;
 
-	if ((int)stot == 0)
-		ptot = 100.0;
-	else
-		ptot = (utot / stot) * 100.0;
-
-	(void)puts("\t</tr>\n\t<tfoot>\n\t<tr>\n\t  <td><strong>SUM</strong></td>");
-
-	if (Tflag)
-		(void)puts("\t  <td>N/A</td>");
-
-	if (!bflag)
-		html_disp_bar(ptot);
-
-	html_disp_perct(ptot);
-
-	if (uflag) {
-		stot = cvrt(stot);
-		atot = cvrt(atot);
-		if (dflag)
-			utot = cvrt(utot);
-	}
-
-	if (dflag)
-		html_disp_uat(utot, ptot, 0);
+	if (d->in_sum)
+		(void)fputs("\t<tfoot>\n", d->out);
+	(void)fputs("\t<tr>\n", d->out);
+}
 
-	html_disp_uat(atot, ptot, 0);
-	html_disp_uat(stot, ptot, 0);
+/*
+ * Cells are separated by their own tags: this is a dummy function
+ * @prev: ignored here
+ * @next: ignored here
+ */
+static void
+html_disp_sep(struct display *d, const struct column *prev,
+    const struct column *next)
+{
+	(void)d;
+	(void)prev;
+	(void)next;
+	/* DUMMY */
+}
 
-	if (iflag)
-		html_disp_inodes((uint64_t)ifitot, (uint64_t)ifatot);
+/*
+ * Display a string, such as a file system name or a mount point
+ * @col: ignored here
+ * @str: string, NULL if the column does not apply to the line
+ * @len: length of the string
+ */
+static void
+html_disp_text(struct display *d, const struct column *col, const char *str,
+    size_t len)
+{
+	(void)col;
 
 	/* keep same amount of columns in table */
-	(void)puts("\t  <td>N/A</td>");
-	if (oflag)
-		(void)puts("\t  <td>N/A</td>");
+	if (str == NULL)
+		(void)fputs("\t  <td>N/A</td>\n", d->out);
+	else if (d->in_sum)
+		(void)fprintf(d->out, "\t  <td><strong>%.*s</strong></td>\n",
+			(int)len, str);
+	else
+		(void)fprintf(d->out, "\t  <td>%.*s</td>\n", (int)len, str);
 }
 
 /*
  * Display the nice usage bar
+ * @col: column
  * @perct: percentage value
  */
 static void
-html_disp_bar(double perct)
+html_disp_bar(struct display *d, const struct column *col, double perct)
 {
 	int barwidth = 100; /* In pixels */
 	int barheight = 25; /* In pixels */
+	int medium = d->lim->medium;
+	int high = d->lim->high;
 	int size;
 
-	(void)puts("\t  <td>");
+	(void)fputs("\t  <td>\n", d->out);
 
-	if (wflag)
+	if (*col->width == GRAPHBAR_WIDE)
 		barwidth *= 2;
 
-	if (!cflag) {
-		(void)printf("\t    <span style=\"width: %dpx; height: %dpx; "
+	if (!d->color) {
+		(void)fprintf(d->out, "\t    <span style=\"width: %dpx; height: %dpx; "
 			"background-color:silver; float: left;\"></span>\n",
                        (int)perct*barwidth/100, barheight);
 	} else { /* color */
-		size = (perct < cnf.gmedium) ? (int)perct : cnf.gmedium;
-		(void)printf("\t    <span style=\"width:%dpx; height: %dpx; "
+		size = (perct < medium) ? (int)perct : medium;
+		(void)fprintf(d->out, "\t    <span style=\"width:%dpx; height: %dpx; "
 			"background-color: #%s; float: left;\"></span>\n",
                        size * barwidth / 100, barheight, cnf.hclow);
 
-		if (perct >= cnf.gmedium) {
-			size = (perct < cnf.ghigh) ? (int)perct : cnf.ghigh;
-			size -= cnf.gmedium;
-			(void)printf("\t    <span style=\"width: %dpx; height: %dpx; "
+		if (perct >= medium) {
+			size = (perct < high) ? (int)perct : high;
+			size -= medium;
+			(void)fprintf(d->out, "\t    <span style=\"width: %dpx; height: %dpx; "
 			    "background-color: #%s; float: left;\"></span>\n",
                            size * barwidth / 100, barheight, cnf.hcmedium);
 		}
 
-		if (perct >= cnf.ghigh) {
-			size = (int)perct - cnf.ghigh;
-			(void)printf("\t    <span style=\"width: %dpx; height: %dpx; "
+		if (perct >= high) {
+			size = (int)perct - high;
+			(void)fprintf(d->out, "\t    <span style=\"width: %dpx; height: %dpx; "
 				"background-color: #%s; float: left;\"></span>\n",
                            size * barwidth / 100, barheight, cnf.hchigh);
 		}
 	}
-	(void)puts("\t  </td>");
+	(void)fputs("\t  </td>\n", d->out);
 }
 
 /*
- * Display available and total correctly formatted
+ * Display used, available and total correctly formatted
+ * @col: ignored here
  * @n: number to print
  * @perct: ignored here
- * @req_width: ignored here
  */
 static void
-html_disp_uat(double n, double perct, int req_width)
+html_disp_size(struct display *d, const struct column *col, bigsize_t n,
+    double perct)
 {
+	char buf[SIZE_BUFLEN];
 	int i;
 
+	(void)col;
 	(void)perct;
-	(void)req_width;
 
-	(void)printf("\t  <td style = \"text-align: right;\">");
+	(void)fprintf(d->out, "\t  <td style = \"text-align: right;\">");
 
+	i = size_exp(n);
 	if (unitflag == 'h') {
-		i = humanize(&n);
-		(void)printf(i == 0 ? "%.f" : "%.1f", n);
-		print_unit(i, 1);
+		fmt_size(buf, sizeof(buf), n, i, (i == 0) ? 0 : 1);
+		(void)fprintf(d->out, "%s", buf);
+		print_unit(d->out, i, 1);
 	} else {
-		if (unitflag == 'b' || unitflag == 'k')
-			(void)printf("%.f", n);
-		else
-			(void)printf("%.1f", n);
+		fmt_size(buf, sizeof(buf), n, i,
+		    (unitflag == 'b' || unitflag == 'k') ? 0 : 1);
+		(void)fprintf(d->out, "%s", buf);
 	}
-	(void)puts("</td>");
-}
-
-/*
- * Display file system
- * @fsname: list of the file system to print
- */
-static void
-html_disp_fs(const char *fsname)
-{
-	static int must_close = 0;
-
-	if (must_close == 1)
-		(void)puts("\t</tr>");
-
-	(void)printf("\t<tr>\n\t  <td>%s</td>\n", fsname);
-	must_close = 1;
+	(void)fputs("</td>\n", d->out);
 }
 
 /*
- * Display file system type
- * @type: the file system type to print
+ * Display a number of inodes
+ * @col: ignored here
+ * @n: number of inodes
  */
 static void
-html_disp_type(const char *type)
-{
-	(void)printf("\t  <td>%s</td>\n", type);
-}
-
-/*
- * Display inodes
- *@files: number of inodes
- *@favail: number of available inodes
- */
-static void
-html_disp_inodes(uint64_t files, uint64_t favail)
+html_disp_count(struct display *d, const struct column *col, int64_t n)
 {
+	char buf[SIZE_BUFLEN];
 	int i;
 
+	(void)col;
+
 	if (unitflag == 'h') {
-		i = humanize_i(&files);
-		(void)printf("\t  <td style = \"text-align: right;\">%" PRIu64,
-				files);
-		print_unit(i, 0);
-		(void)printf("</td>\n");
-		i = humanize_i(&favail);
-		(void)printf("\t  <td style = \"text-align: right;\">%" PRIu64,
-				favail);
-		print_unit(i, 0);
-		(void)printf("</td>\n");
+		i = humanize_i(&n);
+		fmt_count(buf, sizeof(buf), n);
+		(void)fprintf(d->out, "\t  <td style = \"text-align: right;\">%s", buf);
+		print_unit(d->out, i, 0);
+		(void)fprintf(d->out, "</td>\n");
 	} else {
-		(void)printf("\t  <td style = \"text-align: right;\">%" PRIu64
-				"</td>\n", files);
-		(void)printf("\t  <td style = \"text-align: right;\">%" PRIu64
-				"</td>\n", favail);
+		fmt_count(buf, sizeof(buf), n);
+		(void)fprintf(d->out, "\t  <td style = \"text-align: right;\">%s"
+				"</td>\n", buf);
 	}
 }
 
-/*
- * Display mount point
- * @dir: mount point
- */
-static void
-html_disp_mount(const char *dir)
-{
-	(void)printf("\t  <td>%s</td>\n", dir);
-}
-
-/*
- * Display mount options
- * @opts: mount options
- */
-static void
-html_disp_mopt(const char *opts)
-{
-	(void)printf("\t  <td>%s</td>\n", opts);
-}
-
 /*
  * Display percentage
+ * @col: ignored here
  * @perct: percentage
  */
 static void
-html_disp_perct(double perct)
+html_disp_perct(struct display *d, const struct column *col, double perct)
 {
-	(void)printf("\t  <td style = \"text-align: right;\">%.f%%</td>\n", perct);
+	(void)col;
+
+	(void)fprintf(d->out, "\t  <td style = \"text-align: right;\">%.f%%</td>\n",
+		perct);
 }
 
 /*
  * Display line ending
  */
 static void
-html_disp_ln_end(void)
+html_disp_ln_end(struct display *d)
 {
+	(void)fputs("\t</tr>\n", d->out);
+	if (d->in_sum)
+		(void)fputs("\t</tfoot>\n", d->out);
 }
@@ -49,207 +49,154 @@
 #include <libintl.h>
 #endif
 
-static int first_element;
-
 /* static function declaration */
-static void json_disp_init(void);
-static void json_disp_deinit(void);
-static void json_disp_header(void);
-static void json_disp_sum(double stot, double utot, double ftot, double ifitot,
-		double ifatot);
-static void json_disp_bar(double perct);
-static void json_disp_uat(double n, const char *key);
-static void json_disp_used(double used, double perct, int req_width);
-static void json_disp_avail(double avail, double perct, int req_width);
-static void json_disp_total(double total, double perct, int req_width);
-static void json_disp_fs(const char *fsname);
-static void json_disp_type(const char *type);
-static void json_disp_inodes(uint64_t files, uint64_t favail);
-static void json_disp_mount(const char *dir);
-static void json_disp_mopt(const char *opts);
-static void json_disp_perct(double perct);
-static void json_disp_ln_end(void);
+static void json_disp_init(struct display *d);
+static void json_disp_deinit(struct display *d);
+static void json_disp_header(struct display *d);
+static void json_disp_ln_start(struct display *d,
+		const struct row *r);
+static void json_disp_sep(struct display *d, const struct column *prev,
+		const struct column *next);
+static void json_disp_key(struct display *d, const struct column *col);
+static void json_disp_text(struct display *d, const struct column *col,
+		const char *str, size_t len);
+static void json_disp_perct(struct display *d, const struct column *col,
+		double perct);
+static void json_disp_size(struct display *d, const struct column *col,
+		bigsize_t n, double perct);
+static void json_disp_count(struct display *d, const struct column *col,
+		int64_t n);
+static void json_disp_ln_end(struct display *d);
 
 /* init pointers from display structure to the functions found here */
 void
 init_disp_json(struct display *disp)
 {
-	disp->init         = json_disp_init;
-	disp->deinit       = json_disp_deinit;
-	disp->print_header = json_disp_header;
-	disp->print_sum    = json_disp_sum;
-	disp->print_bar    = json_disp_bar;
-	disp->print_used   = json_disp_used;
-	disp->print_avail  = json_disp_avail;
-	disp->print_total  = json_disp_total;
-	disp->print_fs     = json_disp_fs;
-	disp->print_type   = json_disp_type;
-	disp->print_inodes = json_disp_inodes;
-	disp->print_mount  = json_disp_mount;
-	disp->print_mopt   = json_disp_mopt;
-	disp->print_perct  = json_disp_perct;
-	disp->print_ln_end = json_disp_ln_end;
+	disp->init           = json_disp_init;
+	disp->deinit         = json_disp_deinit;
+	disp->print_header   = json_disp_header;
+	disp->print_ln_start = json_disp_ln_start;
+	disp->print_sep      = json_disp_sep;
+	disp->print_text     = json_disp_text;
+	disp->print_bar      = NULL;
+	disp->print_perct    = json_disp_perct;
+	disp->print_size     = json_disp_size;
+	disp->print_count    = json_disp_count;
+	disp->print_ln_end   = json_disp_ln_end;
 }
 
 static void
-json_disp_init(void)
+json_disp_init(struct display *d)
 {
-	(void)printf("{\"filesystems\":[");
-	first_element = 1;
+	(void)fprintf(d->out, "{\"filesystems\":[");
 }
 
 static void
-json_disp_deinit(void)
+json_disp_deinit(struct display *d)
 {
-	if (sflag)
-		(void)printf("}\n");  /* sum func closes the list of fs */
+	if (d->in_sum)
+		(void)fputs("}\n", d->out); /* the sum closes the list of fs */
 	else
-		(void)printf("]}\n");
+		(void)fputs("]}\n", d->out);
 }
 
 static void
-json_disp_header(void)
+json_disp_header(struct display *d)
 {
+	(void)d;
 	/* DUMMY */
 }
 
 static void
-json_disp_sum(double stot, double atot, double utot, double ifitot, double ifatot)
+json_disp_ln_start(struct display *d, const struct row *r)
 {
-	double ptot = 0.0;
+	(void)r;
 
-	if ((int)stot == 0)
-		ptot = 100.0;
+	if (d->in_sum)
+		(void)fprintf(d->out, "],\"sum\":{");
+	else if (d->nlines > 0)
+		(void)fprintf(d->out, ",{");
 	else
-		ptot = (utot / stot) * 100.0;
-
-	(void)printf("],\"sum\":{\"usage\":\"%f%%\"", ptot);
-
-	if (uflag) {
-		stot = cvrt(stot);
-		atot = cvrt(atot);
-		if (dflag)
-			utot = cvrt(utot);
-	}
-
-	if (dflag)
-		json_disp_uat(utot, "used");
-
-	json_disp_uat(atot, "available");
-	json_disp_uat(stot, "total");
-
-	if (iflag)
-		json_disp_inodes((uint64_t)ifitot, (uint64_t)ifatot);
-
-	(void)printf("}");
+		(void)fprintf(d->out, "{");
 }
 
 static void
-json_disp_bar(double perct)
+json_disp_sep(struct display *d, const struct column *prev,
+    const struct column *next)
 {
-	(void)perct;
-	/* DUMMY */
+	(void)d;
+	(void)prev;
+	(void)next;
+	/* DUMMY: cells may be left out, see json_disp_key */
 }
 
 static void
-json_disp_uat(double n, const char *key)
+json_disp_key(struct display *d, const struct column *col)
 {
-	int i;
-	i = 0;
-
-	if (unitflag == 'h')
-		i = humanize(&n);
-
-	(void)printf(",\"%s\":\"", key);
-	(void)printf(i == 0 ? "%.f" : "%.1f", n);
-	print_unit(i, 1);
-	(void)printf("\"");
+	if (!d->first_cell)
+		(void)fprintf(d->out, ",");
+	(void)fprintf(d->out, "\"%s\":", col->key);
+	d->first_cell = 0;
 }
 
 static void
-json_disp_used(double used, double perct, int req_width)
+json_disp_text(struct display *d, const struct column *col, const char *str,
+    size_t len)
 {
-	(void)perct;
-	(void)req_width;
+	/* the sum only holds numbers */
+	if (d->in_sum || str == NULL)
+		return;
 
-	json_disp_uat(used, "used");
+	json_disp_key(d, col);
+	(void)fprintf(d->out, "\"%.*s\"", (int)len, str);
 }
 
 static void
-json_disp_avail(double avail, double perct, int req_width)
+json_disp_size(struct display *d, const struct column *col, bigsize_t n,
+    double perct)
 {
-	(void)perct;
-	(void)req_width;
-
-	json_disp_uat(avail, "available");
-}
+	char buf[SIZE_BUFLEN];
+	int i;
 
-static void
-json_disp_total(double total, double perct, int req_width)
-{
 	(void)perct;
-	(void)req_width;
 
-	json_disp_uat(total, "total");
-}
+	i = size_exp(n);
+	fmt_size(buf, sizeof(buf), n, i, (unitflag == 'h' && i != 0) ? 1 : 0);
 
-static void
-json_disp_fs(const char *fsname)
-{
-	if (!first_element)
-		(void)printf(",");
-	(void)printf("{\"filesystem\":\"%s\",", fsname);
-
-	if (first_element)
-		first_element = 0;
-}
-
-static void
-json_disp_type(const char *type)
-{
-	(void)printf("\"type\":\"%s\",", type);
+	json_disp_key(d, col);
+	(void)fprintf(d->out, "\"%s", buf);
+	print_unit(d->out, i, 1);
+	(void)fprintf(d->out, "\"");
 }
 
 static void
-json_disp_inodes(uint64_t files, uint64_t favail)
+json_disp_count(struct display *d, const struct column *col, int64_t n)
 {
+	char buf[SIZE_BUFLEN];
 	int i;
 
+	json_disp_key(d, col);
 	if (unitflag == 'h') {
-		i = humanize_i(&files);
-		(void)printf(",\"inodes_count\":\"%" PRIu64, files);
-		print_unit(i, 0);
-		(void)printf("\"");
-		i = humanize_i(&favail);
-		(void)printf(",\"inodes_available\":\"%" PRIu64, favail);
-		print_unit(i, 0);
-		(void)printf("\"");
+		i = humanize_i(&n);
+		fmt_count(buf, sizeof(buf), n);
+		(void)fprintf(d->out, "\"%s", buf);
+		print_unit(d->out, i, 0);
+		(void)fprintf(d->out, "\"");
 	} else {
-		(void)printf(",\"inodes_count\":\"%" PRIu64 "\"", files);
-		(void)printf(",\"inodes_available\":%" PRIu64 "\"", favail);
+		fmt_count(buf, sizeof(buf), n);
+		(void)fprintf(d->out, "\"%s\"", buf);
 	}
 }
 
 static void
-json_disp_mount(const char *dir)
-{
-	(void)printf(",\"mount_point\":\"%s\"", dir);
-}
-
-static void
-json_disp_mopt(const char *opts)
-{
-	(void)printf(",\"mount_options\":\"%s\"", opts);
-}
-
-static void
-json_disp_perct(double perct)
+json_disp_perct(struct display *d, const struct column *col, double perct)
 {
-	(void)printf("\"usage\":\"%f%%\"", perct);
+	json_disp_key(d, col);
+	(void)fprintf(d->out, "\"%f%%\"", perct);
 }
 
 static void
-json_disp_ln_end(void)
+json_disp_ln_end(struct display *d)
 {
-	(void)printf("}");
+	(void)fprintf(d->out, "}");
 }
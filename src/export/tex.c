@@ -37,6 +37,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "extern.h"
 #include "export.h"
@@ -48,73 +49,65 @@
 #include <libintl.h>
 #endif
 
+/* characters to escape */
+#define TEX_SPECIAL "_%#&$"
+
 /* static function declaration */
-static void tex_disp_init(void);
-static void tex_disp_deinit(void);
-static void tex_disp_header(void);
-static void tex_disp_sum(double stot, double utot, double ftot,
-                  double ifitot, double ifatot);
-static void tex_disp_bar(double perct);
-static void tex_disp_uat(double n, double perct, int req_width);
-static void tex_disp_fs(const char *fsname);
-static void tex_disp_type(const char *type);
-static void tex_disp_inodes(uint64_t files, uint64_t favail);
-static void tex_disp_mount(const char *dir);
-static void tex_disp_mopt(const char *opts);
-static void tex_disp_perct(double perct);
-static void tex_disp_ln_end(void);
+static void tex_disp_init(struct display *d);
+static void tex_disp_deinit(struct display *d);
+static void tex_disp_header(struct display *d);
+static void tex_disp_ln_start(struct display *d,
+		const struct row *r);
+static void tex_disp_sep(struct display *d, const struct column *prev,
+		const struct column *next);
+static void tex_disp_text(struct display *d, const struct column *col,
+		const char *str, size_t len);
+static void tex_disp_bar(struct display *d, const struct column *col,
+		double perct);
+static void tex_disp_perct(struct display *d, const struct column *col,
+		double perct);
+static void tex_disp_size(struct display *d, const struct column *col,
+		bigsize_t n, double perct);
+static void tex_disp_count(struct display *d, const struct column *col,
+		int64_t n);
+static void tex_disp_ln_end(struct display *d);
 
 /* init pointers from display structure to the functions found here */
 void
 init_disp_tex(struct display *disp)
 {
-	disp->init         = tex_disp_init;
-	disp->deinit       = tex_disp_deinit;
-	disp->print_header = tex_disp_header;
-	disp->print_sum    = tex_disp_sum;
-	disp->print_bar    = tex_disp_bar;
-	disp->print_used   = tex_disp_uat;
-	disp->print_avail  = tex_disp_uat;
-	disp->print_total  = tex_disp_uat;
-	disp->print_fs     = tex_disp_fs;
-	disp->print_type   = tex_disp_type;
-	disp->print_inodes = tex_disp_inodes;
-	disp->print_mount  = tex_disp_mount;
-	disp->print_mopt   = tex_disp_mopt;
-	disp->print_perct  = tex_disp_perct;
-	disp->print_ln_end = tex_disp_ln_end;
+	disp->init           = tex_disp_init;
+	disp->deinit         = tex_disp_deinit;
+	disp->print_header   = tex_disp_header;
+	disp->print_ln_start = tex_disp_ln_start;
+	disp->print_sep      = tex_disp_sep;
+	disp->print_text     = tex_disp_text;
+	disp->print_bar      = tex_disp_bar;
+	disp->print_perct    = tex_disp_perct;
+	disp->print_size     = tex_disp_size;
+	disp->print_count    = tex_disp_count;
+	disp->print_ln_end   = tex_disp_ln_end;
 }
 
 /*
  * Print all that is required for the TeX file like documentclass and so on
- * Also, computes and print the required amount of columns for the table.
+ * Also, print the required amount of columns for the table.
  */
 static void
-tex_disp_init(void)
+tex_disp_init(struct display *d)
 {
-	int i;
-	int ncolumns = 5;
-
-	(void)puts("\\documentclass[a4]{report}");
-	(void)puts("\\usepackage[landscape]{geometry}");
-	if (cflag)
-		(void)puts("\\usepackage{color}");
-	(void)puts("\\begin{document}");
-
-	if (Tflag)
-		ncolumns++;
-	if (!bflag)
-		ncolumns++;
-	if (dflag)
-		ncolumns++;
-	if (iflag)
-		ncolumns += 2;
-	if (oflag)
-		ncolumns++;
-	(void)printf("\\begin{tabular}{");
-	for (i = 0; i < ncolumns; i++)
-		(void)printf("|l");
-	printf("|}\n");
+	size_t i;
+
+	(void)fputs("\\documentclass[a4]{report}\n", d->out);
+	(void)fputs("\\usepackage[landscape]{geometry}\n", d->out);
+	if (d->color)
+		(void)fputs("\\usepackage{color}\n", d->out);
+	(void)fputs("\\begin{document}\n", d->out);
+
+	(void)fprintf(d->out, "\\begin{tabular}{");
+	for (i = 0; i < d->ncolumns; i++)
+		(void)fprintf(d->out, "|l");
+	(void)fprintf(d->out, "|}\n");
 
 }
 
@@ -122,101 +115,101 @@ tex_disp_init(void)
  * Close TeX file (end document and so on)
  */
 static void
-tex_disp_deinit(void)
+tex_disp_deinit(struct display *d)
 {
-	(void)puts("\\\\");
-	(void)puts("\\hline");
-	(void)puts("\\end{tabular}");
-	(void)puts("\\end{document}");
+	if (d->nlines > 0)
+		(void)fputs("\\\\\n", d->out);
+	(void)fputs("\\hline\n", d->out);
+	(void)fputs("\\end{tabular}\n", d->out);
+	(void)fputs("\\end{document}\n", d->out);
 }
 
 /*
  * Display header
  */
 static void
-tex_disp_header(void)
+tex_disp_header(struct display *d)
 {
-	(void)puts("\\hline");
-	(void)printf("%s", _("FILESYSTEM"));
-	if (Tflag)
-		(void)printf(" & %s", _("TYPE"));
-	if (!bflag)
-		(void)printf(" & %s", _("USAGE"));
-	(void)printf(" & %s", _("\\%USED"));
-	if (dflag)
-		(void)printf(" & %s", _("USED"));
-	(void)printf(" & %s ", _("AVAILABLE"));
-	(void)printf(" & %s ", _("TOTAL"));
-	if (iflag) {
-		(void)printf(" & %s ", _("\\#INODES"));
-		(void)printf(" & %s ", _("AV.INODES,"));
+	const char *title;
+	size_t i;
+
+	(void)fputs("\\hline\n", d->out);
+	for (i = 0; i < d->ncolumns; i++) {
+		if (i > 0)
+			(void)fprintf(d->out, " & ");
+		title = column_title(d->columns[i]);
+		tex_disp_text(d, d->columns[i], title, strlen(title));
 	}
-	if (!Mflag)
-		(void)printf(" & %s ", _("MOUNTED ON"));
-	if (oflag)
-		(void)printf(" & %s ", _("MOUNT OPTIONS"));
 
-	(void)puts("\\\\");
-	(void)puts("\\hline");
+	(void)fputs(" \\\\\n", d->out);
+	(void)fputs("\\hline\n", d->out);
 }
 
 /*
- * Display the sum (useful when -s option is used
- * @stot: total size of "total"
- * @atot: total size of "available"
- * @utot: total size of "used"
- * @ifitot: total number of inodes
- * @ifatot: total number of available inodes
+ * Start a line, ending the previous one on a line of its own, or on the same
+ * line for the sum
+ * @r: ignored here
  */
 static void
-tex_disp_sum(double stot, double atot, double utot,
-             double ifitot, double ifatot)
+tex_disp_ln_start(struct display *d, const struct row *r)
 {
-	double ptot = 0;
+	(void)r;
 
-	if ((int)stot == 0)
-		ptot = 100.0;
-	else
-		ptot = (utot / stot) * 100.0;
+	if (d->nlines == 0)
+		return;
+	(void)fputs(d->in_sum ? "\\\\ " : "\\\\\n", d->out);
+}
 
-	(void)printf("\\\\ SUM");
+/*
+ * Separate two cells
+ * @prev: ignored here
+ * @next: ignored here
+ */
+static void
+tex_disp_sep(struct display *d, const struct column *prev,
+    const struct column *next)
+{
+	(void)prev;
+	(void)next;
 
-	if (Tflag)
-		(void)printf(" & N/A");
+	(void)fprintf(d->out, " & ");
+}
 
-	if (!bflag)
-		tex_disp_bar(ptot);
+/*
+ * Display a string, such as a file system name or a mount point
+ * @col: column
+ * @str: string, NULL if the column does not apply to the line
+ * @len: length of the string
+ */
+static void
+tex_disp_text(struct display *d, const struct column *col, const char *str,
+    size_t len)
+{
+	size_t i;
 
-	tex_disp_perct(ptot);
+	(void)col;
 
-	if (uflag) {
-		stot = cvrt(stot);
-		atot = cvrt(atot);
-		if (dflag)
-			utot = cvrt(utot);
+	/* keep same amount of columns in table */
+	if (str == NULL) {
+		(void)fprintf(d->out, "N/A");
+		return;
 	}
 
-	if (dflag)
-		tex_disp_uat(utot, ptot, 0);
-
-	tex_disp_uat(atot, ptot, 0);
-	tex_disp_uat(stot, ptot, 0);
-
-	if (iflag)
-		tex_disp_inodes((uint64_t)ifitot, (uint64_t)ifatot);
-
-	/* keep same amount of columns in table */
-	(void)printf(" & NA");
-	if (oflag)
-		(void)printf(" & NA ");
+	/* characters TeX treats specially are escaped, such as "_" by "\_" */
+	for (i = 0; i < len; i++) {
+		if (strchr(TEX_SPECIAL, str[i]) != NULL)
+			(void)fputc('\\', d->out);
+		(void)fputc(str[i], d->out);
+	}
 }
 
 /*
  * Display the nice usage bar
+ * @col: column
  * @perct: percentage value
  */
 static void
-tex_disp_bar(double perct)
+tex_disp_bar(struct display *d, const struct column *col, double perct)
 {
 	/*
 	 * It could be nice to have a non-ASCII graph bar but it requires TeX
@@ -226,183 +219,112 @@ tex_disp_bar(double perct)
 	int i, j;
 	int barinc = 5;
 
-	(void)printf(" & ");
-
 	/* option to display a wider bar */
-	if (wflag) {
+	if (*col->width == GRAPHBAR_WIDE) {
 		barinc = 2;
 	}
 
-	if (!cflag) {
+	if (!d->color) {
 		for (i = 0; i < perct; i += barinc)
-			(void)printf("%c", cnf.gsymbol);
+			(void)fprintf(d->out, "%c", cnf.gsymbol);
 
 		for (j = i; j < 100; j += barinc)
-			(void)printf("\\-");
+			(void)fprintf(d->out, "\\-");
 	} else { /* color */
 		/* green */
-		(void)printf("\\textcolor{%s}{", colortostr(cnf.clow));
-		for (i = 0; (i < cnf.gmedium) && (i < perct); i += barinc)
-			(void)printf("%c", cnf.gsymbol);
+		(void)fprintf(d->out, "\\textcolor{%s}{",
+			colortostr(cnf.clow));
+		for (i = 0; (i < d->lim->medium) && (i < perct); i += barinc)
+			(void)fprintf(d->out, "%c", cnf.gsymbol);
 
 		/* yellow */
-		(void)printf("}\\textcolor{%s}{", colortostr(cnf.cmedium));
-		for (; (i < cnf.ghigh) && (i < perct); i += barinc)
-			(void)printf("%c", cnf.gsymbol);
+		(void)fprintf(d->out, "}\\textcolor{%s}{",
+			colortostr(cnf.cmedium));
+		for (; (i < d->lim->high) && (i < perct); i += barinc)
+			(void)fprintf(d->out, "%c", cnf.gsymbol);
 
 		/* red */
-		(void)printf("}\\textcolor{%s}{", colortostr(cnf.chigh));
+		(void)fprintf(d->out, "}\\textcolor{%s}{",
+			colortostr(cnf.chigh));
 		for (; (i < 100) && (i < perct); i += barinc)
-			(void)printf("%c", cnf.gsymbol);
+			(void)fprintf(d->out, "%c", cnf.gsymbol);
 
-		(void)printf("}");
+		(void)fprintf(d->out, "}");
 
 		for (j = i; j < 100; j += barinc)
-			(void)printf("\\-");
+			(void)fprintf(d->out, "\\-");
 	}
 }
 
 /*
- * Display available and total correctly formatted
+ * Display used, available and total correctly formatted
+ * @col: ignored here
  * @n: number to print
- * @perct: percentage (useful for finding which color to use)
- * @req_width: ignored here
+ * @perct: ignored here
  */
 static void
-tex_disp_uat(double n, double perct, int req_width)
+tex_disp_size(struct display *d, const struct column *col, bigsize_t n,
+    double perct)
 {
-	int i;
+	char buf[SIZE_BUFLEN];
+	int i, prec;
 
+	(void)col;
 	(void)perct;
-	(void)req_width;
-
-	if (unitflag == 'h') {
-		i = humanize(&n);
-		(void)printf(i == 0 ? " & %.f" : " & %.1f", n);
-		print_unit(i, 1);
-	} else {
-		if (unitflag == 'b' || unitflag == 'k')
-			(void)printf(" & %.f", n);
-		else
-			(void)printf(" & %.1f", n);
-		print_unit(0, 1);
-	}
-}
-
-/*
- * Display file system
- * @fsname: list of the file system to print
- */
-static void
-tex_disp_fs(const char *fsname)
-{
-	static int must_close = 0;
-	char *cleaned_fsname = sanitizestr(fsname);
-
-	if (cleaned_fsname == NULL) {
-		(void)fputs("Cannot print file system name\n", stderr);
-		return;
-	}
-
-	if (must_close == 1)
-		(void)puts("\\\\");
-
-	(void)printf("%s", cleaned_fsname);
-	free(cleaned_fsname);
-
-	must_close = 1;
-}
-
-/*
- * Display file system type
- * @type: the file system type to print
- */
-static void
-tex_disp_type(const char *type)
-{
-	char *cleaned_type = sanitizestr(type);
 
-	if (cleaned_type == NULL) {
-		(void)fputs("Cannot print type\n", stderr);
-		return;
-	}
+	i = size_exp(n);
+	if (unitflag == 'h')
+		prec = (i == 0) ? 0 : 1;
+	else
+		prec = (unitflag == 'b' || unitflag == 'k') ? 0 : 1;
+	fmt_size(buf, sizeof(buf), n, i, prec);
 
-	(void) printf(" & %s", cleaned_type);
-	free(cleaned_type);
+	(void)fprintf(d->out, "%s", buf);
+	print_unit(d->out, i, 1);
 }
 
 /*
- * Display inodes
- *@files: number of inodes
- *@favail: number of available inodes
+ * Display a number of inodes
+ * @col: ignored here
+ * @n: number of inodes
  */
 static void
-tex_disp_inodes(uint64_t files, uint64_t favail)
+tex_disp_count(struct display *d, const struct column *col, int64_t n)
 {
+	char buf[SIZE_BUFLEN];
 	int i;
 
-	if (unitflag == 'h') {
-		i = humanize_i(&files);
-		(void)printf(" & %" PRIu64, files);
-		print_unit(i, 0);
-		i = humanize_i(&favail);
-		(void)printf(" & %" PRIu64, favail);
-		print_unit(i, 0);
-	} else
-		(void)printf(" & %" PRIu64 " & %" PRIu64, files, favail);
-}
-
-/*
- * Display mount point
- * @dir: mount point
- */
-static void
-tex_disp_mount(const char *dir)
-{
-	char *cleaned_dir = sanitizestr(dir);
-
-	if (cleaned_dir == NULL) {
-		(void)fputs("Cannot print mount point\n", stderr);
-		return;
-	}
-
-	(void)printf(" & %s", cleaned_dir);
-	free(cleaned_dir);
-}
-
-/*
- * Display mount options
- * @opts: mount options
- */
-static void
-tex_disp_mopt(const char *opts)
-{
-	char *cleaned_opts = sanitizestr(opts);
+	(void)col;
 
-	if (cleaned_opts == NULL) {
-		(void)fputs("Cannot print mount options\n", stderr);
-		return;
+	if (unitflag == 'h') {
+		i = humanize_i(&n);
+		fmt_count(buf, sizeof(buf), n);
+		(void)fprintf(d->out, "%s", buf);
+		print_unit(d->out, i, 0);
+	} else {
+		fmt_count(buf, sizeof(buf), n);
+		(void)fprintf(d->out, "%s", buf);
 	}
-
-	(void)printf(" & %s", cleaned_opts);
-	free(cleaned_opts);
 }
 
 /*
  * Display percentage
+ * @col: ignored here
  * @perct: percentage
  */
 static void
-tex_disp_perct(double perct)
+tex_disp_perct(struct display *d, const struct column *col, double perct)
 {
-	(void)printf(" & %.f\\%%", perct);
+	(void)col;
+
+	(void)fprintf(d->out, "%.f\\%%", perct);
 }
 
 /*
  * Display line ending
  */
 static void
-tex_disp_ln_end(void)
+tex_disp_ln_end(struct display *d)
 {
-	(void)printf("\n");
+	(void)fputc('\n', d->out);
 }
@@ -49,321 +49,340 @@
 #endif
 
 /* static function declaration */
-static void text_disp_header(void);
-static void text_disp_sum(double stot, double utot,
-		double ftot, double ifitot, double ifatot);
-static void text_disp_bar(double perct);
-static void text_disp_uat(double n, double perct, int req_width);
-static void text_disp_fs(const char *fsname);
-static void text_disp_type(const char *type);
-static void text_disp_inodes(uint64_t files, uint64_t favail);
-static void text_disp_mount(const char *dir);
-static void text_disp_mopt(const char *opts);
-static void text_disp_perct(double perct);
-static void text_disp_ln_end(void);
-
-static void change_color(double perct);
-static void reset_color(void);
+static void text_disp_header(struct display *d);
+static void text_disp_ln_start(struct display *d,
+		const struct row *r);
+static void text_disp_sep(struct display *d, const struct column *prev,
+		const struct column *next);
+static void text_disp_text(struct display *d, const struct column *col,
+		const char *str, size_t len);
+static void text_disp_bar(struct display *d, const struct column *col,
+		double perct);
+static void text_disp_perct(struct display *d, const struct column *col,
+		double perct);
+static void text_disp_size(struct display *d, const struct column *col,
+		bigsize_t n, double perct);
+static void text_disp_count(struct display *d, const struct column *col,
+		int64_t n);
+static void text_disp_ln_end(struct display *d);
+
+static int right_aligned(const struct column *col);
+static size_t print_shortened(struct display *d, const char *str, size_t len,
+		size_t width);
+static void change_color(struct display *d, double perct, int inodes);
+static void reset_color(struct display *d);
 
 /* init pointers from display structure to the functions found here */
 void
 init_disp_text(struct display *disp)
 {
-    disp->init         = NULL; /* not required --> not implemented here */
-    disp->deinit       = NULL; /* not required --> not implemented here */
-    disp->print_header = text_disp_header;
-    disp->print_sum    = text_disp_sum;
-    disp->print_bar    = text_disp_bar;
-    disp->print_used   = text_disp_uat;
-    disp->print_avail  = text_disp_uat;
-    disp->print_total  = text_disp_uat;
-    disp->print_fs     = text_disp_fs;
-    disp->print_type   = text_disp_type;
-    disp->print_inodes = text_disp_inodes;
-    disp->print_mount  = text_disp_mount;
-    disp->print_mopt   = text_disp_mopt;
-    disp->print_perct  = text_disp_perct;
-    disp->print_ln_end = text_disp_ln_end;
+    disp->init           = NULL; /* not required --> not implemented here */
+    disp->deinit         = NULL; /* not required --> not implemented here */
+    disp->print_header   = text_disp_header;
+    disp->print_ln_start = text_disp_ln_start;
+    disp->print_sep      = text_disp_sep;
+    disp->print_text     = text_disp_text;
+    disp->print_bar      = text_disp_bar;
+    disp->print_perct    = text_disp_perct;
+    disp->print_size     = text_disp_size;
+    disp->print_count    = text_disp_count;
+    disp->print_ln_end   = text_disp_ln_end;
+
+    /* every line must be known before the first one is displayed */
+    disp->aligned        = 1;
+}
+
+/*
+ * Tell whether the values of a column are right aligned, in which case their
+ * width includes the space which separates them from the previous column
+ * Return 1 if they are, 0 otherwise.
+ * @col: column
+ */
+static int
+right_aligned(const struct column *col)
+{
+	return col->kind == COLK_PERCT || col->kind == COLK_SIZE ||
+		col->kind == COLK_COUNT;
 }
 
 /*
  * Display header
  */
 static void
-text_disp_header(void)
+text_disp_header(struct display *d)
 {
+	size_t i;
 	int gap;
 
 	/* use color option if triggered */
-	if (cflag)
-		(void)printf("\033[%d;%dm", cnf.font_type , cnf.chead);
-
-	(void)printf("%-*s", max.fsname, _("FILESYSTEM"));
-
-	if (Tflag)
-		(void)printf("%-*s", max.fstype, _("TYPE"));
-
-	if (!bflag) {
-		(void)printf("%s", _("(=) USED"));
-		gap = max.bar -
-		         (int)strlen(_("(=) USED")) - (int)strlen(_("FREE (-)"));
-		(void)printf("%*s", gap, "");
-		(void)printf("%s", _("FREE (-)"));
+	if (d->color)
+		(void)fprintf(d->out, "\033[%d;%dm", cnf.font_type , cnf.chead);
+
+	for (i = 0; i < d->ncolumns; i++) {
+		if (i > 0)
+			text_disp_sep(d, d->columns[i - 1], d->columns[i]);
+		switch (d->columns[i]->kind) {
+		case COLK_BAR:
+			(void)fprintf(d->out, "%s", _("(=) USED"));
+			gap = *d->columns[i]->width -
+				(int)strlen(_("(=) USED")) -
+				(int)strlen(_("FREE (-)"));
+			(void)fprintf(d->out, "%*s", gap, "");
+			(void)fprintf(d->out, "%s", _("FREE (-)"));
+			break;
+		case COLK_PERCT:
+			/* + 1 for the percent sign */
+			(void)fprintf(d->out, "%*s", *d->columns[i]->width + 1,
+				column_title(d->columns[i]));
+			break;
+		case COLK_SIZE: /* FALLTHROUGH */
+		case COLK_COUNT:
+			(void)fprintf(d->out, "%*s", *d->columns[i]->width,
+				column_title(d->columns[i]));
+			break;
+		case COLK_TEXT: /* FALLTHROUGH */
+		default:
+			(void)fprintf(d->out, "%-*s", *d->columns[i]->width,
+				column_title(d->columns[i]));
+			break;
+		}
 	}
 
-	(void)printf("%*s", max.perctused + 1, _("%USED"));
-
-	if (dflag)
-		(void)printf("%*s", max.used, _("USED"));
-
-	(void)printf("%*s", max.avail, _("AVAILABLE"));
-	(void)printf("%*s", max.total, _("TOTAL"));
-
-	if (iflag) {
-		(void)printf("%*s", max.nbinodes, _("#INODES"));
-		(void)printf("%*s", max.avinodes, _("AV.INODES"));
-	}
-
-	/* add a space because previous colum is right aligned */
-	(void)printf(" ");
-
-	if (!Mflag)
-		(void)printf("%-*s", max.mntdir, _("MOUNTED ON"));
-
-	if (oflag)
-		(void)printf("%-*s", max.mntopts, _("MOUNT OPTIONS"));
 	/* reset color before newline to prevent unwanted pollution of the next line */
-	reset_color();
+	reset_color(d);
 
-	(void)printf("\n");
+	(void)fprintf(d->out, "\n");
 }
 
 /*
- * Display the sum (useful when -s option is used
- * @stot: total size of "total"
- * @atot: total size of "available"
- * @utot: total size of "used"
- * @ifitot: total number of inodes
- * @ifatot: total number of available inodes
+ * Start a line: there is nothing to do in text
+ * @r: ignored here
  */
 static void
-text_disp_sum(double stot, double atot, double utot,
-              double ifitot, double ifatot)
+text_disp_ln_start(struct display *d, const struct row *r)
 {
-	double ptot = 0;
-	int width;
-
-	width = Tflag ? max.fsname + max.fstype : max.fsname;
+	(void)d;
+	(void)r;
+}
 
-	if ((int)stot == 0)
-		ptot = 100.0;
-	else
-		ptot = (utot / stot) * 100.0;
+/*
+ * Separate two cells: right aligned values are preceded by spaces and left
+ * aligned ones followed by spaces, so only a right aligned value followed by
+ * a left aligned one (or by the bar) needs one more
+ * @prev: column of the previous cell
+ * @next: column of the next cell
+ */
+static void
+text_disp_sep(struct display *d, const struct column *prev,
+    const struct column *next)
+{
+	if (right_aligned(prev) && !right_aligned(next))
+		(void)fprintf(d->out, " ");
+	else if (prev->kind == COLK_BAR && next->kind == COLK_TEXT)
+		(void)fprintf(d->out, " ");
+}
 
-	/* use color option if triggered */
-	if (cflag)
-		(void)printf("\033[%d;%dm", cnf.font_type , cnf.chead);
-	(void)printf("%-*s", width, _("SUM:"));
-	reset_color();
+/*
+ * Display a string, such as a file system name or a mount point, shortened
+ * if it does not fit in its column (see row_maxwidth)
+ * @col: column
+ * @str: string, NULL if the column does not apply to the line
+ * @len: length of the string
+ */
+static void
+text_disp_text(struct display *d, const struct column *col, const char *str,
+    size_t len)
+{
+	size_t shown;
 
-	if (!bflag)
-		text_disp_bar(ptot);
+	/* the name of the sum is shown like the header */
+	if (d->in_sum && str != NULL && d->color)
+		(void)fprintf(d->out, "\033[%d;%dm", cnf.font_type ,
+			cnf.chead);
 
-	text_disp_perct(ptot);
+	/* - 1 for the space between each column */
+	shown = str == NULL ? 0 :
+		print_shortened(d, str, len, (size_t)*col->width - 1);
+	(void)fprintf(d->out, "%*s", *col->width - (int)shown, "");
 
-	if (uflag) {
-		stot = cvrt(stot);
-		atot = cvrt(atot);
-		if (dflag)
-			utot = cvrt(utot);
-	}
+	if (d->in_sum && str != NULL)
+		reset_color(d);
+}
 
-	if (dflag)
-		text_disp_uat(utot, ptot, max.used);
-	text_disp_uat(atot, ptot, max.avail);
-	text_disp_uat(stot, ptot, max.total);
+/*
+ * Display a string, shortened to a width if it is too long: the beginning is
+ * replaced by a '+' or, with --truncate middle, the middle by "..."
+ * Return the number of characters displayed.
+ * @str: string
+ * @len: length of the string
+ * @width: width to fit in
+ */
+static size_t
+print_shortened(struct display *d, const char *str, size_t len, size_t width)
+{
+	size_t head, tail;
 
-	if (iflag)
-		text_disp_inodes((uint64_t)ifitot, (uint64_t)ifatot);
+	if (len <= width) {
+		(void)fprintf(d->out, "%.*s", (int)len, str);
+		return len;
+	}
+	if (width == 0)
+		return 0;
+
+	if (truncflag == TRUNC_MIDDLE && width > 3) {
+		tail = (width - 3) / 2;
+		head = width - 3 - tail;
+		(void)fprintf(d->out, "%.*s...%.*s", (int)head, str,
+			(int)tail, str + len - tail);
+	} else {
+		(void)fprintf(d->out, "+%.*s", (int)(width - 1),
+			str + len - (width - 1));
+	}
 
-	(void)printf("\n");
+	return width;
 }
 
 /*
  * Display the nice usage bar
+ * @col: column
  * @perct: percentage value
  */
 static void
-text_disp_bar(double perct)
+text_disp_bar(struct display *d, const struct column *col, double perct)
 {
 	int i, j;
 	int barinc = 5;
 
-	/* option to display a wider bar */
-	if (wflag) {
+	/* option to display a wider bar (-w), unless it does not fit */
+	if (*col->width == GRAPHBAR_WIDE) {
 		barinc = 2;
 	}
 
 	/* used (*) */
-	(void)printf("[");
+	(void)fprintf(d->out, "[");
 
-	if (!cflag) {
+	if (!d->color) {
 		for (i = 0; i < perct; i += barinc)
-			(void)printf("%c", cnf.gsymbol);
+			(void)fprintf(d->out, "%c", cnf.gsymbol);
 
 		for (j = i; j < 100; j += barinc)
-			(void)printf("-");
+			(void)fprintf(d->out, "-");
 	} else { /* color */
 
 		/* green */
-		(void)printf("\033[%d;%dm", cnf.font_type , cnf.clow);
-		for (i = 0; (i < cnf.gmedium) && (i < perct); i += barinc)
-			(void)printf("%c", cnf.gsymbol);
+		(void)fprintf(d->out, "\033[%d;%dm", cnf.font_type , cnf.clow);
+		for (i = 0; (i < d->lim->medium) && (i < perct); i += barinc)
+			(void)fprintf(d->out, "%c", cnf.gsymbol);
 
 		/* yellow */
-		(void)printf("\033[%d;%dm", cnf.font_type , cnf.cmedium);
-		for (; (i < cnf.ghigh) && (i < perct); i += barinc)
-			(void)printf("%c", cnf.gsymbol);
+		(void)fprintf(d->out, "\033[%d;%dm", cnf.font_type ,
+			cnf.cmedium);
+		for (; (i < d->lim->high) && (i < perct); i += barinc)
+			(void)fprintf(d->out, "%c", cnf.gsymbol);
 
 		/* red */
-		(void)printf("\033[%d;%dm", cnf.font_type , cnf.chigh);
+		(void)fprintf(d->out, "\033[%d;%dm", cnf.font_type , cnf.chigh);
 		for (; (i < 100) && (i < perct); i += barinc)
-			(void)printf("%c", cnf.gsymbol);
+			(void)fprintf(d->out, "%c", cnf.gsymbol);
 
-		reset_color();
+		reset_color(d);
 
 		for (j = i; j < 100; j += barinc)
-			(void)printf("-");
+			(void)fprintf(d->out, "-");
 	}
 
-	(void)printf("]");
+	(void)fprintf(d->out, "]");
 }
 
 /*
  * Display used, available and total correctly formatted
+ * @col: column
  * @n: number to print
  * @perct: percentage (useful for finding which color to use)
- * @req_width: required width (used for terminal display, otherwise can be 0)
  */
 static void
-text_disp_uat(double n, double perct, int req_width)
+text_disp_size(struct display *d, const struct column *col, bigsize_t n,
+    double perct)
 {
+	char buf[SIZE_BUFLEN];
 	int i;
 
-	i = 0;
-
-	if (unitflag == 'h')
-		i = humanize(&n);
-
-	change_color(perct);
-	(void)printf("%*.1f", req_width - 1, n); /* -1 for the unit symbol */
-	reset_color();
-	print_unit(i, 1);
-}
+	i = size_exp(n);
+	fmt_size(buf, sizeof(buf), n, i, 1);
 
-/*
- * Display file system
- * @fsname: list of the file system to print
- */
-static void
-text_disp_fs(const char *fsname)
-{
-	(void)printf("%-*s", max.fsname, fsname);
-}
-
-/*
- * Display file system type
- * @type: the file system type to print
- */
-static void
-text_disp_type(const char *type)
-{
-	(void)printf("%-*s", max.fstype, type);
+	change_color(d, perct, 0);
+	/* -1 for the unit symbol */
+	(void)fprintf(d->out, "%*s", *col->width - 1, buf);
+	reset_color(d);
+	print_unit(d->out, i, 1);
 }
 
 /*
- * Display inodes
- *@files: number of inodes
- *@favail: number of available inodes
+ * Display a number of inodes
+ * @col: column
+ * @n: number of inodes
  */
 static void
-text_disp_inodes(uint64_t files, uint64_t favail)
+text_disp_count(struct display *d, const struct column *col, int64_t n)
 {
+	char buf[SIZE_BUFLEN];
 	int i;
 
 	if (unitflag == 'h') {
-		i = humanize_i(&files);
-		(void)printf("%*" PRIu64, max.nbinodes - 1, files);
-		print_unit(i, 0);
-		i = humanize_i(&favail);
-		(void)printf("%*" PRIu64, max.avinodes - 1, favail);
-		print_unit(i, 0);
+		i = humanize_i(&n);
+		fmt_count(buf, sizeof(buf), n);
+		(void)fprintf(d->out, "%*s", *col->width - 1, buf);
+		print_unit(d->out, i, 0);
 	} else {
-		(void)printf(" %*" PRIu64, max.nbinodes - 1, files);
-		(void)printf(" %*" PRIu64, max.avinodes - 1, favail);
+		fmt_count(buf, sizeof(buf), n);
+		(void)fprintf(d->out, " %*s", *col->width - 1, buf);
 	}
 }
 
-/*
- * Display mount point
- * @dir: mount point
- */
-static void
-text_disp_mount(const char *dir)
-{
-	/* preceded by a space because previous colum is right aligned */
-	(void)printf(" %-*s", max.mntdir, dir);
-}
-
-/*
- * Display mount options
- * @opts: mount options
- */
-static void
-text_disp_mopt(const char *opts)
-{
-	/* add space when prevous column is right aligned */
-	if (Mflag)
-		(void)printf(" ");
-	(void)printf("%-*s", max.mntopts, opts);
-}
-
 /*
  * Display percentage
+ * @col: column
  * @perct: percentage
  */
 static void
-text_disp_perct(double perct)
+text_disp_perct(struct display *d, const struct column *col, double perct)
 {
-	change_color(perct);
-	(void)printf("%*.1f", max.perctused, perct);
-	reset_color();
-	(void)printf("%%");
+	change_color(d, perct, col->id == COL_IPCENT);
+	(void)fprintf(d->out, "%*.1f", *col->width, perct);
+	reset_color(d);
+	(void)fprintf(d->out, "%%");
 }
 
 /*
  * Display line ending
  */
 static void
-text_disp_ln_end(void)
+text_disp_ln_end(struct display *d)
 {
-	(void)printf("\n");
+	(void)fprintf(d->out, "\n");
 }
 
 /*
- * Change color according to perct
+ * Change color according to perct and the thresholds of the line
  * @perct: percentage
+ * @inodes: whether this is the usage of the inodes
  */
 static void
-change_color(double perct)
+change_color(struct display *d, double perct, int inodes)
 {
-	if (cflag) {
-		if (perct < (double)cnf.gmedium) /* green */
-			(void)printf("\033[%d;%dm", cnf.font_type, cnf.clow);
-		else if (perct < (double)cnf.ghigh) /* yellow */
-			(void)printf("\033[%d;%dm", cnf.font_type, cnf.cmedium);
+	enum level level;
+
+	if (d->color) {
+		level = policy_level(d->lim, perct, inodes);
+		if (level == LEVEL_LOW) /* green */
+			(void)fprintf(d->out, "\033[%d;%dm", cnf.font_type,
+				cnf.clow);
+		else if (level == LEVEL_MEDIUM) /* yellow */
+			(void)fprintf(d->out, "\033[%d;%dm", cnf.font_type,
+				cnf.cmedium);
 		else /* red */
-			(void)printf("\033[%d;%dm", cnf.font_type, cnf.chigh);
+			(void)fprintf(d->out, "\033[%d;%dm", cnf.font_type,
+				cnf.chigh);
 	}
 }
 
@@ -371,8 +390,8 @@ change_color(double perct)
  * Reset color attribute to default
  */
 static void
-reset_color(void)
+reset_color(struct display *d)
 {
-	if (cflag)
-		(void)printf("\033[;m");
+	if (d->color)
+		(void)fprintf(d->out, "\033[;m");
 }
@@ -45,13 +45,36 @@
 #define	VERSION	"(unknown version)"
 #endif /* ndef VERSION */
 
-/* too ugly to use gettext in each string that needs translation... */
+/*
+ * too ugly to use gettext in each string that needs translation...
+ * translations are only set up once a string is translated (see util.c)
+ */
 #ifdef NLS_ENABLED
-#define _(STRING) gettext(STRING)
+#define _(STRING) translate(STRING)
+/* gettext(3) which sets up the translations first (see util.c) */
+char *translate(const char *msgid)
+#ifdef __GNUC__
+    __attribute__((__format_arg__(1)))
+#endif /* __GNUC__ */
+    ;
+#define P_(SINGULAR, PLURAL, N) translate_plural(SINGULAR, PLURAL, N)
+/* ngettext(3) which sets up the translations first (see util.c) */
+char *translate_plural(const char *msgid, const char *plural, unsigned long n)
+#ifdef __GNUC__
+    __attribute__((__format_arg__(1))) __attribute__((__format_arg__(2)))
+#endif /* __GNUC__ */
+    ;
 #else
 #define _(STRING) STRING
+#define P_(SINGULAR, PLURAL, N) ((N) == 1 ? (SINGULAR) : (PLURAL))
 #endif /* def NLS_ENABLED */
 
+/* mark a string to be translated where it is used */
+#define N_(STRING) STRING
+
+/* set up the locale and the translations, once (see util.c) */
+void locale_init(void);
+
 /* font defines */
 #define REGULAR_FONT	0
 #define BOLD_FONT	1
@@ -70,6 +93,10 @@
 #define GRAPHBAR_SHORT 22
 #define GRAPHBAR_WIDE 52
 
+/* how names too long for their column are shortened (--truncate) */
+#define TRUNC_LEFT	0	/* "+" and the end of the name */
+#define TRUNC_MIDDLE	1	/* beginning, "..." and end of the name */
+
 /* hexadecimal color code length (type of #FF0000, etc.) without the # */
 #define HEXCOLOR_LEN 6
 
@@ -85,6 +112,9 @@ struct conf {
 	int gmedium;	/* starting value from which usage is considered medium */
 	int ghigh;	/* starting value from which usage is considered high */
 
+	int ehyst;	/* points below a threshold to leave its level */
+	int edebounce;	/* samples a new level must hold to be reported */
+
 	char hcheadbg[HEXCOLOR_LEN + 1];	/* background color for header and footer (html) */
 	char hcheadfg[HEXCOLOR_LEN + 1];	/* font color used in header and footer (html) */
 	char hccellbg[HEXCOLOR_LEN + 1];	/* background color for cells (html) */
@@ -107,10 +137,15 @@ struct maxwidths {
 	int used;
 	int avail;
 	int total;
+	int held;
 	int nbinodes;
 	int avinodes;
+	int usinodes;
+	int perctinodes;
 	int mntdir;
+	int namespaces;
 	int mntopts;
+	int status;
 };
 
 /*
@@ -131,6 +166,27 @@ extern int aflag, bflag, cflag, dflag, eflag, fflag, hflag, iflag, lflag, mflag,
     nflag, oflag, pflag, qflag, sflag, tflag, uflag, vflag, wflag;
 extern int Mflag, Tflag, Wflag;
 
+/* how names are shortened in text export, unless Wflag is set */
+extern int truncflag;
+
+/* set when only machine readable formats are exported (-e json,bin) */
+extern int rawflag;
+
+/* set when showing the differences between two snapshots (--diff) */
+extern int diffflag;
+
+/* set to state autofs trigger points, which mounts them (--automount) */
+extern int automountflag;
+
+/* set when sampling repeatedly (--watch) */
+extern int watchflag;
+
+/* set to show the space held by deleted files still open (--held) */
+extern int heldflag;
+
+/* set when looking at the mount namespaces of all the processes */
+extern int allnsflag;
+
 /* flag that determines which unit is in use (Ko, Mo, etc.) */
 extern char unitflag;
 
@@ -0,0 +1,368 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * fsclass.c
+ *
+ * Classification of file system types. Each type is classified once, the
+ * first time it is seen, and kept in a hash table: later lookups only cost a
+ * hash of the name. The flags come, by order of precedence, from the
+ * configuration file or from a table of well known types. Other types are
+ * taken as local, which is what hides or skips nothing, unless the magic
+ * number of the super block of a file system of that type tells otherwise
+ * once it has been stated (see fsclass_magic).
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fsclass.h"
+#include "util.h"
+
+/* a well known type */
+struct fsclass_known {
+	const char *name;
+	int flags;
+};
+
+/* hash table of the interned types (open addressing) */
+struct fsclass_table {
+	struct fsclass *slots;
+	size_t nslots;		/* always a power of 2 */
+	size_t n;
+};
+
+/* static function declaration */
+static int knowncmp(const void *a, const void *b);
+static struct fsclass *lookup(const char *type);
+static void classify(struct fsclass *cls);
+
+/*
+ * Well known types, keep sorted for binary search
+ * Types of FUSE file systems are "fuse." followed by the name of the program.
+ */
+static const struct fsclass_known known[] = {
+	{ "9p",				FSCLASS_REMOTE },
+	{ "afs",			FSCLASS_REMOTE },
+	{ "anon_inodefs",		FSCLASS_PSEUDO },
+	{ "autofs",			FSCLASS_PSEUDO },
+	{ "bdev",			FSCLASS_PSEUDO },
+	{ "beegfs",			FSCLASS_REMOTE },
+	{ "binfmt_misc",		FSCLASS_PSEUDO },
+	{ "bpf",			FSCLASS_PSEUDO },
+	{ "ceph",			FSCLASS_REMOTE },
+	{ "cgroup",			FSCLASS_PSEUDO },
+	{ "cgroup2",			FSCLASS_PSEUDO },
+	{ "cifs",			FSCLASS_REMOTE },
+	{ "coda",			FSCLASS_REMOTE },
+	{ "configfs",			FSCLASS_PSEUDO },
+	{ "cpuset",			FSCLASS_PSEUDO },
+	{ "debugfs",			FSCLASS_PSEUDO },
+	{ "devfs",			FSCLASS_PSEUDO },
+	{ "devpts",			FSCLASS_PSEUDO },
+	{ "devtmpfs",			FSCLASS_PSEUDO },
+	{ "dlmfs",			FSCLASS_PSEUDO },
+	{ "efivarfs",			FSCLASS_PSEUDO },
+	{ "fdescfs",			FSCLASS_PSEUDO },
+	{ "ftpfs",			FSCLASS_REMOTE },
+	{ "fuse.ceph",			FSCLASS_REMOTE },
+	{ "fuse.gcsfuse",		FSCLASS_REMOTE },
+	{ "fuse.glusterfs",		FSCLASS_REMOTE },
+	{ "fuse.gvfs-fuse-daemon",	FSCLASS_PSEUDO },
+	{ "fuse.gvfsd-fuse",		FSCLASS_PSEUDO },
+	{ "fuse.lxcfs",			FSCLASS_PSEUDO },
+	{ "fuse.portal",		FSCLASS_PSEUDO },
+	{ "fuse.rclone",		FSCLASS_REMOTE },
+	{ "fuse.s3fs",			FSCLASS_REMOTE },
+	{ "fuse.sshfs",			FSCLASS_REMOTE },
+	{ "fusectl",			FSCLASS_PSEUDO },
+	{ "glusterfs",			FSCLASS_REMOTE },
+	{ "gpfs",			FSCLASS_REMOTE },
+	{ "hugetlbfs",			FSCLASS_PSEUDO },
+	{ "linprocfs",			FSCLASS_PSEUDO },
+	{ "lustre",			FSCLASS_REMOTE },
+	{ "mfs",			FSCLASS_REMOTE },
+	{ "mqueue",			FSCLASS_PSEUDO },
+	{ "ncpfs",			FSCLASS_REMOTE },
+	{ "nfs",			FSCLASS_REMOTE },
+	{ "nfs4",			FSCLASS_REMOTE },
+	{ "nfsd",			FSCLASS_PSEUDO },
+	{ "none",			FSCLASS_PSEUDO },
+	{ "nsfs",			FSCLASS_PSEUDO },
+	{ "pipefs",			FSCLASS_PSEUDO },
+	{ "proc",			FSCLASS_PSEUDO },
+	{ "pstore",			FSCLASS_PSEUDO },
+	{ "ramfs",			FSCLASS_PSEUDO },
+	{ "rootfs",			FSCLASS_PSEUDO },
+	{ "rpc_pipefs",			FSCLASS_PSEUDO },
+	{ "securityfs",			FSCLASS_PSEUDO },
+	{ "selinuxfs",			FSCLASS_PSEUDO },
+	{ "smb3",			FSCLASS_REMOTE },
+	{ "smbfs",			FSCLASS_REMOTE },
+	{ "sockfs",			FSCLASS_PSEUDO },
+	{ "spufs",			FSCLASS_PSEUDO },
+	{ "sshfs",			FSCLASS_REMOTE },
+	{ "sysfs",			FSCLASS_PSEUDO },
+	{ "tmpfs",			FSCLASS_PSEUDO },
+	{ "tracefs",			FSCLASS_PSEUDO }
+};
+
+/* magic numbers of the super block of file systems on Linux, see statfs(2) */
+static const struct {
+	unsigned long magic;
+	int flags;
+} magics[] = {
+	{ 0x00006969UL, FSCLASS_REMOTE },	/* nfs */
+	{ 0x0000517bUL, FSCLASS_REMOTE },	/* smb */
+	{ 0xff534d42UL, FSCLASS_REMOTE },	/* cifs */
+	{ 0xfe534d42UL, FSCLASS_REMOTE },	/* smb2 */
+	{ 0x00c36400UL, FSCLASS_REMOTE },	/* ceph */
+	{ 0x01021997UL, FSCLASS_REMOTE },	/* 9p */
+	{ 0x5346414fUL, FSCLASS_REMOTE },	/* afs */
+	{ 0x73757245UL, FSCLASS_REMOTE },	/* coda */
+	{ 0x47504653UL, FSCLASS_REMOTE },	/* gpfs */
+	{ 0x0bd00bd0UL, FSCLASS_REMOTE },	/* lustre */
+	{ 0x19830326UL, FSCLASS_REMOTE },	/* beegfs */
+	{ 0x00009fa0UL, FSCLASS_PSEUDO },	/* proc */
+	{ 0x62656572UL, FSCLASS_PSEUDO },	/* sysfs */
+	{ 0x0027e0ebUL, FSCLASS_PSEUDO },	/* cgroup */
+	{ 0x63677270UL, FSCLASS_PSEUDO },	/* cgroup2 */
+	{ 0x00001cd1UL, FSCLASS_PSEUDO },	/* devpts */
+	{ 0x64626720UL, FSCLASS_PSEUDO },	/* debugfs */
+	{ 0x74726163UL, FSCLASS_PSEUDO },	/* tracefs */
+	{ 0x73636673UL, FSCLASS_PSEUDO },	/* securityfs */
+	{ 0xcafe4a11UL, FSCLASS_PSEUDO },	/* bpf */
+	{ 0x6e736673UL, FSCLASS_PSEUDO },	/* nsfs */
+	{ 0x858458f6UL, FSCLASS_PSEUDO },	/* ramfs */
+	{ 0x01021994UL, FSCLASS_PSEUDO },	/* tmpfs */
+	{ 0x62656570UL, FSCLASS_PSEUDO },	/* configfs */
+	{ 0x958458f6UL, FSCLASS_PSEUDO },	/* hugetlbfs */
+	{ 0x794c7630UL, 0 },			/* overlay */
+	{ 0x73717368UL, 0 },			/* squashfs */
+	{ 0x2fc12fc1UL, 0 },			/* zfs */
+	{ 0x65735546UL, 0 },			/* fuse, virtiofs */
+	{ 0x0000f15fUL, 0 }			/* ecryptfs */
+};
+
+/* types set in the configuration file, looked up before the known ones */
+static struct fsclass_known *config;
+static size_t nconfig;
+
+static struct fsclass_table table;
+
+/* lookups may come from several threads (see --all-namespaces) */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int
+knowncmp(const void *a, const void *b)
+{
+	const char *name = a;
+	const struct fsclass_known *k = b;
+
+	return strcmp(name, k->name);
+}
+
+/*
+ * Find the slot of a type in the hash table, growing it if needed
+ * Return the slot, which name is NULL if the type is not interned yet.
+ * @type: file system type
+ */
+static struct fsclass *
+lookup(const char *type)
+{
+	struct fsclass *old, *slot;
+	size_t nold, i, j;
+
+	/* keep the load under 1/2 */
+	if (2 * (table.n + 1) > table.nslots) {
+		old = table.slots;
+		nold = table.nslots;
+		table.nslots = nold ? nold * 2 : 64;
+		if ((table.slots = calloc(table.nslots,
+		    sizeof(*table.slots))) == NULL) {
+			(void)fputs("Error while allocating memory to "
+				"classify file systems", stderr);
+			exit(EXIT_FAILURE);
+			/* NOTREACHED */
+		}
+		for (i = 0; i < nold; i++) {
+			if (old[i].name == NULL)
+				continue;
+			j = strhash(old[i].name) & (table.nslots - 1);
+			while (table.slots[j].name != NULL)
+				j = (j + 1) & (table.nslots - 1);
+			table.slots[j] = old[i];
+		}
+		free(old);
+	}
+
+	i = strhash(type) & (table.nslots - 1);
+	for (;;) {
+		slot = &table.slots[i];
+		if (slot->name == NULL || strcmp(slot->name, type) == 0)
+			return slot;
+		i = (i + 1) & (table.nslots - 1);
+	}
+}
+
+/*
+ * Set the flags of a newly interned type
+ * @cls: type to classify
+ */
+static void
+classify(struct fsclass *cls)
+{
+	const struct fsclass_known *k;
+	size_t i;
+
+	for (i = 0; i < nconfig; i++) {
+		if (strcmp(config[i].name, cls->name) == 0) {
+			cls->flags = config[i].flags;
+			cls->source = FSCLASS_CONFIG;
+			return;
+		}
+	}
+
+	k = bsearch(cls->name, known, sizeof(known) / sizeof(known[0]),
+		sizeof(known[0]), knowncmp);
+	if (k != NULL) {
+		cls->flags = k->flags;
+		cls->source = FSCLASS_BUILTIN;
+		return;
+	}
+
+	/*
+	 * Not needing a block device does not make a type pseudo (zfs,
+	 * overlay, fuse...): only the magic number of the super block tells,
+	 * once stated.
+	 */
+	cls->flags = 0;
+	cls->source = FSCLASS_GUESS;
+}
+
+/*
+ * Return a copy of the interned classification of a file system type: the
+ * table may be grown, and its slots freed, by any other lookup
+ * @type: file system type
+ */
+struct fsclass
+fsclass_get(const char *type)
+{
+	struct fsclass *cls, ret;
+
+	if (type == NULL)
+		type = "";
+
+	(void)pthread_mutex_lock(&lock);
+	cls = lookup(type);
+	if (cls->name == NULL) {
+		if ((cls->name = strdup(type)) == NULL) {
+			(void)fputs("Error while allocating memory to "
+				"classify file systems", stderr);
+			exit(EXIT_FAILURE);
+			/* NOTREACHED */
+		}
+		classify(cls);
+		table.n++;
+	}
+	ret = *cls;
+	(void)pthread_mutex_unlock(&lock);
+
+	return ret;
+}
+
+/*
+ * Classify a type which was only guessed from the magic number of the super
+ * block of a file system of that type, if it is a known one
+ * @type: file system type
+ * @magic: magic number, as told by statfs(2)
+ */
+void
+fsclass_magic(const char *type, unsigned long magic)
+{
+	struct fsclass *cls;
+	size_t i;
+
+	magic &= 0xffffffffUL;
+	for (i = 0; i < sizeof(magics) / sizeof(magics[0]); i++)
+		if (magics[i].magic == magic)
+			break;
+	if (i == sizeof(magics) / sizeof(magics[0]))
+		return;
+
+	(void)pthread_mutex_lock(&lock);
+	cls = lookup(type);
+	if (cls->name != NULL && cls->source == FSCLASS_GUESS) {
+		cls->flags = magics[i].flags;
+		cls->source = FSCLASS_MAGIC;
+	}
+	(void)pthread_mutex_unlock(&lock);
+}
+
+/*
+ * Set the flags of types from the configuration file, overriding any other
+ * classification. It must be called before any type is looked up.
+ * Return -1 on error, 0 otherwise.
+ * @types: comma separated list of types
+ * @flags: flags of the types
+ */
+int
+fsclass_config(const char *types, int flags)
+{
+	struct fsclass_known *tmp;
+	char *list, *name, *save = NULL;
+
+	if ((list = strdup(types)) == NULL)
+		return -1;
+
+	for (name = strtok_r(list, ",", &save); name != NULL;
+	    name = strtok_r(NULL, ",", &save)) {
+		name = strtrim(name);
+		if (name == NULL || *name == '\0')
+			continue;
+		tmp = realloc(config, (nconfig + 1) * sizeof(*config));
+		if (tmp == NULL)
+			goto err;
+		config = tmp;
+		if ((config[nconfig].name = strdup(name)) == NULL)
+			goto err;
+		config[nconfig].flags = flags;
+		nconfig++;
+	}
+
+	free(list);
+	return 0;
+
+err:
+	free(list);
+	return -1;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef H_FSCLASS
+#define H_FSCLASS
+/*
+ * fsclass.h
+ *
+ * Classification of file system types (pseudo, remote or local)
+ */
+
+/* flags of a file system type */
+#define FSCLASS_PSEUDO	0x1	/* not backed by storage (proc, sysfs...) */
+#define FSCLASS_REMOTE	0x2	/* accessed through the network */
+
+/* where the flags of a file system type come from, by decreasing trust */
+enum fsclass_source {
+	FSCLASS_CONFIG = 0,	/* pseudo_fs, remote_fs or local_fs in dfcrc */
+	FSCLASS_BUILTIN,	/* well known type */
+	FSCLASS_MAGIC,		/* magic number of the super block */
+	FSCLASS_GUESS		/* unknown type, taken as local */
+};
+
+/* an interned file system type */
+struct fsclass {
+	char *name;
+	int flags;
+	enum fsclass_source source;
+};
+
+/* function declaration */
+struct fsclass fsclass_get(const char *type);
+void fsclass_magic(const char *type, unsigned long magic);
+int fsclass_config(const char *types, int flags);
+
+#endif /* ndef H_FSCLASS */
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * groupby.c
+ *
+ * Replace the file systems to display by one row per group of them, holding
+ * their subtotals, in a single pass over the list (see rollup.c). Group rows
+ * are regular fsmntinfo, so that they can be sorted and shown through any
+ * export, like the file systems they stand in for.
+ */
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dfc.h"
+#include "groupby.h"
+#include "rollup.h"
+
+/* static function declaration */
+static int has_option(const char *mntopts, const char *option);
+static const char *group_key(const struct fsmntinfo *p,
+    const struct groupby *g, char *buf, size_t len);
+
+/*
+ * Parse the argument of --group-by: "type", "device", "mountprefix:N" or
+ * "option:NAME".
+ * Return -1 if it is not valid, 0 otherwise.
+ * @spec: argument to parse
+ * @g: set to what to group by
+ */
+int
+groupby_parse(const char *spec, struct groupby *g)
+{
+	char *end;
+	long depth;
+
+	(void)memset(g, 0, sizeof(*g));
+
+	if (strcmp(spec, "type") == 0) {
+		g->key = GROUPBY_TYPE;
+	} else if (strcmp(spec, "device") == 0) {
+		g->key = GROUPBY_DEVICE;
+	} else if (strncmp(spec, "mountprefix:", 12) == 0) {
+		errno = 0;
+		depth = strtol(spec + 12, &end, 10);
+		if (errno != 0 || end == spec + 12 || *end != '\0' ||
+		    depth < 0 || depth > INT_MAX)
+			return -1;
+		g->key = GROUPBY_MOUNT;
+		g->depth = (int)depth;
+	} else if (strncmp(spec, "option:", 7) == 0 && spec[7] != '\0') {
+		g->key = GROUPBY_OPTION;
+		g->option = spec + 7;
+	} else {
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Tell whether a mount option is set, with or without a value
+ * Return 1 if it is, 0 otherwise.
+ * @mntopts: comma separated mount options
+ * @option: option to look for
+ */
+static int
+has_option(const char *mntopts, const char *option)
+{
+	size_t len = strlen(option);
+	const char *s = mntopts;
+
+	while (s != NULL && *s != '\0') {
+		if (strncmp(s, option, len) == 0 &&
+		    (s[len] == '\0' || s[len] == ',' || s[len] == '='))
+			return 1;
+		if ((s = strchr(s, ',')) != NULL)
+			s++;
+	}
+
+	return 0;
+}
+
+/*
+ * Return the name of the group of a file system
+ * @p: file system
+ * @g: what to group by
+ * @buf: buffer to use if needed
+ * @len: size of buf
+ */
+static const char *
+group_key(const struct fsmntinfo *p, const struct groupby *g, char *buf,
+    size_t len)
+{
+	const char *s;
+	size_t n;
+	int depth;
+
+	switch (g->key) {
+	case GROUPBY_DEVICE:
+		return p->fsname;
+	case GROUPBY_MOUNT:
+		/* keep the first components: /var/lib/docker -> /var/lib */
+		s = p->mntdir;
+		for (depth = 0; depth < g->depth; depth++) {
+			while (*s == '/')
+				s++;
+			if (*s == '\0')
+				break;
+			s += strcspn(s, "/");
+		}
+		n = (size_t)(s - p->mntdir);
+		if (n == 0)
+			return "/";
+		(void)snprintf(buf, len, "%.*s", (int)n, p->mntdir);
+		return buf;
+	case GROUPBY_OPTION:
+		if (has_option(p->mntopts, g->option))
+			return g->option;
+		(void)snprintf(buf, len, "not %s", g->option);
+		return buf;
+	case GROUPBY_TYPE: /* FALLTHROUGH */
+	default:
+		return p->fstype;
+	}
+}
+
+/*
+ * Replace the file systems of a list which are not ignored by one row per
+ * group, sorted by name. The list must have been filtered (see filter_list).
+ * @lst: list of file systems
+ * @g: what to group by
+ */
+void
+group_list(struct list *lst, const struct groupby *g)
+{
+	static const char *dimensions[] = {
+		"type",
+		"device",
+		"mount",
+		"option"
+	};
+	struct rollup r;
+	struct rollup_entry val, **groups;
+	struct fsmntinfo *p, fmi;
+	char buf[PATH_MAX];
+	char count[32];
+	size_t i;
+
+	rollup_init(&r);
+	(void)memset(&val, 0, sizeof(val));
+	val.count = 1;
+
+	for (p = lst->head; p != NULL; p = delete_struct_and_get_next(p)) {
+		if (p->ignored)
+			continue;
+		val.total  = (bigsize_t)p->total;
+		val.avail  = (bigsize_t)p->avail;
+		val.used   = (bigsize_t)p->used;
+		val.files  = (int64_t)p->files;
+#if defined(__linux__) || defined(__GLIBC__)
+		val.favail = (int64_t)p->favail;
+#else
+		val.favail = (int64_t)p->ffree;
+#endif /* __linux__ */
+		if (rollup_add(&r, group_key(p, g, buf, sizeof(buf)),
+		    &val) == -1)
+			goto nomem;
+	}
+	init_queue(lst);
+
+	if ((groups = rollup_sorted(&r)) == NULL)
+		goto nomem;
+
+	/* widths are the ones of the groups now */
+	init_maxwidths();
+	for (i = 0; i < r.n; i++) {
+		fmi = fmi_init();
+		(void)snprintf(count, sizeof(count), "%lu fs",
+			groups[i]->count);
+		fmi.fsname = strdup(groups[i]->key);
+		fmi.fstype = strdup(dimensions[g->key]);
+		fmi.mntdir = strdup(count);
+		if (!fmi.fsname || !fmi.fstype || !fmi.mntdir)
+			goto nomem;
+		fmi.perctused = rollup_perct(groups[i]);
+		fmi.total     = (uint64_t)groups[i]->total;
+		fmi.avail     = (uint64_t)groups[i]->avail;
+		fmi.used      = (uint64_t)groups[i]->used;
+		fmi.files     = (fsfilcnt_t)groups[i]->files;
+		fmi.ffree     = (fsfilcnt_t)groups[i]->favail;
+		fmi.favail    = (fsfilcnt_t)groups[i]->favail;
+		fmi.ignored   = 0;
+		if (enqueue(lst, fmi) == -1)
+			goto nomem;
+		update_row_maxwidth(&fmi);
+	}
+
+	free(groups);
+	rollup_free(&r);
+	return;
+
+nomem:
+	(void)fputs("Error while allocating memory to group file systems\n",
+		stderr);
+	exit(EXIT_FAILURE);
+	/* NOTREACHED */
+}
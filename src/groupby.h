@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef H_GROUPBY
+#define H_GROUPBY
+/*
+ * groupby.h
+ *
+ * Replace file systems by subtotals of groups of them (--group-by)
+ */
+
+#include "list.h"
+
+/* what file systems are grouped by */
+enum groupby_key {
+	GROUPBY_TYPE = 0,	/* file system type */
+	GROUPBY_DEVICE,		/* file system name */
+	GROUPBY_MOUNT,		/* first components of the mount point */
+	GROUPBY_OPTION		/* whether a mount option is set */
+};
+
+struct groupby {
+	enum groupby_key key;
+	int depth;		/* number of components, GROUPBY_MOUNT */
+	const char *option;	/* mount option, GROUPBY_OPTION */
+};
+
+/* function declaration */
+int groupby_parse(const char *spec, struct groupby *g);
+void group_list(struct list *lst, const struct groupby *g);
+
+#endif /* ndef H_GROUPBY */
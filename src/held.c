@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * held.c
+ *
+ * Space held by deleted files which are still open (--held). The deleted
+ * files are found once per sample, for all the file systems (see fetch_held),
+ * and sorted by device: the space held on a file system is the sum of the
+ * files of its device, which was told when it was stated. The files
+ * are kept to be listed, with the processes holding them, after the table.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "extern.h"
+#include "held.h"
+#include "util.h"
+
+/* number of processes listed for a file before only counting them */
+#define HELD_MAXOWNERS 3
+
+/* a file system shown which holds deleted files */
+struct held_fs {
+	char *fsname;
+	char *mntdir;
+	uint64_t held;
+	size_t first;		/* its first file */
+	size_t nfiles;
+};
+
+/* deleted files of the last sample, sorted by device */
+static struct held_file *files;
+static size_t nfiles;
+
+/* file systems holding some of them, in the order they are shown */
+static struct held_fs *fss;
+static size_t nfss;
+
+/* static function declaration */
+static void nomem(void);
+static size_t first_file(uint64_t dev);
+static void print_size(FILE *out, uint64_t n);
+
+static void
+nomem(void)
+{
+	(void)fputs("Error while allocating memory to find deleted files\n",
+		stderr);
+	exit(EXIT_FAILURE);
+	/* NOTREACHED */
+}
+
+/*
+ * Return the first deleted file of a device, nfiles if there is none
+ * @dev: device
+ */
+static size_t
+first_file(uint64_t dev)
+{
+	size_t lo = 0, hi = nfiles, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (files[mid].dev < dev)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo < nfiles && files[lo].dev == dev ? lo : nfiles;
+}
+
+/*
+ * Find the deleted files still open and set the space they hold on each file
+ * system of the queue which is not ignored (see filter_list). A file system
+ * mounted several times is only listed once, under its first mount point.
+ * Return -1 if they cannot be found, 0 otherwise.
+ * @lst: queue containing all required information
+ */
+int
+held_update(struct list *lst)
+{
+	struct fsmntinfo *p;
+	struct held_fs *tmp;
+	ssize_t n;
+	size_t i, j, k;
+
+	held_free();
+	if ((n = fetch_held(&files)) == -1)
+		return -1;
+	nfiles = (size_t)n;
+
+	for (p = lst->head; p != NULL; p = p->next) {
+		p->held = 0;
+		if (p->ignored || p->dev == 0 || nfiles == 0)
+			continue;
+		if ((i = first_file(p->dev)) == nfiles)
+			continue;
+		for (j = i; j < nfiles && files[j].dev == files[i].dev; j++)
+			p->held += files[j].size;
+
+		for (k = 0; k < nfss && fss[k].first != i; k++)
+			;
+		if (k < nfss)
+			continue;
+		if ((tmp = realloc(fss, (nfss + 1) * sizeof(*tmp))) == NULL)
+			nomem();
+		fss = tmp;
+		fss[nfss].fsname = strdup(p->fsname);
+		fss[nfss].mntdir = strdup(p->mntdir);
+		if (fss[nfss].fsname == NULL || fss[nfss].mntdir == NULL)
+			nomem();
+		fss[nfss].held = p->held;
+		fss[nfss].first = i;
+		fss[nfss].nfiles = j - i;
+		nfss++;
+	}
+
+	return 0;
+}
+
+/*
+ * Print a size in the unit asked for
+ * @out: stream to print to
+ * @n: size in bytes
+ */
+static void
+print_size(FILE *out, uint64_t n)
+{
+	char buf[SIZE_BUFLEN];
+	int i;
+
+	i = size_exp((bigsize_t)n);
+	fmt_size(buf, sizeof(buf), (bigsize_t)n, i, 1);
+	(void)fputs(buf, out);
+	print_unit(out, i, 1);
+}
+
+/*
+ * List the deleted files still open of the file systems shown, the largest
+ * first, with the processes holding them
+ * @out: stream to print to
+ */
+void
+held_report(FILE *out)
+{
+	const struct held_file *f;
+	size_t i, j, k;
+
+	for (i = 0; i < nfss; i++) {
+		(void)fprintf(out, "\n%s (%s): ", fss[i].mntdir,
+			fss[i].fsname);
+		print_size(out, fss[i].held);
+		(void)fprintf(out, P_(" held by %lu deleted file\n",
+			" held by %lu deleted files\n", fss[i].nfiles),
+			(unsigned long)fss[i].nfiles);
+		for (j = 0; j < fss[i].nfiles; j++) {
+			f = &files[fss[i].first + j];
+			(void)fputc('\t', out);
+			print_size(out, f->size);
+			(void)fprintf(out, "\t%s\t", f->path);
+			for (k = 0; k < f->nowners && k < HELD_MAXOWNERS; k++)
+				(void)fprintf(out, "%s%ld (%s)", k ? ", " : "",
+					(long)f->owners[k].pid,
+					f->owners[k].comm);
+			if (f->nowners > HELD_MAXOWNERS)
+				(void)fprintf(out, _(" and %lu more"),
+					(unsigned long)(f->nowners -
+					HELD_MAXOWNERS));
+			(void)fputc('\n', out);
+		}
+	}
+}
+
+/*
+ * Free deleted files found by fetch_held
+ * @list: files
+ * @n: number of files
+ */
+void
+held_files_free(struct held_file *list, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		free(list[i].path);
+		free(list[i].owners);
+	}
+	free(list);
+}
+
+/*
+ * Forget the deleted files of the last sample
+ */
+void
+held_free(void)
+{
+	size_t i;
+
+	held_files_free(files, nfiles);
+	files = NULL;
+	nfiles = 0;
+
+	for (i = 0; i < nfss; i++) {
+		free(fss[i].fsname);
+		free(fss[i].mntdir);
+	}
+	free(fss);
+	fss = NULL;
+	nfss = 0;
+}
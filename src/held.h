@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef H_HELD
+#define H_HELD
+/*
+ * held.h
+ *
+ * Space held by deleted files which are still open (--held)
+ */
+
+#include <sys/types.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "list.h"
+
+/* room for the name of a command, as in /proc/PID/comm */
+#define HELD_COMMLEN 16
+
+/* a process holding a deleted file open */
+struct held_owner {
+	pid_t pid;
+	char comm[HELD_COMMLEN];	/* name of its command */
+};
+
+/* a deleted regular file which processes still hold open */
+struct held_file {
+	uint64_t dev;		/* device of its file system */
+	uint64_t ino;
+	uint64_t size;		/* bytes allocated to it */
+	char *path;		/* name it had before being deleted */
+	struct held_owner *owners;
+	size_t nowners;
+};
+
+/* function declaration */
+int held_update(struct list *lst);
+void held_report(FILE *out);
+void held_free(void);
+void held_files_free(struct held_file *list, size_t n);
+
+#endif /* ndef H_HELD */
@@ -39,6 +39,7 @@
 
 #include "list.h"
 #include "extern.h"
+#include "util.h"
 
 /*
  * Initializes a queue structure
@@ -49,6 +50,8 @@ init_queue(struct list *lst)
 {
 	lst->head  = NULL;
 	lst->tail   = NULL;
+	lst->stream = NULL;
+	lst->arg    = NULL;
 }
 
 /*
@@ -68,7 +71,8 @@ is_empty(struct list lst)
 }
 
 /*
- * Enqueues an element into a queue
+ * Enqueues an element into a queue, updating the widths of the columns, or
+ * hands it to the stream of the queue if it has one
  * @lst: queue pointer
  * @elt: element
  * Returns:
@@ -88,6 +92,11 @@ enqueue(struct list *lst, struct fsmntinfo fmi)
 	/* initialize the new element to be inserted in the queue */
 	*new_fmi = fmi;
 
+	if (lst->stream != NULL)
+		return lst->stream(lst->arg, new_fmi);
+
+	update_maxwidth(new_fmi);
+
 	if (is_empty((*lst)))
 		lst->head = new_fmi;
 	else
@@ -109,17 +118,18 @@ fmi_init(void)
 	struct fsmntinfo fmi;
 
 	fmi.fsname  = g_unknown_str;
-	fmi.fsnameog  = g_unknown_str;
 	fmi.fstype  = g_unknown_str;
-	fmi.fstypeog  = g_unknown_str;
 	fmi.mntdir  = g_unknown_str;
-	fmi.mntdirog  = g_unknown_str;
 	fmi.mntopts = g_none_str;
+	fmi.strtab  = NULL;
+	fmi.namespaces = NULL;
 
 	fmi.perctused = 0.0;
-	fmi.total     = 0.0;
-	fmi.avail     = 0.0;
-	fmi.used      = 0.0;
+	fmi.total     = 0;
+	fmi.avail     = 0;
+	fmi.used      = 0;
+	fmi.held      = 0;
+	fmi.dev       = 0;
 
 	fmi.flags  = 0;
 	fmi.bsize  = 0;
@@ -145,16 +155,65 @@ struct fsmntinfo
 
 	next = p->next;
 
-	if(p->fsname != g_unknown_str) /* we malloc'd a string */
-		free(p->fsname);
-	if(p->fstype != g_unknown_str)
-		free(p->fstype);
-	if(p->mntdir != g_unknown_str)
-		free(p->mntdir);
-	if(p->mntopts != g_none_str)
-		free(p->mntopts);
+	if (p->strtab != NULL) { /* the strings are not ours */
+		strtab_unref(p->strtab);
+	} else {
+		if(p->fsname != g_unknown_str) /* we malloc'd a string */
+			free(p->fsname);
+		if(p->fstype != g_unknown_str)
+			free(p->fstype);
+		if(p->mntdir != g_unknown_str)
+			free(p->mntdir);
+		if(p->mntopts != g_none_str)
+			free(p->mntopts);
+	}
+	free(p->namespaces);
 
 	free(p);
 
 	return next;
 }
+
+/*
+ * Allocate a string buffer, which only user is the caller
+ * Returns:
+ *	--> the buffer, which is not initialized
+ *	--> NULL on error
+ * @len: length of the buffer
+ */
+struct strtab *
+strtab_new(size_t len)
+{
+	struct strtab *tab;
+
+	if ((tab = malloc(sizeof(*tab) + len)) == NULL)
+		return NULL;
+	tab->refs = 1;
+	tab->len = len;
+
+	return tab;
+}
+
+/*
+ * Add a user to a string buffer
+ * Returns the buffer.
+ * @tab: string buffer
+ */
+struct strtab *
+strtab_ref(struct strtab *tab)
+{
+	tab->refs++;
+
+	return tab;
+}
+
+/*
+ * Remove a user from a string buffer, freeing it if it was the last one
+ * @tab: string buffer, may be NULL
+ */
+void
+strtab_unref(struct strtab *tab)
+{
+	if (tab != NULL && --tab->refs == 0)
+		free(tab);
+}
@@ -38,24 +38,55 @@
  */
 
 #include <sys/types.h>
+#include <inttypes.h>
+
+/*
+ * Integer type used for sizes in bytes once they are summed up.
+ * It is wide enough so that adding up the sizes of many file systems can
+ * neither overflow nor lose precision, and signed so that it can also hold
+ * the difference between two sizes (see --diff).
+ */
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef __int128 bigsize_t;
+#define BIGSIZE_MAX ((((bigsize_t)1 << 126) - 1) * 2 + 1)
+#else
+typedef int64_t bigsize_t;
+#define BIGSIZE_MAX INT64_MAX
+#endif /* __SIZEOF_INT128__ */
+
+/*
+ * Buffer holding the strings of several file systems, such as a whole mount
+ * table: they point into it instead of holding copies of their names. It is
+ * freed along with the last of them.
+ */
+struct strtab {
+	size_t refs;	/* number of users of the buffer */
+	size_t len;	/* length of the buffer */
+	char buf[];
+};
 
 /*
  * Structure to store information about mounted fs
+ * Names are never shortened: long ones are only shortened when displayed
+ * (see column.c).
  */
 struct fsmntinfo {
 	/* infos to get from getmntent(3) */
 	char *fsname;	/* name of mounted file system */
-	char *fsnameog; /* original name of file system */
 	char *fstype;	/* mount type */
-	char *fstypeog;	/* original mount type */
 	char *mntdir;	/* file system path prefix */
-	char *mntdirog;	/* original file system path prefix */
 	char *mntopts;	/* mount options (see mntent.h) */
+	/* buffer the strings point into, NULL if each one was allocated */
+	struct strtab *strtab;
+	/* lowest process of each namespace it is mounted in, NULL if none */
+	char *namespaces;
 
 	double perctused;   /* fs usage in % */
-	double total;	    /* fs total size */
-	double avail;	    /* fs available size */
-	double used;	    /* fs used size */
+	uint64_t total;	    /* fs total size in bytes */
+	uint64_t avail;	    /* fs available size in bytes */
+	uint64_t used;	    /* fs used size in bytes */
+	uint64_t held;	    /* size of its deleted files still open (--held) */
+	uint64_t dev;	    /* device told when stated (--held), 0 if none */
 
 	/* infos to get from statvfs(3) */
 #if defined(__linux__) || defined(__GLIBC__)
@@ -145,6 +176,13 @@ struct fsmntinfo {
 struct list {
 	struct fsmntinfo *head;
 	struct fsmntinfo *tail;
+	/*
+	 * when set, elements are handed to it instead of being queued: it
+	 * owns them from then on, minds the widths of the columns itself and
+	 * returns -1 on error, 0 otherwise
+	 */
+	int (*stream)(void *, struct fsmntinfo *);
+	void *arg;		/* first argument of stream */
 };
 
 /* function declaration */
@@ -153,5 +191,8 @@ int is_empty(struct list lst);
 int enqueue(struct list *lst, struct fsmntinfo elt);
 struct fsmntinfo fmi_init(void);
 struct fsmntinfo *delete_struct_and_get_next(struct fsmntinfo *p);
+struct strtab *strtab_new(size_t len);
+struct strtab *strtab_ref(struct strtab *tab);
+void strtab_unref(struct strtab *tab);
 
 #endif /* ndef LIST_H */
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * mntindex.c
+ *
+ * Resolve paths to the mount point they are on, using a trie of the path
+ * components of the mount points: the mount point of a path is the deepest
+ * one found while walking down the trie along the components of the path.
+ */
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "mntindex.h"
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif /* ndef PATH_MAX */
+
+/* node of the trie, one per path component */
+struct node {
+	const char *name;	/* component, not null terminated */
+	size_t len;		/* length of the component */
+	long id;		/* index of the mount point, -1 if none */
+	struct node *child;
+	struct node *sibling;
+};
+
+/* static function declaration */
+static const char *next_component(const char *path, size_t *len);
+static struct node *new_node(const char *name, size_t len);
+static int insert(struct node *root, const char *dir, long id);
+static size_t lookup(const struct node *root, const char *path, long *ids);
+static void free_trie(struct node *n);
+
+/*
+ * Return the first component of `path` and store its length in `len`, or
+ * return NULL if there is none left
+ * @path: path, possibly starting with slashes
+ * @len: set to the length of the component
+ */
+static const char *
+next_component(const char *path, size_t *len)
+{
+	while (*path == '/')
+		path++;
+	if (*path == '\0')
+		return NULL;
+
+	*len = strcspn(path, "/");
+
+	return path;
+}
+
+static struct node *
+new_node(const char *name, size_t len)
+{
+	struct node *n;
+
+	if ((n = malloc(sizeof(*n))) == NULL)
+		return NULL;
+	n->name = name;
+	n->len = len;
+	n->id = -1;
+	n->child = NULL;
+	n->sibling = NULL;
+
+	return n;
+}
+
+/*
+ * Add the mount point `dir` to the trie. When several file systems are
+ * mounted on the same directory, the last one hides the others.
+ * Return -1 if it fails, 0 otherwise.
+ * @root: root of the trie, that is "/"
+ * @dir: mount point, which must remain valid as long as the trie
+ * @id: index of the mount point
+ */
+static int
+insert(struct node *root, const char *dir, long id)
+{
+	struct node *n = root, *c;
+	const char *comp;
+	size_t len;
+
+	for (; (comp = next_component(dir, &len)) != NULL; dir = comp + len) {
+		for (c = n->child; c; c = c->sibling)
+			if (c->len == len && strncmp(c->name, comp, len) == 0)
+				break;
+		if (c == NULL) {
+			if ((c = new_node(comp, len)) == NULL)
+				return -1;
+			c->sibling = n->child;
+			n->child = c;
+		}
+		n = c;
+	}
+	n->id = id;
+
+	return 0;
+}
+
+/*
+ * Store in `ids` the indexes of the mount points `path` is under, deepest
+ * first, and return their number
+ * @root: root of the trie
+ * @path: absolute path without "." or ".." components
+ * @ids: array large enough to hold one index per component of path, plus one
+ */
+static size_t
+lookup(const struct node *root, const char *path, long *ids)
+{
+	const struct node *n = root, *c;
+	const char *comp;
+	size_t len, nids = 0, i;
+	long tmp;
+
+	if (n->id >= 0)
+		ids[nids++] = n->id;
+
+	for (; (comp = next_component(path, &len)) != NULL; path = comp + len) {
+		for (c = n->child; c; c = c->sibling)
+			if (c->len == len && strncmp(c->name, comp, len) == 0)
+				break;
+		if (c == NULL)
+			break;
+		n = c;
+		if (n->id >= 0)
+			ids[nids++] = n->id;
+	}
+
+	/* deepest first */
+	for (i = 0; i < nids / 2; i++) {
+		tmp = ids[i];
+		ids[i] = ids[nids - 1 - i];
+		ids[nids - 1 - i] = tmp;
+	}
+
+	return nids;
+}
+
+static void
+free_trie(struct node *n)
+{
+	struct node *next;
+
+	for (; n; n = next) {
+		next = n->sibling;
+		free_trie(n->child);
+		free(n);
+	}
+}
+
+/*
+ * Find the mount point each path is on and mark it as selected.
+ * Paths are resolved with realpath(3). Among the mount points the resolved
+ * path is under, the deepest one on the same device as the path is selected;
+ * this only needs to stat(2) a couple of mount points and no file system is
+ * ever statvfs'ed.
+ * Return -1 if a path could not be resolved, 0 otherwise.
+ * @dirs: mount points, in the order of the mount table
+ * @ndirs: number of mount points
+ * @paths: paths to resolve
+ * @npaths: number of paths
+ * @selected: array of ndirs booleans, set to 1 for the selected mount points
+ */
+int
+select_mounts(const char *const dirs[], size_t ndirs, char *const paths[],
+    int npaths, unsigned char *selected)
+{
+	struct node *root;
+	struct stat pst, mst;
+	char resolved[PATH_MAX];
+	long *ids;
+	size_t nids, i;
+	int ret = 0, p;
+
+	/* a path has at most PATH_MAX / 2 components */
+	root = new_node("", 0);
+	ids = malloc((PATH_MAX / 2 + 1) * sizeof(*ids));
+	if (root == NULL || ids == NULL)
+		goto nomem;
+
+	for (i = 0; i < ndirs; i++)
+		if (insert(root, dirs[i], (long)i) == -1)
+			goto nomem;
+
+	for (p = 0; p < npaths; p++) {
+		if (realpath(paths[p], resolved) == NULL ||
+		    stat(resolved, &pst) == -1) {
+			(void)fprintf(stderr, "%s: %s\n", paths[p],
+				strerror(errno));
+			ret = -1;
+			continue;
+		}
+
+		if ((nids = lookup(root, resolved, ids)) == 0) {
+			(void)fprintf(stderr, "%s: %s\n", paths[p],
+				strerror(ENOENT));
+			ret = -1;
+			continue;
+		}
+
+		/* mount points may be hidden or bind mounted elsewhere */
+		for (i = 0; i < nids; i++) {
+			if (stat(dirs[ids[i]], &mst) == 0 &&
+			    mst.st_dev == pst.st_dev)
+				break;
+		}
+		selected[ids[i < nids ? i : 0]] = 1;
+	}
+
+	free(ids);
+	free_trie(root);
+
+	return ret;
+
+nomem:
+	(void)fputs("Error while allocating memory to resolve paths\n", stderr);
+	exit(EXIT_FAILURE);
+	/* NOTREACHED */
+}
@@ -0,0 +1,794 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * drill-linux.c
+ *
+ * Linux implementation of the walk of a mount for its largest directories and
+ * files. Directories are read with getdents64 and their entries stated with
+ * statx in the order of their inodes, which is the closest to the one they
+ * have on disk, so that a tree which is not in the cache is read with as few
+ * seeks as possible. As this is mostly waiting for the disk, the walk runs on
+ * several threads per CPU, each taking the directories it found first and
+ * stealing the oldest ones of the others when it has none left: those are the
+ * highest in the tree, thus the ones which hold the most work.
+ */
+
+/* for statx and AT_NO_AUTOMOUNT */
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__) || defined(__GLIBC__)
+
+#ifdef NLS_ENABLED
+#include <locale.h>
+#include <libintl.h>
+#endif /* NLS_ENABLED */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include "extern.h"
+#include "services.h"
+
+/* upper bound of the number of threads */
+#define DRILL_MAXTHREADS 64
+
+/* threads per CPU, to keep the disk busy while some of them wait for it */
+#define DRILL_THREADSPERCPU 4
+
+/* room for the entries read at once from a directory */
+#define DRILL_BUFSIZE (128 * 1024)
+
+/* size of the smallest entry returned by getdents64 */
+#define DRILL_MINRECLEN 24
+
+/* number of parts of the set of files with several links, locked apart */
+#define DRILL_NSHARDS 64
+
+/* an entry of a directory, as returned by getdents64 */
+struct drill_dirent {
+	uint64_t d_ino;
+	int64_t d_off;
+	unsigned short d_reclen;
+	unsigned char d_type;
+	char d_name[];
+};
+
+/* what is looked at of an inode */
+struct drill_stat {
+	uint64_t dev;
+	uint64_t ino;
+	uint64_t nlink;
+	uint64_t size;		/* bytes allocated to it */
+	mode_t mode;
+};
+
+/* an entry of a directory, to be stated in the order of the inodes */
+struct drill_name {
+	uint64_t ino;
+	const char *name;
+};
+
+/* a directory which may be shown: the ones below it add up to it */
+struct drill_node {
+	pthread_mutex_t lock;	/* protects size and files */
+	struct drill_node *parent;	/* NULL right under the walked one */
+	char *path;
+	uint64_t size;
+	uint64_t files;
+};
+
+/* a directory to read */
+struct drill_job {
+	char *path;
+	struct drill_node *node;	/* deepest node it is in, if any */
+	uint64_t size;		/* bytes allocated to the directory itself */
+	int depth;
+};
+
+/* directories a thread is to read, the oldest ones first */
+struct drill_deque {
+	pthread_mutex_t lock;
+	struct drill_job *jobs;
+	size_t head;		/* oldest job */
+	size_t tail;		/* past the newest job */
+	size_t cap;
+};
+
+/* largest files found by a thread, as a heap with the smallest on top */
+struct drill_heap {
+	struct drill_entry *entries;
+	size_t n;
+};
+
+/* a part of the set of files with several links */
+struct drill_shard {
+	pthread_mutex_t lock;
+	uint64_t *inos;		/* open addressing, 0 for a free slot */
+	size_t n;
+	size_t cap;
+};
+
+struct drill_shared;
+
+/* state of a thread */
+struct drill_worker {
+	struct drill_shared *sh;
+	struct drill_deque dq;
+	size_t id;
+	unsigned long gen;	/* generation of the jobs it last looked for */
+	char *buf;		/* entries read from a directory */
+	struct drill_name *names;
+	struct drill_job *children;	/* found in the directory being read */
+	size_t nchildren;
+	size_t capchildren;
+	struct drill_heap top;
+	struct drill_node **nodes;	/* nodes it made */
+	size_t nnodes;
+	size_t capnodes;
+	uint64_t size;		/* of the part of the tree it read */
+	uint64_t files;
+	unsigned long errors;	/* directories which could not be read */
+};
+
+/* work shared by the threads */
+struct drill_shared {
+	pthread_mutex_t lock;	/* protects pending, idle and gen */
+	pthread_cond_t wake;
+	size_t pending;		/* directories queued or being read */
+	size_t idle;		/* threads waiting for directories */
+	unsigned long gen;	/* bumped whenever directories are queued */
+	struct drill_worker *workers;
+	size_t nworkers;
+	uint64_t dev;		/* file system walked */
+	int depth;		/* of the nodes */
+	size_t topk;
+	struct drill_shard shards[DRILL_NSHARDS];
+};
+
+/* static function declaration */
+static void nomem(void);
+static int stat_at(int dfd, const char *name, int flags,
+    struct drill_stat *ds);
+static uint64_t ino_hash(uint64_t ino);
+static int first_link(struct drill_shared *sh, uint64_t ino);
+static char *join_path(const char *dir, const char *name);
+static void top_add(struct drill_worker *w, const char *dir,
+    const char *name, uint64_t size);
+static void add_child(struct drill_worker *w, const struct drill_job *job,
+    const char *name, uint64_t size);
+static void deque_push(struct drill_deque *dq, const struct drill_job *jobs,
+    size_t n);
+static int take(struct drill_worker *w, struct drill_job *job);
+static void read_dir(struct drill_worker *w, const struct drill_job *job);
+static void done(struct drill_worker *w);
+static void *walker(void *arg);
+static void run_pool(struct drill_shared *sh);
+static int namecmp(const void *a, const void *b);
+static int entrycmp(const void *a, const void *b);
+
+static void
+nomem(void)
+{
+	(void)fputs("Error while allocating memory to walk the tree\n",
+		stderr);
+	exit(EXIT_FAILURE);
+	/* NOTREACHED */
+}
+
+/*
+ * State an entry of a directory, without triggering automounts
+ * Return -1 if it cannot be stated, 0 otherwise.
+ * @dfd: directory, or AT_FDCWD
+ * @name: entry
+ * @flags: AT_SYMLINK_NOFOLLOW or 0
+ * @ds: set to what was found
+ */
+static int
+stat_at(int dfd, const char *name, int flags, struct drill_stat *ds)
+{
+#ifdef STATX_BLOCKS
+	struct statx stx;
+
+	/* sizes as cached are good enough to rank files */
+	if (statx(dfd, name, flags | AT_NO_AUTOMOUNT | AT_STATX_DONT_SYNC,
+	    STATX_TYPE | STATX_INO | STATX_NLINK | STATX_BLOCKS, &stx) == -1)
+		return -1;
+	ds->dev = (uint64_t)stx.stx_dev_major << 32 | stx.stx_dev_minor;
+	ds->ino = stx.stx_ino;
+	ds->nlink = stx.stx_nlink;
+	ds->size = stx.stx_blocks * 512;
+	ds->mode = stx.stx_mode;
+#else
+	struct stat st;
+
+	if (fstatat(dfd, name, &st, flags | AT_NO_AUTOMOUNT) == -1)
+		return -1;
+	ds->dev = (uint64_t)st.st_dev;
+	ds->ino = (uint64_t)st.st_ino;
+	ds->nlink = (uint64_t)st.st_nlink;
+	ds->size = (uint64_t)st.st_blocks * 512;
+	ds->mode = st.st_mode;
+#endif /* STATX_BLOCKS */
+
+	return 0;
+}
+
+static uint64_t
+ino_hash(uint64_t ino)
+{
+	return ino * UINT64_C(0x9e3779b97f4a7c15);
+}
+
+/*
+ * Tell whether a file with several links is met for the first time
+ * Return 1 if it is, 0 if it was counted already.
+ * @sh: work shared by the threads
+ * @ino: inode of the file
+ */
+static int
+first_link(struct drill_shared *sh, uint64_t ino)
+{
+	uint64_t h = ino_hash(ino);
+	struct drill_shard *s = &sh->shards[h >> 58];
+	uint64_t *inos;
+	size_t cap, mask, i, j;
+	int first = 1;
+
+	(void)pthread_mutex_lock(&s->lock);
+	if ((s->n + 1) * 2 > s->cap) {
+		cap = s->cap ? s->cap * 2 : 64;
+		if ((inos = calloc(cap, sizeof(*inos))) == NULL)
+			nomem();
+		for (i = 0; i < s->cap; i++) {
+			if (s->inos[i] == 0)
+				continue;
+			for (j = (size_t)ino_hash(s->inos[i]) & (cap - 1);
+			    inos[j] != 0; j = (j + 1) & (cap - 1))
+				;
+			inos[j] = s->inos[i];
+		}
+		free(s->inos);
+		s->inos = inos;
+		s->cap = cap;
+	}
+	mask = s->cap - 1;
+	for (i = (size_t)h & mask; s->inos[i] != 0; i = (i + 1) & mask) {
+		if (s->inos[i] == ino) {
+			first = 0;
+			break;
+		}
+	}
+	if (first) {
+		s->inos[i] = ino;
+		s->n++;
+	}
+	(void)pthread_mutex_unlock(&s->lock);
+
+	return first;
+}
+
+/*
+ * Return the path of an entry of a directory, to free
+ */
+static char *
+join_path(const char *dir, const char *name)
+{
+	size_t dlen = strlen(dir), nlen = strlen(name);
+	char *path;
+
+	if ((path = malloc(dlen + nlen + 2)) == NULL)
+		nomem();
+	(void)memcpy(path, dir, dlen);
+	/* the root directory already ends with a slash */
+	if (dlen == 0 || dir[dlen - 1] != '/')
+		path[dlen++] = '/';
+	(void)memcpy(path + dlen, name, nlen + 1);
+
+	return path;
+}
+
+/*
+ * Keep a file if it is among the largest ones found by a thread
+ * @w: thread
+ * @dir: directory of the file
+ * @name: name of the file
+ * @size: bytes allocated to the file
+ */
+static void
+top_add(struct drill_worker *w, const char *dir, const char *name,
+    uint64_t size)
+{
+	struct drill_heap *t = &w->top;
+	struct drill_entry e;
+	size_t k = w->sh->topk, i, c;
+
+	if (k == 0 || (t->n == k && size <= t->entries[0].size))
+		return;
+	e.path = join_path(dir, name);
+	e.size = size;
+	e.files = 1;
+
+	if (t->n < k) {
+		for (i = t->n++; i > 0 && t->entries[(i - 1) / 2].size > size;
+		    i = (i - 1) / 2)
+			t->entries[i] = t->entries[(i - 1) / 2];
+		t->entries[i] = e;
+		return;
+	}
+
+	/* the smallest one makes room */
+	free(t->entries[0].path);
+	for (i = 0; (c = 2 * i + 1) < t->n; i = c) {
+		if (c + 1 < t->n && t->entries[c + 1].size < t->entries[c].size)
+			c++;
+		if (t->entries[c].size >= size)
+			break;
+		t->entries[i] = t->entries[c];
+	}
+	t->entries[i] = e;
+}
+
+/*
+ * Keep a directory found in the one being read, to queue it once it is read
+ * @w: thread
+ * @job: directory being read
+ * @name: name of the directory found
+ * @size: bytes allocated to the directory found itself
+ */
+static void
+add_child(struct drill_worker *w, const struct drill_job *job,
+    const char *name, uint64_t size)
+{
+	struct drill_job *child, *jobs;
+	struct drill_node *node, **nodes;
+
+	if (w->nchildren == w->capchildren) {
+		w->capchildren = w->capchildren ? w->capchildren * 2 : 64;
+		jobs = realloc(w->children, w->capchildren * sizeof(*jobs));
+		if (jobs == NULL)
+			nomem();
+		w->children = jobs;
+	}
+	child = &w->children[w->nchildren++];
+	child->path = join_path(job->path, name);
+	child->node = job->node;
+	child->size = size;
+	child->depth = job->depth + 1;
+	if (child->depth > w->sh->depth)
+		return;
+
+	if ((node = calloc(1, sizeof(*node))) == NULL ||
+	    (node->path = strdup(child->path)) == NULL)
+		nomem();
+	(void)pthread_mutex_init(&node->lock, NULL);
+	node->parent = job->node;
+	child->node = node;
+
+	if (w->nnodes == w->capnodes) {
+		w->capnodes = w->capnodes ? w->capnodes * 2 : 64;
+		nodes = realloc(w->nodes, w->capnodes * sizeof(*nodes));
+		if (nodes == NULL)
+			nomem();
+		w->nodes = nodes;
+	}
+	w->nodes[w->nnodes++] = node;
+}
+
+/*
+ * Queue directories on the deque of a thread
+ * @dq: deque of the thread
+ * @jobs: directories
+ * @n: number of directories
+ */
+static void
+deque_push(struct drill_deque *dq, const struct drill_job *jobs, size_t n)
+{
+	struct drill_job *tmp;
+
+	(void)pthread_mutex_lock(&dq->lock);
+	if (dq->tail + n > dq->cap && dq->head > 0) {
+		/* take back the room of the stolen jobs first */
+		(void)memmove(dq->jobs, dq->jobs + dq->head,
+			(dq->tail - dq->head) * sizeof(*dq->jobs));
+		dq->tail -= dq->head;
+		dq->head = 0;
+	}
+	if (dq->tail + n > dq->cap) {
+		dq->cap = dq->cap ? dq->cap * 2 : 64;
+		if (dq->cap < dq->tail + n)
+			dq->cap = dq->tail + n;
+		if ((tmp = realloc(dq->jobs, dq->cap * sizeof(*tmp))) == NULL)
+			nomem();
+		dq->jobs = tmp;
+	}
+	(void)memcpy(dq->jobs + dq->tail, jobs, n * sizeof(*jobs));
+	dq->tail += n;
+	(void)pthread_mutex_unlock(&dq->lock);
+}
+
+/*
+ * Take a directory to read: the newest one of the thread, which is the
+ * closest to the last one it read, or else the oldest one of another thread
+ * Return 1 if there was one, 0 otherwise.
+ * @w: thread
+ * @job: set to the directory
+ */
+static int
+take(struct drill_worker *w, struct drill_job *job)
+{
+	struct drill_shared *sh = w->sh;
+	struct drill_deque *dq = &w->dq;
+	size_t i;
+	int found = 0;
+
+	(void)pthread_mutex_lock(&dq->lock);
+	if (dq->tail > dq->head) {
+		*job = dq->jobs[--dq->tail];
+		found = 1;
+	}
+	if (dq->tail == dq->head)
+		dq->head = dq->tail = 0;
+	(void)pthread_mutex_unlock(&dq->lock);
+
+	for (i = 1; !found && i < sh->nworkers; i++) {
+		dq = &sh->workers[(w->id + i) % sh->nworkers].dq;
+		(void)pthread_mutex_lock(&dq->lock);
+		if (dq->tail > dq->head) {
+			*job = dq->jobs[dq->head++];
+			found = 1;
+		}
+		(void)pthread_mutex_unlock(&dq->lock);
+	}
+
+	return found;
+}
+
+/*
+ * Read a directory: add up its files, keep the largest ones and keep the
+ * directories it holds on the same file system
+ * @w: thread
+ * @job: directory
+ */
+static void
+read_dir(struct drill_worker *w, const struct drill_job *job)
+{
+	struct drill_shared *sh = w->sh;
+	const struct drill_dirent *d;
+	struct drill_node *node;
+	struct drill_stat ds;
+	uint64_t size = job->size, files = 1;
+	size_t n, i, off;
+	long ret = 0;
+	int fd;
+
+	/* only the walked directory may be reached through a link */
+	fd = open(job->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC |
+		(job->depth > 0 ? O_NOFOLLOW : 0));
+	while (fd != -1 &&
+	    (ret = syscall(SYS_getdents64, fd, w->buf, DRILL_BUFSIZE)) > 0) {
+		n = 0;
+		for (off = 0; off < (size_t)ret; off += d->d_reclen) {
+			d = (const void *)(w->buf + off);
+			if (d->d_name[0] == '.' && (d->d_name[1] == '\0' ||
+			    (d->d_name[1] == '.' && d->d_name[2] == '\0')))
+				continue;
+			w->names[n].ino = d->d_ino;
+			w->names[n].name = d->d_name;
+			n++;
+		}
+		qsort(w->names, n, sizeof(*w->names), namecmp);
+
+		for (i = 0; i < n; i++) {
+			if (stat_at(fd, w->names[i].name, AT_SYMLINK_NOFOLLOW,
+			    &ds) == -1)
+				continue;
+			/* file systems mounted below are not walked */
+			if (ds.dev != sh->dev)
+				continue;
+			if (S_ISDIR(ds.mode)) {
+				add_child(w, job, w->names[i].name, ds.size);
+				continue;
+			}
+			if (ds.nlink > 1 && ds.ino != 0 &&
+			    !first_link(sh, ds.ino))
+				continue;
+			size += ds.size;
+			files++;
+			if (S_ISREG(ds.mode))
+				top_add(w, job->path, w->names[i].name,
+					ds.size);
+		}
+	}
+	if (fd == -1 || ret < 0)
+		w->errors++;
+	if (fd != -1)
+		(void)close(fd);
+
+	w->size += size;
+	w->files += files;
+	for (node = job->node; node != NULL; node = node->parent) {
+		(void)pthread_mutex_lock(&node->lock);
+		node->size += size;
+		node->files += files;
+		(void)pthread_mutex_unlock(&node->lock);
+	}
+}
+
+/*
+ * Queue the directories found in the one just read, which is then done
+ * @w: thread
+ */
+static void
+done(struct drill_worker *w)
+{
+	struct drill_shared *sh = w->sh;
+
+	/* counted before another thread can steal and finish them */
+	if (w->nchildren > 0) {
+		(void)pthread_mutex_lock(&sh->lock);
+		sh->pending += w->nchildren;
+		(void)pthread_mutex_unlock(&sh->lock);
+		deque_push(&w->dq, w->children, w->nchildren);
+	}
+
+	(void)pthread_mutex_lock(&sh->lock);
+	sh->pending--;
+	if (w->nchildren > 0)
+		sh->gen++;
+	if ((w->nchildren > 0 && sh->idle > 0) || sh->pending == 0)
+		(void)pthread_cond_broadcast(&sh->wake);
+	w->gen = sh->gen;
+	(void)pthread_mutex_unlock(&sh->lock);
+	w->nchildren = 0;
+}
+
+/*
+ * Thread reading directories until none is queued or being read
+ * @arg: state of the thread
+ */
+static void *
+walker(void *arg)
+{
+	struct drill_worker *w = arg;
+	struct drill_shared *sh = w->sh;
+	struct drill_job job;
+
+	for (;;) {
+		if (take(w, &job)) {
+			read_dir(w, &job);
+			free(job.path);
+			done(w);
+			continue;
+		}
+
+		(void)pthread_mutex_lock(&sh->lock);
+		if (sh->pending == 0) {
+			(void)pthread_mutex_unlock(&sh->lock);
+			break;
+		}
+		/* nothing was queued since it last looked: wait for it */
+		if (sh->gen == w->gen) {
+			sh->idle++;
+			(void)pthread_cond_wait(&sh->wake, &sh->lock);
+			sh->idle--;
+		}
+		w->gen = sh->gen;
+		(void)pthread_mutex_unlock(&sh->lock);
+	}
+
+	return NULL;
+}
+
+/*
+ * Run walker on a pool of threads, or here if none can be started
+ * @sh: work shared by the threads
+ */
+static void
+run_pool(struct drill_shared *sh)
+{
+	pthread_t threads[DRILL_MAXTHREADS];
+	size_t started, i;
+
+	for (started = 0; started < sh->nworkers; started++)
+		if (pthread_create(&threads[started], NULL, walker,
+		    &sh->workers[started]) != 0)
+			break;
+	for (i = 0; i < started; i++)
+		(void)pthread_join(threads[i], NULL);
+
+	/* the walked directory is queued on the first thread */
+	if (started == 0)
+		(void)walker(&sh->workers[0]);
+}
+
+/*
+ * Order entries of a directory by inode
+ */
+static int
+namecmp(const void *a, const void *b)
+{
+	const struct drill_name *x = a;
+	const struct drill_name *y = b;
+
+	if (x->ino != y->ino)
+		return x->ino < y->ino ? -1 : 1;
+	return 0;
+}
+
+/*
+ * Order directories or files by decreasing size, then by path
+ */
+static int
+entrycmp(const void *a, const void *b)
+{
+	const struct drill_entry *x = a;
+	const struct drill_entry *y = b;
+
+	if (x->size != y->size)
+		return x->size > y->size ? -1 : 1;
+	return strcmp(x->path, y->path);
+}
+
+int
+fetch_drill(const char *path, int depth, size_t topk,
+    struct drill_result *res)
+{
+	struct drill_shared sh;
+	struct drill_worker *w;
+	struct drill_stat ds;
+	struct drill_job root;
+	struct drill_node *node;
+	unsigned long errors = 0;
+	long nthreads;
+	size_t i, j, ndirs = 0, nfiles = 0;
+
+	(void)memset(res, 0, sizeof(*res));
+	if (stat_at(AT_FDCWD, path, 0, &ds) == -1) {
+		perror(path);
+		return -1;
+	}
+	if (!S_ISDIR(ds.mode)) {
+		errno = ENOTDIR;
+		perror(path);
+		return -1;
+	}
+
+	(void)memset(&sh, 0, sizeof(sh));
+	sh.dev = ds.dev;
+	sh.depth = depth;
+	sh.topk = topk;
+	(void)pthread_mutex_init(&sh.lock, NULL);
+	(void)pthread_cond_init(&sh.wake, NULL);
+	for (i = 0; i < DRILL_NSHARDS; i++)
+		(void)pthread_mutex_init(&sh.shards[i].lock, NULL);
+
+	nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthreads < 1)
+		nthreads = 1;
+	nthreads *= DRILL_THREADSPERCPU;
+	if (nthreads > DRILL_MAXTHREADS)
+		nthreads = DRILL_MAXTHREADS;
+	sh.nworkers = (size_t)nthreads;
+
+	if ((sh.workers = calloc(sh.nworkers, sizeof(*sh.workers))) == NULL)
+		nomem();
+	for (i = 0; i < sh.nworkers; i++) {
+		w = &sh.workers[i];
+		w->sh = &sh;
+		w->id = i;
+		(void)pthread_mutex_init(&w->dq.lock, NULL);
+		if ((w->buf = malloc(DRILL_BUFSIZE)) == NULL ||
+		    (w->names = malloc((DRILL_BUFSIZE / DRILL_MINRECLEN + 1) *
+		    sizeof(*w->names))) == NULL ||
+		    (w->top.entries = calloc(topk + 1,
+		    sizeof(*w->top.entries))) == NULL)
+			nomem();
+	}
+
+	if ((root.path = strdup(path)) == NULL)
+		nomem();
+	root.node = NULL;
+	root.size = ds.size;
+	root.depth = 0;
+	deque_push(&sh.workers[0].dq, &root, 1);
+	sh.pending = 1;
+	run_pool(&sh);
+
+	if ((res->root.path = strdup(path)) == NULL)
+		nomem();
+	for (i = 0; i < sh.nworkers; i++) {
+		w = &sh.workers[i];
+		res->root.size += w->size;
+		res->root.files += w->files;
+		errors += w->errors;
+		ndirs += w->nnodes;
+		nfiles += w->top.n;
+	}
+
+	/* the largest directories and files of all the threads */
+	if ((res->dirs = calloc(ndirs + 1, sizeof(*res->dirs))) == NULL ||
+	    (res->files = calloc(nfiles + 1, sizeof(*res->files))) == NULL)
+		nomem();
+	for (i = 0; i < sh.nworkers; i++) {
+		w = &sh.workers[i];
+		for (j = 0; j < w->nnodes; j++) {
+			node = w->nodes[j];
+			res->dirs[res->ndirs].path = node->path;
+			res->dirs[res->ndirs].size = node->size;
+			res->dirs[res->ndirs].files = node->files;
+			res->ndirs++;
+			(void)pthread_mutex_destroy(&node->lock);
+			free(node);
+		}
+		(void)memcpy(res->files + res->nfiles, w->top.entries,
+			w->top.n * sizeof(*res->files));
+		res->nfiles += w->top.n;
+
+		(void)pthread_mutex_destroy(&w->dq.lock);
+		free(w->dq.jobs);
+		free(w->buf);
+		free(w->names);
+		free(w->children);
+		free(w->top.entries);
+		free(w->nodes);
+	}
+	qsort(res->dirs, res->ndirs, sizeof(*res->dirs), entrycmp);
+	qsort(res->files, res->nfiles, sizeof(*res->files), entrycmp);
+	for (; res->ndirs > topk; res->ndirs--)
+		free(res->dirs[res->ndirs - 1].path);
+	for (; res->nfiles > topk; res->nfiles--)
+		free(res->files[res->nfiles - 1].path);
+
+	for (i = 0; i < DRILL_NSHARDS; i++) {
+		(void)pthread_mutex_destroy(&sh.shards[i].lock);
+		free(sh.shards[i].inos);
+	}
+	(void)pthread_cond_destroy(&sh.wake);
+	(void)pthread_mutex_destroy(&sh.lock);
+	free(sh.workers);
+
+	if (errors > 0)
+		(void)fprintf(stderr, _("WARNING: %lu directories could not "
+			"be read\n"), errors);
+
+	return 0;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,408 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * held-linux.c
+ *
+ * Linux implementation of the search for deleted files which are still open.
+ * The open files of each process are looked at through /proc/PID/fd on a pool
+ * of threads: each descriptor costs a single stat of its link, which tells
+ * whether it is a regular file without any name left. Only those are looked
+ * at any further, so that hosts with many open files are scanned quickly.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__) || defined(__GLIBC__)
+
+#ifdef NLS_ENABLED
+#include <locale.h>
+#include <libintl.h>
+#endif /* NLS_ENABLED */
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "extern.h"
+#include "services.h"
+
+/* upper bound of the number of threads */
+#define HELD_MAXTHREADS 64
+
+/* what readlink(2) appends to the name of a deleted file */
+#define HELD_SUFFIX " (deleted)"
+
+/* a descriptor of a deleted file */
+struct held_fd {
+	uint64_t dev;
+	uint64_t ino;
+	uint64_t size;
+	struct held_owner owner;
+	char *path;
+};
+
+/* work shared by the threads */
+struct held_shared {
+	pthread_mutex_t lock;	/* protects next, fds and denied */
+	size_t next;
+	size_t n;
+	pid_t *pids;
+	struct held_fd *fds;	/* descriptors found by all the threads */
+	size_t nfds;
+	unsigned long denied;	/* processes which could not be looked at */
+};
+
+/* descriptors found by a thread */
+struct held_batch {
+	struct held_fd *fds;
+	size_t n;
+	size_t cap;
+};
+
+/* static function declaration */
+static void nomem(void);
+static size_t list_pids(pid_t **pids);
+static void read_comm(pid_t pid, char *comm);
+static int scan_pid(pid_t pid, struct held_batch *b);
+static void *scan_worker(void *arg);
+static void run_pool(struct held_shared *sh);
+static int fdcmp(const void *a, const void *b);
+static int filecmp(const void *a, const void *b);
+
+static void
+nomem(void)
+{
+	(void)fputs("Error while allocating memory to find deleted files\n",
+		stderr);
+	exit(EXIT_FAILURE);
+	/* NOTREACHED */
+}
+
+/*
+ * List the running processes
+ * Return the number of processes.
+ * @pids: set to the processes
+ */
+static size_t
+list_pids(pid_t **pids)
+{
+	DIR *dir;
+	struct dirent *ent;
+	pid_t *tmp;
+	size_t n = 0, cap = 0;
+
+	*pids = NULL;
+	if ((dir = opendir("/proc")) == NULL) {
+		perror("/proc");
+		return 0;
+	}
+	while ((ent = readdir(dir)) != NULL) {
+		if (!isdigit((unsigned char)ent->d_name[0]))
+			continue;
+		if (n == cap) {
+			cap = cap ? cap * 2 : 256;
+			if ((tmp = realloc(*pids, cap * sizeof(*tmp))) == NULL)
+				nomem();
+			*pids = tmp;
+		}
+		(*pids)[n++] = (pid_t)strtol(ent->d_name, NULL, 10);
+	}
+	(void)closedir(dir);
+
+	return n;
+}
+
+/*
+ * Read the name of the command of a process, "?" if it is gone already
+ * @pid: process
+ * @comm: set to the name, HELD_COMMLEN long
+ */
+static void
+read_comm(pid_t pid, char *comm)
+{
+	char path[64];
+	ssize_t len = -1;
+	int fd;
+
+	(void)snprintf(path, sizeof(path), "/proc/%ld/comm", (long)pid);
+	if ((fd = open(path, O_RDONLY)) != -1) {
+		len = read(fd, comm, HELD_COMMLEN - 1);
+		(void)close(fd);
+	}
+	if (len <= 0) {
+		(void)snprintf(comm, HELD_COMMLEN, "?");
+		return;
+	}
+	comm[len] = '\0';
+	comm[strcspn(comm, "\n")] = '\0';
+}
+
+/*
+ * Find the deleted regular files a process holds open
+ * Return -1 if its descriptors cannot be looked at, 0 otherwise.
+ * @pid: process
+ * @b: batch to add the descriptors of deleted files to
+ */
+static int
+scan_pid(pid_t pid, struct held_batch *b)
+{
+	DIR *dir;
+	struct dirent *ent;
+	struct stat st;
+	struct held_fd *fd, *tmp;
+	char path[PATH_MAX];
+	char comm[HELD_COMMLEN];
+	size_t slen = strlen(HELD_SUFFIX), len;
+	ssize_t ret;
+	int dfd;
+
+	(void)snprintf(path, sizeof(path), "/proc/%ld/fd", (long)pid);
+	/* processes come and go, only the permission is a concern */
+	dfd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (dfd == -1)
+		return errno == EACCES ? -1 : 0;
+	if ((dir = fdopendir(dfd)) == NULL) {
+		(void)close(dfd);
+		return 0;
+	}
+
+	comm[0] = '\0';
+	while ((ent = readdir(dir)) != NULL) {
+		if (ent->d_name[0] == '.')
+			continue;
+		/* the file the descriptor is open on, not its link */
+		if (fstatat(dfd, ent->d_name, &st, 0) == -1)
+			continue;
+		if (!S_ISREG(st.st_mode) || st.st_nlink > 0)
+			continue;
+
+		ret = readlinkat(dfd, ent->d_name, path, sizeof(path) - 1);
+		len = ret > 0 ? (size_t)ret : 0;
+		path[len] = '\0';
+		if (len >= slen && strcmp(path + len - slen, HELD_SUFFIX) == 0)
+			path[len - slen] = '\0';
+		if (comm[0] == '\0')
+			read_comm(pid, comm);
+
+		if (b->n == b->cap) {
+			b->cap = b->cap ? b->cap * 2 : 16;
+			if ((tmp = realloc(b->fds, b->cap * sizeof(*tmp)))
+			    == NULL)
+				nomem();
+			b->fds = tmp;
+		}
+		fd = &b->fds[b->n++];
+		fd->dev = (uint64_t)st.st_dev;
+		fd->ino = (uint64_t)st.st_ino;
+		fd->size = (uint64_t)st.st_blocks * 512;
+		fd->owner.pid = pid;
+		(void)memcpy(fd->owner.comm, comm, sizeof(comm));
+		if ((fd->path = strdup(path)) == NULL)
+			nomem();
+	}
+	(void)closedir(dir);
+
+	return 0;
+}
+
+/*
+ * Thread looking at processes until there is none left, then handing what
+ * it found over
+ * @arg: work shared by the threads
+ */
+static void *
+scan_worker(void *arg)
+{
+	struct held_shared *sh = arg;
+	struct held_batch b = { NULL, 0, 0 };
+	struct held_fd *tmp;
+	unsigned long denied = 0;
+	size_t i;
+
+	for (;;) {
+		(void)pthread_mutex_lock(&sh->lock);
+		i = sh->next;
+		if (i < sh->n)
+			sh->next++;
+		(void)pthread_mutex_unlock(&sh->lock);
+		if (i >= sh->n)
+			break;
+		if (scan_pid(sh->pids[i], &b) == -1)
+			denied++;
+	}
+
+	(void)pthread_mutex_lock(&sh->lock);
+	sh->denied += denied;
+	if (b.n > 0) {
+		tmp = realloc(sh->fds, (sh->nfds + b.n) * sizeof(*tmp));
+		if (tmp == NULL)
+			nomem();
+		sh->fds = tmp;
+		(void)memcpy(sh->fds + sh->nfds, b.fds, b.n * sizeof(*tmp));
+		sh->nfds += b.n;
+	}
+	(void)pthread_mutex_unlock(&sh->lock);
+	free(b.fds);
+
+	return NULL;
+}
+
+/*
+ * Run scan_worker on a pool of threads, one per CPU, or here if none can be
+ * started
+ * @sh: work shared by the threads
+ */
+static void
+run_pool(struct held_shared *sh)
+{
+	pthread_t threads[HELD_MAXTHREADS];
+	long nthreads, started, i;
+
+	nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthreads < 1)
+		nthreads = 1;
+	else if (nthreads > HELD_MAXTHREADS)
+		nthreads = HELD_MAXTHREADS;
+	if ((size_t)nthreads > sh->n)
+		nthreads = sh->n > 0 ? (long)sh->n : 1;
+
+	for (started = 0; started < nthreads; started++)
+		if (pthread_create(&threads[started], NULL, scan_worker,
+		    sh) != 0)
+			break;
+	for (i = 0; i < started; i++)
+		(void)pthread_join(threads[i], NULL);
+
+	if (started == 0)
+		(void)scan_worker(sh);
+}
+
+/*
+ * Order descriptors by file, then by process
+ */
+static int
+fdcmp(const void *a, const void *b)
+{
+	const struct held_fd *x = a;
+	const struct held_fd *y = b;
+
+	if (x->dev != y->dev)
+		return x->dev < y->dev ? -1 : 1;
+	if (x->ino != y->ino)
+		return x->ino < y->ino ? -1 : 1;
+	if (x->owner.pid != y->owner.pid)
+		return x->owner.pid < y->owner.pid ? -1 : 1;
+	return 0;
+}
+
+/*
+ * Order files by device, then by decreasing size
+ */
+static int
+filecmp(const void *a, const void *b)
+{
+	const struct held_file *x = a;
+	const struct held_file *y = b;
+
+	if (x->dev != y->dev)
+		return x->dev < y->dev ? -1 : 1;
+	if (x->size != y->size)
+		return x->size > y->size ? -1 : 1;
+	return 0;
+}
+
+ssize_t
+fetch_held(struct held_file **files)
+{
+	struct held_shared sh;
+	struct held_file *f;
+	struct held_fd *fd;
+	size_t n = 0, i, j, k;
+
+	*files = NULL;
+	(void)memset(&sh, 0, sizeof(sh));
+	if ((sh.n = list_pids(&sh.pids)) == 0) {
+		free(sh.pids);
+		return -1;
+	}
+
+	(void)pthread_mutex_init(&sh.lock, NULL);
+	run_pool(&sh);
+	(void)pthread_mutex_destroy(&sh.lock);
+	free(sh.pids);
+
+	if (sh.denied > 0)
+		(void)fprintf(stderr, _("WARNING: the open files of %lu "
+			"processes could not be read\n"), sh.denied);
+
+	/* a file open several times, or by several processes, is held once */
+	if (sh.nfds > 1)
+		qsort(sh.fds, sh.nfds, sizeof(*sh.fds), fdcmp);
+	if ((*files = calloc(sh.nfds + 1, sizeof(**files))) == NULL)
+		nomem();
+	for (i = 0; i < sh.nfds; i = j) {
+		fd = &sh.fds[i];
+		f = &(*files)[n++];
+		f->dev = fd->dev;
+		f->ino = fd->ino;
+		f->size = fd->size;
+		f->path = fd->path;
+		for (j = i; j < sh.nfds && sh.fds[j].dev == fd->dev &&
+		    sh.fds[j].ino == fd->ino; j++)
+			;
+		if ((f->owners = malloc((j - i) * sizeof(*f->owners))) ==
+		    NULL)
+			nomem();
+		for (k = i; k < j; k++) {
+			if (k > i)
+				free(sh.fds[k].path);
+			if (f->nowners > 0 && f->owners[f->nowners - 1].pid ==
+			    sh.fds[k].owner.pid)
+				continue;
+			f->owners[f->nowners++] = sh.fds[k].owner;
+		}
+	}
+	free(sh.fds);
+
+	qsort(*files, n, sizeof(**files), filecmp);
+
+	return (ssize_t)n;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,679 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * mntns-linux.c
+ *
+ * Linux implementation of the scan of the mount namespaces.
+ * The distinct namespaces are found through /proc/PID/ns/mnt, the mount table
+ * of each of them is read from /proc/PID/mountinfo on a pool of threads and a
+ * file system mounted in several namespaces (or several times in one) is
+ * stated only once, through /proc/PID/root, on the same pool.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__) || defined(__GLIBC__)
+
+#ifdef NLS_ENABLED
+#include <locale.h>
+#include <libintl.h>
+#endif /* NLS_ENABLED */
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/vfs.h>
+
+#include "extern.h"
+#include "fsclass.h"
+#include "services.h"
+#include "util.h"
+#include "where.h"
+
+/* upper bound of the number of threads */
+#define NS_MAXTHREADS 64
+
+/* number of owners shown before only counting them */
+#define NS_MAXOWNERS 3
+
+/* room for a line of mountinfo; what does not fit is super block options */
+#define NS_LINELEN 16384
+
+/* a mount namespace */
+struct ns_info {
+	ino_t ino;		/* namespace identifier */
+	pid_t pid;		/* lowest process in the namespace */
+	int self;		/* 1 if this is our own namespace */
+	struct ns_mount *mounts;
+	size_t nmounts;
+};
+
+/* a mount point of a namespace */
+struct ns_mount {
+	uint64_t dev;		/* major:minor of the file system */
+	size_t idx;		/* line in mountinfo */
+	int rootbind;		/* 1 if the root of the fs is mounted */
+	char *fsname;
+	char *fstype;
+	char *mntdir;
+	char *mntopts;
+	struct ns_info *ns;
+	/* set for the mount point shown for a file system */
+	size_t grp;		/* first mount point of the fs once grouped */
+	size_t ngrp;		/* number of mount points of the fs */
+	int stated;
+	struct statvfs vfs;
+};
+
+/* work shared by the threads */
+struct ns_shared {
+	pthread_mutex_t lock;	/* protects next */
+	size_t next;
+	size_t n;
+	struct ns_info *nss;
+	struct ns_mount **reps;
+};
+
+/* static function declaration */
+static int nscmp(const void *a, const void *b);
+static size_t list_namespaces(struct ns_info **nss, pid_t pid);
+static void unescape(char *s);
+static int parse_mountinfo(char *line, size_t idx, struct ns_mount *m);
+static void read_mountinfo(struct ns_info *ns);
+static int next_job(struct ns_shared *sh, size_t *i);
+static void *read_worker(void *arg);
+static void *stat_worker(void *arg);
+static void run_pool(struct ns_shared *sh, void *(*fn)(void *));
+static int devcmp(const void *a, const void *b);
+static int repcmp(const void *a, const void *b);
+static char *owners(struct ns_mount **grp, size_t n);
+static void add_mount(struct list *lst, struct fsmntinfo *fmi,
+    struct ns_mount *m, char *namespaces);
+
+/*
+ * Compare two namespaces by identifier, then by process
+ */
+static int
+nscmp(const void *a, const void *b)
+{
+	const struct ns_info *x = a;
+	const struct ns_info *y = b;
+
+	if (x->ino != y->ino)
+		return x->ino < y->ino ? -1 : 1;
+	if (x->pid != y->pid)
+		return x->pid < y->pid ? -1 : 1;
+	return 0;
+}
+
+/*
+ * Find the distinct mount namespaces
+ * Return the number of namespaces.
+ * @nss: set to the array of namespaces
+ * @pid: only look at the namespace of this process if not 0
+ */
+static size_t
+list_namespaces(struct ns_info **nss, pid_t pid)
+{
+	DIR *dir;
+	struct dirent *ent;
+	struct stat st, self;
+	struct ns_info *tmp;
+	char path[PATH_MAX];
+	size_t n = 0, cap = 0, i, j;
+	unsigned long denied = 0;
+
+	*nss = NULL;
+	if (stat("/proc/self/ns/mnt", &self) == -1) {
+		perror("/proc/self/ns/mnt");
+		return 0;
+	}
+
+	if (pid > 0) {
+		(void)snprintf(path, sizeof(path), "/proc/%ld/ns/mnt",
+			(long)pid);
+		if (stat(path, &st) == -1) {
+			perror(path);
+			return 0;
+		}
+		if ((*nss = calloc(1, sizeof(**nss))) == NULL)
+			goto nomem;
+		(*nss)->ino = st.st_ino;
+		(*nss)->pid = pid;
+		(*nss)->self = st.st_ino == self.st_ino;
+		return 1;
+	}
+
+	if ((dir = opendir("/proc")) == NULL) {
+		perror("/proc");
+		return 0;
+	}
+	while ((ent = readdir(dir)) != NULL) {
+		if (!isdigit((unsigned char)ent->d_name[0]))
+			continue;
+		(void)snprintf(path, sizeof(path), "/proc/%s/ns/mnt",
+			ent->d_name);
+		/* processes come and go, only the permission is a concern */
+		if (stat(path, &st) == -1) {
+			if (errno == EACCES)
+				denied++;
+			continue;
+		}
+		if (n == cap) {
+			cap = cap ? cap * 2 : 256;
+			if ((tmp = realloc(*nss, cap * sizeof(*tmp))) == NULL)
+				goto nomem;
+			*nss = tmp;
+		}
+		(void)memset(&(*nss)[n], 0, sizeof(**nss));
+		(*nss)[n].ino = st.st_ino;
+		(*nss)[n].pid = (pid_t)strtol(ent->d_name, NULL, 10);
+		(*nss)[n].self = st.st_ino == self.st_ino;
+		n++;
+	}
+	(void)closedir(dir);
+
+	if (denied > 0)
+		(void)fprintf(stderr, _("WARNING: the mount namespace of %lu "
+			"processes could not be read\n"), denied);
+
+	/* keep the lowest process of each namespace */
+	qsort(*nss, n, sizeof(**nss), nscmp);
+	for (i = 0, j = 0; i < n; i++) {
+		if (j > 0 && (*nss)[j - 1].ino == (*nss)[i].ino)
+			continue;
+		(*nss)[j++] = (*nss)[i];
+	}
+
+	return j;
+
+nomem:
+	(void)fputs("Error while allocating memory to list namespaces",
+		stderr);
+	exit(EXIT_FAILURE);
+	/* NOTREACHED */
+}
+
+/*
+ * Decode the octal escapes (\040 for a space, etc.) of mountinfo in place
+ * @s: string to decode
+ */
+static void
+unescape(char *s)
+{
+	char *d = s;
+
+	while (*s != '\0') {
+		if (s[0] == '\\' && s[1] >= '0' && s[1] <= '3' &&
+		    s[2] >= '0' && s[2] <= '7' && s[3] >= '0' && s[3] <= '7') {
+			*d++ = (char)((s[1] - '0') * 64 + (s[2] - '0') * 8 +
+				(s[3] - '0'));
+			s += 4;
+		} else {
+			*d++ = *s++;
+		}
+	}
+	*d = '\0';
+}
+
+/*
+ * Parse a line of mountinfo, see proc(5):
+ * ID PARENT MAJOR:MINOR ROOT MOUNTPOINT OPTIONS [OPTIONAL...] - TYPE SOURCE ...
+ * Return -1 if the line is malformed, 0 otherwise.
+ * @line: line to parse, modified
+ * @idx: position of the line
+ * @m: mount point to fill
+ */
+static int
+parse_mountinfo(char *line, size_t idx, struct ns_mount *m)
+{
+	char *field[6], *type, *source, *save = NULL, *tok;
+	unsigned long major, minor;
+	int i;
+
+	for (i = 0; i < 6; i++) {
+		field[i] = strtok_r(i == 0 ? line : NULL, " \n", &save);
+		if (field[i] == NULL)
+			return -1;
+	}
+	/* skip the optional fields */
+	while ((tok = strtok_r(NULL, " \n", &save)) != NULL &&
+	    strcmp(tok, "-") != 0)
+		;
+	if (tok == NULL)
+		return -1;
+	if ((type = strtok_r(NULL, " \n", &save)) == NULL ||
+	    (source = strtok_r(NULL, " \n", &save)) == NULL)
+		return -1;
+	if (sscanf(field[2], "%lu:%lu", &major, &minor) != 2)
+		return -1;
+
+	unescape(field[3]);
+	unescape(field[4]);
+	unescape(source);
+
+	m->dev = (uint64_t)major << 32 | minor;
+	m->idx = idx;
+	m->rootbind = strcmp(field[3], "/") == 0;
+	m->fsname = strdup(source);
+	m->fstype = strdup(type);
+	m->mntdir = strdup(field[4]);
+	m->mntopts = strdup(field[5]);
+	if (!m->fsname || !m->fstype || !m->mntdir || !m->mntopts) {
+		(void)fputs("Error while allocating memory to read mountinfo",
+			stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	return 0;
+}
+
+/*
+ * Read the mount table of a namespace
+ * @ns: namespace
+ */
+static void
+read_mountinfo(struct ns_info *ns)
+{
+	FILE *fp;
+	struct ns_mount *tmp;
+	char path[64];
+	char *line;
+	size_t cap = 0, idx = 0, len;
+	int partial = 0;
+
+	(void)snprintf(path, sizeof(path), "/proc/%ld/mountinfo",
+		(long)ns->pid);
+	/* the process may be gone already */
+	if ((fp = fopen(path, "r")) == NULL)
+		return;
+
+	if ((line = malloc(NS_LINELEN)) == NULL)
+		goto nomem;
+
+	while (fgets(line, NS_LINELEN, fp) != NULL) {
+		len = strlen(line);
+		/* rest of a line too long for the buffer */
+		if (partial) {
+			partial = len > 0 && line[len - 1] != '\n';
+			continue;
+		}
+		partial = len > 0 && line[len - 1] != '\n';
+		if (ns->nmounts == cap) {
+			cap = cap ? cap * 2 : 64;
+			tmp = realloc(ns->mounts, cap * sizeof(*tmp));
+			if (tmp == NULL)
+				goto nomem;
+			ns->mounts = tmp;
+		}
+		tmp = &ns->mounts[ns->nmounts];
+		(void)memset(tmp, 0, sizeof(*tmp));
+		if (parse_mountinfo(line, idx++, tmp) == -1)
+			continue;
+		tmp->ns = ns;
+		ns->nmounts++;
+	}
+
+	free(line);
+	(void)fclose(fp);
+	return;
+
+nomem:
+	(void)fputs("Error while allocating memory to read mountinfo", stderr);
+	exit(EXIT_FAILURE);
+	/* NOTREACHED */
+}
+
+/*
+ * Take the next job
+ * Return 0 when there is none left, 1 otherwise.
+ * @sh: work shared by the threads
+ * @i: set to the index of the job
+ */
+static int
+next_job(struct ns_shared *sh, size_t *i)
+{
+	int ret;
+
+	(void)pthread_mutex_lock(&sh->lock);
+	*i = sh->next;
+	ret = sh->next < sh->n;
+	if (ret)
+		sh->next++;
+	(void)pthread_mutex_unlock(&sh->lock);
+
+	return ret;
+}
+
+/*
+ * Thread reading mount tables until there is none left
+ * @arg: work shared by the threads
+ */
+static void *
+read_worker(void *arg)
+{
+	struct ns_shared *sh = arg;
+	size_t i;
+
+	while (next_job(sh, &i))
+		read_mountinfo(&sh->nss[i]);
+
+	return NULL;
+}
+
+/*
+ * Thread stating file systems until there is none left
+ * @arg: work shared by the threads
+ */
+static void *
+stat_worker(void *arg)
+{
+	struct ns_shared *sh = arg;
+	struct ns_mount *m;
+	struct statfs sfs;
+	char *path;
+	size_t i, len;
+
+	while (next_job(sh, &i)) {
+		m = sh->reps[i];
+		/* stating an autofs trigger point mounts it */
+		if (!automountflag && strcmp(m->fstype, "autofs") == 0)
+			continue;
+		/* avoid stating remote fs because they may hang */
+		if (lflag && is_remotefs(m->fstype))
+			continue;
+		/* --where may not need the statistics to tell */
+		if (!where_match_mount(m->fsname, m->fstype, m->mntdir,
+		    m->mntopts))
+			continue;
+		/* the mount point is relative to the root of the process */
+		len = strlen(m->mntdir) + 32;
+		if ((path = malloc(len)) == NULL) {
+			(void)fputs("Error while allocating memory to stat "
+				"file systems", stderr);
+			exit(EXIT_FAILURE);
+			/* NOTREACHED */
+		}
+		if (m->ns->self)
+			(void)snprintf(path, len, "%s", m->mntdir);
+		else
+			(void)snprintf(path, len, "/proc/%ld/root%s",
+				(long)m->ns->pid, m->mntdir);
+		if (statvfs(path, &m->vfs) == 0) {
+			m->stated = 1;
+			/* tell what an unknown type is (see fsclass.c) */
+			if (fsclass_get(m->fstype).source == FSCLASS_GUESS &&
+			    statfs(path, &sfs) == 0)
+				fsclass_magic(m->fstype,
+					(unsigned long)sfs.f_type);
+		}
+		/* show only "real" errors, not lack of permissions */
+		else if (errno != EACCES && errno != ENOENT) {
+			(void)fprintf(stderr, _("WARNING: %s was skipped "
+				"because it could not be stated"), path);
+			perror(" ");
+		}
+		free(path);
+	}
+
+	return NULL;
+}
+
+/*
+ * Run a function on a pool of threads, one per CPU, or here if none can be
+ * started
+ * @sh: work shared by the threads, of which next is reset
+ * @fn: function taking its jobs from sh
+ */
+static void
+run_pool(struct ns_shared *sh, void *(*fn)(void *))
+{
+	pthread_t threads[NS_MAXTHREADS];
+	long nthreads, started, i;
+
+	sh->next = 0;
+
+	nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthreads < 1)
+		nthreads = 1;
+	else if (nthreads > NS_MAXTHREADS)
+		nthreads = NS_MAXTHREADS;
+	if ((size_t)nthreads > sh->n)
+		nthreads = sh->n > 0 ? (long)sh->n : 1;
+
+	for (started = 0; started < nthreads; started++)
+		if (pthread_create(&threads[started], NULL, fn, sh) != 0)
+			break;
+	for (i = 0; i < started; i++)
+		(void)pthread_join(threads[i], NULL);
+
+	if (started == 0)
+		(void)fn(sh);
+}
+
+/*
+ * Order mount points by device, then by preference to show them: from our own
+ * namespace, from the lowest process, mounting the root of the file system
+ * and with the shortest path
+ */
+static int
+devcmp(const void *a, const void *b)
+{
+	const struct ns_mount *x = *(struct ns_mount *const *)a;
+	const struct ns_mount *y = *(struct ns_mount *const *)b;
+	size_t lx, ly;
+
+	if (x->dev != y->dev)
+		return x->dev < y->dev ? -1 : 1;
+	if (x->ns->self != y->ns->self)
+		return y->ns->self - x->ns->self;
+	if (x->ns->pid != y->ns->pid)
+		return x->ns->pid < y->ns->pid ? -1 : 1;
+	if (x->rootbind != y->rootbind)
+		return y->rootbind - x->rootbind;
+	lx = strlen(x->mntdir);
+	ly = strlen(y->mntdir);
+	if (lx != ly)
+		return lx < ly ? -1 : 1;
+	return x->idx < y->idx ? -1 : x->idx > y->idx;
+}
+
+/*
+ * Order the mount points shown as they appear in the mount tables, our own
+ * namespace first
+ */
+static int
+repcmp(const void *a, const void *b)
+{
+	const struct ns_mount *x = *(struct ns_mount *const *)a;
+	const struct ns_mount *y = *(struct ns_mount *const *)b;
+
+	if (x->ns->self != y->ns->self)
+		return y->ns->self - x->ns->self;
+	if (x->ns->pid != y->ns->pid)
+		return x->ns->pid < y->ns->pid ? -1 : 1;
+	return x->idx < y->idx ? -1 : x->idx > y->idx;
+}
+
+/*
+ * Return the lowest process of each namespace a file system is mounted in,
+ * such as "1,2345,6789+2", or NULL when it is only mounted in our own
+ * namespace
+ * @grp: mount points of the same file system, ordered by devcmp
+ * @n: number of mount points
+ */
+static char *
+owners(struct ns_mount **grp, size_t n)
+{
+	char *s;
+	size_t len, off = 0, i, shown = 0, more = 0;
+
+	if (grp[0]->ns->self && grp[n - 1]->ns == grp[0]->ns)
+		return NULL;
+
+	len = (NS_MAXOWNERS + 1) * 24;
+	if ((s = malloc(len)) == NULL)
+		return NULL;
+
+	for (i = 0; i < n; i++) {
+		/* mount points of a namespace are next to each other */
+		if (i > 0 && grp[i]->ns == grp[i - 1]->ns)
+			continue;
+		if (shown == NS_MAXOWNERS) {
+			more++;
+			continue;
+		}
+		off += (size_t)snprintf(s + off, len - off, "%s%ld",
+			shown > 0 ? "," : "", (long)grp[i]->ns->pid);
+		shown++;
+	}
+	if (more > 0)
+		(void)snprintf(s + off, len - off, "+%lu",
+			(unsigned long)more);
+
+	return s;
+}
+
+/*
+ * Enqueue a stated mount point, which strings are handed over to the queue
+ * @lst: queue in which to store information
+ * @fmi: fsmntinfo to fill
+ * @m: mount point
+ * @namespaces: processes of the namespaces it is mounted in, or NULL
+ */
+static void
+add_mount(struct list *lst, struct fsmntinfo *fmi, struct ns_mount *m,
+    char *namespaces)
+{
+	fmi->fsname = m->fsname;
+	fmi->mntdir = m->mntdir;
+	fmi->fstype = m->fstype;
+	fmi->mntopts = m->mntopts;
+	fmi->namespaces = namespaces;
+	m->fsname = m->mntdir = m->fstype = m->mntopts = NULL;
+
+	fmi->bsize    = m->vfs.f_bsize;
+	fmi->frsize   = m->vfs.f_frsize;
+	fmi->blocks   = m->vfs.f_blocks;
+	fmi->bfree    = m->vfs.f_bfree;
+	fmi->bavail   = m->vfs.f_bavail;
+	fmi->files    = m->vfs.f_files;
+	fmi->ffree    = m->vfs.f_ffree;
+	fmi->favail   = m->vfs.f_favail;
+
+	compute_fs_stats(fmi);
+
+	fmi->next = NULL;
+
+	enqueue(lst, *fmi);
+}
+
+int
+fetch_info_ns(struct list *lst, pid_t pid)
+{
+	struct ns_shared sh;
+	struct ns_mount **all;
+	struct fsmntinfo fmi;
+	size_t nns, nall, nreps, i, j, k;
+
+	if ((nns = list_namespaces(&sh.nss, pid)) == 0) {
+		free(sh.nss);
+		return -1;
+	}
+	(void)pthread_mutex_init(&sh.lock, NULL);
+
+	/* read the mount tables */
+	sh.n = nns;
+	run_pool(&sh, read_worker);
+
+	/* group the mount points by file system */
+	for (i = 0, nall = 0; i < nns; i++)
+		nall += sh.nss[i].nmounts;
+	all = malloc((nall + 1) * sizeof(*all));
+	sh.reps = malloc((nall + 1) * sizeof(*sh.reps));
+	if (all == NULL || sh.reps == NULL) {
+		(void)fputs("Error while allocating memory to group mount "
+			"points", stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	for (i = 0, k = 0; i < nns; i++)
+		for (j = 0; j < sh.nss[i].nmounts; j++)
+			all[k++] = &sh.nss[i].mounts[j];
+	qsort(all, nall, sizeof(*all), devcmp);
+	for (i = 0, nreps = 0; i < nall; i = k) {
+		for (k = i + 1; k < nall && all[k]->dev == all[i]->dev; k++)
+			;
+		all[i]->grp = i;
+		all[i]->ngrp = k - i;
+		sh.reps[nreps++] = all[i];
+	}
+
+	/* state each file system once */
+	sh.n = nreps;
+	run_pool(&sh, stat_worker);
+	(void)pthread_mutex_destroy(&sh.lock);
+
+	fmi = fmi_init();
+	qsort(sh.reps, nreps, sizeof(*sh.reps), repcmp);
+	for (i = 0; i < nreps; i++) {
+		if (!sh.reps[i]->stated)
+			continue;
+		j = sh.reps[i]->grp;
+		add_mount(lst, &fmi, sh.reps[i], pid > 0 ? NULL :
+			owners(&all[j], sh.reps[i]->ngrp));
+	}
+
+	for (i = 0; i < nns; i++) {
+		for (j = 0; j < sh.nss[i].nmounts; j++) {
+			free(sh.nss[i].mounts[j].fsname);
+			free(sh.nss[i].mounts[j].fstype);
+			free(sh.nss[i].mounts[j].mntdir);
+			free(sh.nss[i].mounts[j].mntopts);
+		}
+		free(sh.nss[i].mounts);
+	}
+	free(sh.nss);
+	free(sh.reps);
+	free(all);
+
+	return 0;
+}
+
+#endif /* __linux__ */
@@ -52,6 +52,7 @@
 #endif /* NLS_ENABLED */
 
 #include "extern.h"
+#include "mntindex.h"
 #include "services.h"
 #include "util.h"
 
@@ -101,13 +102,17 @@ is_remote(const struct fsmntinfo *fs)
 	return 1;
 }
 
-void
-fetch_info(struct list *lst)
+int
+fetch_info(struct list *lst, char *const paths[], int npaths)
 {
 	struct fsmntinfo *fmi;
-	int nummnt;
+	int nummnt, i;
 	statst *entbuf;
 	statst vfsbuf, **fs;
+	const char **dirs = NULL;
+	unsigned char *selected = NULL;
+	int ret = 0;
+
 	/* init fsmntinfo */
 	if ((fmi = malloc(sizeof(struct fsmntinfo))) == NULL) {
 		(void)fputs("Error while allocating memory to fmi", stderr);
@@ -119,32 +124,32 @@ fetch_info(struct list *lst)
 		err(EXIT_FAILURE, "Error while getting the list of mountpoints");
 		/* NOTREACHED */
 
-	for (fs = &entbuf; nummnt--; (*fs)++) {
-		vfsbuf = **fs;
-		if ((fmi->fsnameog = strdup(entbuf->f_mntfromname)) == NULL)
-			fmi->fsnameog = g_unknown_str;
-		if ((fmi->mntdirog = strdup(entbuf->f_mntonname)) == NULL)
-			fmi->mntdirog = g_unknown_str;
-		if ((fmi->fstypeog = strdup(entbuf->f_fstypename)) == NULL)
-			fmi->fstypeog = g_unknown_str;
-		if (Wflag) { /* Wflag to avoid name truncation */
-			fmi->fsname = fmi->fsnameog;
-			fmi->mntdir = fmi->mntdirog;
-			fmi->fstype = fmi->fstypeog;
-		} else {
-			if ((fmi->fsname = strdup(shortenstr(
-				entbuf->f_mntfromname, STRMAXLEN))) == NULL) {
-				fmi->fsname = g_unknown_str;
-			}
-			if ((fmi->mntdir = strdup(shortenstr(
-				entbuf->f_mntonname, STRMAXLEN))) == NULL) {
-				fmi->mntdir = g_unknown_str;
-			}
-			if ((fmi->fstype = strdup(shortenstr(
-				entbuf->f_fstypename, STRMAXLEN))) == NULL) {
-				fmi->fstype = g_unknown_str;
-			}
+	/* getmntinfo(3) already got the statistics: only filter the output */
+	if (npaths > 0) {
+		dirs = malloc(((size_t)nummnt + 1) * sizeof(*dirs));
+		selected = calloc((size_t)nummnt + 1, sizeof(*selected));
+		if (dirs == NULL || selected == NULL) {
+			(void)fputs("Error while allocating memory to resolve "
+				"paths", stderr);
+			exit(EXIT_FAILURE);
+			/* NOTREACHED */
 		}
+		for (i = 0; i < nummnt; i++)
+			dirs[i] = entbuf[i].f_mntonname;
+		ret = select_mounts(dirs, (size_t)nummnt, paths, npaths,
+			selected);
+	}
+
+	for (fs = &entbuf, i = 0; i < nummnt; (*fs)++, i++) {
+		if (selected && !selected[i])
+			continue;
+		vfsbuf = **fs;
+		if ((fmi->fsname = strdup(entbuf->f_mntfromname)) == NULL)
+			fmi->fsname = g_unknown_str;
+		if ((fmi->mntdir = strdup(entbuf->f_mntonname)) == NULL)
+			fmi->mntdir = g_unknown_str;
+		if ((fmi->fstype = strdup(entbuf->f_fstypename)) == NULL)
+			fmi->fstype = g_unknown_str;
 
 		/* infos from statvfs */
 		fmi->flags    = GET_FLAGS(vfsbuf);
@@ -168,25 +173,72 @@ fetch_info(struct list *lst)
 
 		/* enqueue the element into the queue */
 		enqueue(lst, *fmi);
-
-		update_maxwidth(fmi);
 	}
+	free(dirs);
+	free(selected);
 	free(fmi);
+
+	return ret;
+}
+
+int
+fetch_info_root(struct list *lst, const char *prefix)
+{
+	(void)lst;
+	(void)prefix;
+	(void)fputs(_("--root is not supported on this platform\n"), stderr);
+
+	return -1;
+}
+
+int
+fetch_info_ns(struct list *lst, pid_t pid)
+{
+	(void)lst;
+	(void)pid;
+	(void)fputs(_("Mount namespaces are not supported on this platform\n"),
+		stderr);
+
+	return -1;
+}
+
+ssize_t
+fetch_held(struct held_file **files)
+{
+	*files = NULL;
+	(void)fputs(_("--held is not supported on this platform\n"), stderr);
+
+	return -1;
+}
+
+int
+fetch_drill(const char *path, int depth, size_t topk,
+    struct drill_result *res)
+{
+	(void)path;
+	(void)depth;
+	(void)topk;
+	(void)memset(res, 0, sizeof(*res));
+	(void)fputs(_("--drill is not supported on this platform\n"), stderr);
+
+	return -1;
 }
 
 void
 compute_fs_stats(struct fsmntinfo *fmi)
 {
+	uint64_t unit;
+
 #if defined(__NetBSD__)
-	fmi->total = (double)fmi->frsize * (double)fmi->blocks;
-	fmi->avail = (double)fmi->frsize * (double)fmi->bavail;
-	fmi->used  = (double)fmi->frsize * ((double)fmi->blocks - (double)fmi->bfree);
+	unit = (uint64_t)fmi->frsize;
 #else
-	fmi->total  = (double)fmi->bsize * (double)fmi->blocks;
-	fmi->avail = (double)fmi->bsize * (double)fmi->bavail;
-	fmi->used  = (double)fmi->bsize * ((double)fmi->blocks - (double)fmi->bfree);
+	unit = (uint64_t)fmi->bsize;
 #endif /* __NetBSD__ */
-	if ((int)fmi->total == 0)
+	fmi->total = unit * (uint64_t)fmi->blocks;
+	/* f_bavail may be negative when root uses its reserved blocks */
+	fmi->avail = (fmi->bavail > 0) ? unit * (uint64_t)fmi->bavail : 0;
+	fmi->used  = unit * (uint64_t)(fmi->blocks - fmi->bfree);
+	if (fmi->total == 0)
 		fmi->perctused = 100.0;
 	else
 		fmi->perctused = 100.0 -
@@ -35,6 +35,9 @@
  * Linux implemention of services.
  */
 
+/* for O_PATH */
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -48,25 +51,280 @@
 #endif /* NLS_ENABLED */
 
 #include <mntent.h>
+#include <sys/fanotify.h>
+#include <sys/stat.h>
 #include <sys/statvfs.h>
+#include <sys/syscall.h>
+#include <sys/vfs.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
 
 #include "extern.h"
+#include "fsclass.h"
+#include "mntindex.h"
 #include "services.h"
 #include "util.h"
+#include "where.h"
+
+/* file systems which took longer than this to state are slow, in us */
+#define LANE_SLOW_USEC 20000
+
+/* number of threads stating the file systems of the slow lane, at most */
+#define LANE_MAXTHREADS 4
+
+/* seconds given to the slow lane before its file systems are skipped */
+#define LANE_DEADLINE 10
+
+/* where a file system of the cache is stated (see cache_fetch) */
+enum lane_id {
+	LANE_NONE,	/* not stated */
+	LANE_FAST,	/* here, in the order of the mount table */
+	LANE_SLOW	/* on the threads of the slow lane */
+};
+
+/* what stating a file system told */
+struct stat_res {
+	int ret;		/* result of the statvfs(3) call */
+	int err;		/* errno on error */
+	unsigned long usec;	/* time it took */
+	struct statvfs vfs;
+	uint64_t dev;		/* device of the file system (--held) */
+};
+
+/* a file system to state on the slow lane */
+struct lane_job {
+	struct lane_job *next;	/* next job not done yet */
+	char *path;		/* mount point, relative to dirfd */
+	int dirfd;		/* duplicate of the root of the cache */
+	int here;		/* stated by lane_wait, without any thread */
+	int running;		/* taken by a thread */
+	int done;		/* 1 once stated */
+	int abandoned;		/* no longer waited for: freed once done */
+	struct stat_res res;
+};
+
+/*
+ * Slow lane: file systems stated on a bounded pool of threads, so that they
+ * never hold back the other ones. The threads are started as needed and kept
+ * for the whole run: a thread stuck on a file system which does not answer
+ * keeps its place in the pool, and that file system is not queued again
+ * until it answers. Jobs hold copies of what they need, as they may outlive
+ * the cache.
+ */
+static struct {
+	pthread_mutex_t lock;	/* protects what follows and the jobs */
+	pthread_cond_t queued;	/* signaled when a job is queued */
+	pthread_cond_t done;	/* signaled when a job is done */
+	struct lane_job *jobs;	/* jobs queued or running, in order */
+	size_t nqueued;		/* jobs not taken by a thread yet */
+	int nthreads;		/* threads started */
+	int nidle;		/* threads waiting for a job */
+} lane = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+	PTHREAD_COND_INITIALIZER, NULL, 0, 0, 0 };
+
+/*
+ * Mount notifications (Linux 6.14) and the system calls telling about a mount
+ * by its identifier (Linux 6.8), which older headers do not know about
+ */
+#ifndef FAN_REPORT_MNT
+#define FAN_REPORT_MNT		0x00004000
+#endif
+#ifndef FAN_MARK_MNTNS
+#define FAN_MARK_MNTNS		0x00000110
+#endif
+#ifndef FAN_MNT_ATTACH
+#define FAN_MNT_ATTACH		0x01000000
+#endif
+#ifndef FAN_MNT_DETACH
+#define FAN_MNT_DETACH		0x02000000
+#endif
+#ifndef FAN_EVENT_INFO_TYPE_MNT
+#define FAN_EVENT_INFO_TYPE_MNT	7
+#endif
+#ifndef __NR_statmount
+#ifdef __alpha__
+#define __NR_statmount		567
+#define __NR_listmount		568
+#else
+#define __NR_statmount		457
+#define __NR_listmount		458
+#endif /* __alpha__ */
+#endif /* ndef __NR_statmount */
+
+#ifndef ST_NOSYMFOLLOW
+#define ST_NOSYMFOLLOW		0x2000
+#endif
+
+/* flags of statvfs(3) which change along with the options of a mount */
+#define MNT_ST_FLAGS \
+	(ST_RDONLY | ST_NOSUID | ST_NODEV | ST_NOEXEC | ST_SYNCHRONOUS | \
+	ST_NOATIME | ST_NODIRATIME | ST_RELATIME | ST_NOSYMFOLLOW)
+
+/* listmount(2) from the root of our mount namespace */
+#define MNT_LIST_ROOT		UINT64_MAX
+
+/* number of mount identifiers asked for per listmount(2) call */
+#define MNT_LIST_BATCH		512
+
+/* what is asked to statmount(2): enough to build a line of /proc/mounts */
+#define MNT_STAT_SB_BASIC	0x0001
+#define MNT_STAT_MNT_BASIC	0x0002
+#define MNT_STAT_MNT_POINT	0x0010
+#define MNT_STAT_FS_TYPE	0x0020
+#define MNT_STAT_MNT_OPTS	0x0080
+#define MNT_STAT_FS_SUBTYPE	0x0100
+#define MNT_STAT_SB_SOURCE	0x0200
+#define MNT_STAT_WANTED \
+	(MNT_STAT_SB_BASIC | MNT_STAT_MNT_BASIC | \
+	MNT_STAT_MNT_POINT | MNT_STAT_FS_TYPE | MNT_STAT_MNT_OPTS | \
+	MNT_STAT_FS_SUBTYPE | MNT_STAT_SB_SOURCE)
+
+/* request of listmount(2) and statmount(2) */
+struct mnt_req {
+	uint32_t size;		/* size of the request */
+	uint32_t spare;
+	uint64_t mnt_id;	/* mount to look at */
+	uint64_t param;		/* what to tell, or where to list from */
+};
+
+/* answer of statmount(2), which strings are offsets into str */
+struct mnt_stat {
+	uint32_t size;
+	uint32_t mnt_opts;	/* super block options */
+	uint64_t mask;		/* what was told */
+	uint32_t sb_dev_major;
+	uint32_t sb_dev_minor;
+	uint64_t sb_magic;
+	uint32_t sb_flags;	/* SB_RDONLY, SB_SYNCHRONOUS... */
+	uint32_t fs_type;
+	uint64_t mnt_id;
+	uint64_t mnt_parent_id;
+	uint32_t mnt_id_old;
+	uint32_t mnt_parent_id_old;
+	uint64_t mnt_attr;	/* MOUNT_ATTR_RDONLY, MOUNT_ATTR_NOSUID... */
+	uint64_t mnt_propagation;
+	uint64_t mnt_peer_group;
+	uint64_t mnt_master;
+	uint64_t propagate_from;
+	uint32_t mnt_root;
+	uint32_t mnt_point;
+	uint64_t mnt_ns_id;
+	uint32_t fs_subtype;
+	uint32_t sb_source;
+	unsigned char spare[384]; /* the fixed part is 512 bytes long */
+	char str[];
+};
+
+/* mount of the cache, when following mount notifications */
+struct mnt_ref {
+	uint64_t id;		/* mount identifier */
+	unsigned long flags;	/* flags statvfs(3) is expected to tell */
+};
+
+/* mount notification */
+struct mnt_event {
+	struct fanotify_event_info_header hdr;
+	uint64_t mnt_id;	/* mount attached or detached */
+};
+
+/* mount table taken out of the cache, to carry what was learnt over */
+struct cache_old {
+	struct strtab **tabs;
+	struct mntent *ents;
+	unsigned long *usec;
+	size_t nents;
+};
+
+/* static function declaration */
+static char *mtab_field(char **line);
+static size_t read_mtab(const char *path, struct strtab **tab,
+    struct mntent **ents);
+static void store_entry(struct list *lst, struct fsmntinfo *fmi,
+    const struct mntent *entbuf, struct strtab *tab,
+    const struct statvfs *vfsbuf, uint64_t dev);
+static int skip_trigger(struct list *lst, struct fsmntinfo *fmi,
+    const struct mntent *ents, size_t nents, size_t i, struct strtab *tab);
+static int cache_valid(const char *watched);
+static void cache_clear(void);
+static void cache_save(struct cache_old *old);
+static void cache_keep(struct cache_old *old);
+static const char *cache_path(const char *dir);
+static int cache_wanted(size_t i);
+static void cache_load(const char *table, char *const paths[], int npaths);
+static void cache_select(char *const paths[], int npaths);
+static struct mnt_stat *mount_stat(uint64_t id);
+static size_t cache_find(uint64_t id, int *found);
+static struct strtab *mount_entry(const struct mnt_stat *sm,
+    struct mntent *ent, unsigned long *flags);
+static int cache_attach(uint64_t id);
+static void cache_check(size_t i, unsigned long flag);
+static void cache_detach(uint64_t id);
+static int cache_list(void);
+static int cache_events(void);
+static void cache_subscribe(char *const paths[], int npaths);
+static void cache_follow(char *const paths[], int npaths);
+static int cache_stat(size_t i, struct statvfs *vfsbuf, uint64_t *dev);
+static void cache_fetch(struct list *lst);
+static void classify_magic(size_t i);
+static int stat_at(int dirfd, const char *path, struct statvfs *vfsbuf,
+    uint64_t *dev);
+static unsigned long elapsed_usec(const struct timespec *start);
+static void stat_failed(size_t i, int err);
+static enum lane_id entry_lane(size_t i);
+static void fetch_fast(size_t i, struct stat_res *res);
+static void fetch_slow(struct list *lst, struct fsmntinfo *fmi,
+    struct lane_job *job, size_t i, const struct timespec *deadline);
+static void store_res(struct list *lst, struct fsmntinfo *fmi, size_t i,
+    const struct stat_res *res);
+static struct lane_job *lane_queue(size_t i);
+static void lane_unlink(struct lane_job *job);
+static void lane_free(struct lane_job *job);
+static void lane_run(struct lane_job *job);
+static void *lane_worker(void *arg);
+static int lane_wait(struct lane_job *job, const struct timespec *deadline);
+
+/*
+ * Mount table read by fetch_info or fetch_info_root. When sampling repeatedly
+ * (--watch), it is kept as long as it does not change, so that a sample only
+ * costs a statvfs(3) per file system. No mount point is kept open in between:
+ * it would be busy and could not be unmounted. When the kernel tells about
+ * mounts being attached and detached, the entries of our own mount table are
+ * built from their identifiers and added or removed one by one instead.
+ */
+static struct {
+	int pollfd;		/* mount table polled for changes, -1 if none */
+	int evfd;		/* mount notifications, -1 if none */
+	int rootfd;		/* where mount points are relative to */
+	struct strtab **tabs;	/* strings which each entry points into */
+	struct mntent *ents;	/* entries of the mount table */
+	size_t nents;		/* number of entries */
+	size_t cap;		/* room for entries, with evfd */
+	struct mnt_ref *mnts;	/* mounts, by ascending identifier, with evfd */
+	unsigned long *usec;	/* time the last stat of each one took */
+	unsigned char *selected; /* mount points of the paths asked for */
+	int ret;		/* -1 if a path could not be resolved */
+} cache = { -1, -1, AT_FDCWD, NULL, NULL, 0, 0, NULL, NULL, NULL, 0 };
 
 int
 is_mnt_ignore(const struct fsmntinfo *fs)
 {
+	struct fsclass cls;
+
 	/* if the size is zero, it is most likely a fs that we want to ignore */
 	if (fs->blocks == 0)
 		return 1;
 
-	/* treat tmpfs/devtmpfs/... as a special case */
-	if (fs->fstype && strstr(fs->fstype, "tmpfs"))
+	cls = fsclass_get(fs->fstype);
+
+	/* treat tmpfs/devtmpfs/... as a special case, unless configured */
+	if (cls.source != FSCLASS_CONFIG && strstr(cls.name, "tmpfs"))
 		return 0;
 
-	return is_pseudofs(fs->fstype);
+	return (cls.flags & FSCLASS_PSEUDO) != 0;
 }
 
 int
@@ -75,107 +333,1382 @@ is_remote(const struct fsmntinfo *fs)
 	return is_remotefs(fs->fstype);
 }
 
-void
-fetch_info(struct list *lst)
+/*
+ * Split the next field off a line of a mount table, in place: spaces, tabs,
+ * new lines and backslashes are escaped as octal sequences (such as "\040"),
+ * which are decoded.
+ * Return the field, NULL if there is none left.
+ * @line: line to split, set to what follows the field
+ */
+static char *
+mtab_field(char **line)
 {
-	struct fsmntinfo *fmi;
-	FILE *mtab;
-	struct mntent *entbuf;
+	char *s = *line, *field, *p;
+
+	while (*s == ' ' || *s == '\t')
+		s++;
+	if (*s == '\0')
+		return NULL;
+
+	for (field = p = s; *s != '\0' && *s != ' ' && *s != '\t'; s++) {
+		if (s[0] == '\\' && s[1] >= '0' && s[1] <= '3' &&
+		    s[2] >= '0' && s[2] <= '7' && s[3] >= '0' && s[3] <= '7') {
+			*p++ = (char)((s[1] - '0') << 6 | (s[2] - '0') << 3 |
+				(s[3] - '0'));
+			s += 3;
+		} else {
+			*p++ = *s;
+		}
+	}
+	*line = *s != '\0' ? s + 1 : s;
+	*p = '\0';
+
+	return field;
+}
+
+/*
+ * Read a whole mount table into a single buffer and split it into entries,
+ * which point into it: names, mount points and options are never copied
+ * Return the number of entries.
+ * @path: mount table to read
+ * @tab: set to the buffer holding the mount table
+ * @ents: set to the array of entries
+ */
+static size_t
+read_mtab(const char *path, struct strtab **tab, struct mntent **ents)
+{
+	static char none[] = "";
+	struct strtab *t, *tmp;
+	struct mntent *ent;
+	char *line, *next;
+	size_t len = 0, n = 0, cap = 0;
+	ssize_t nread;
+	int fd;
+
+	*ents = NULL;
+
+	/* open mtab file */
+	if ((fd = open(path, O_RDONLY | O_CLOEXEC)) == -1) {
+		(void)fprintf(stderr, "Error while opening mtab file %s",
+			path);
+		perror(" ");
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+
+	/* files of /proc have no size: read until the end */
+	if ((t = strtab_new(16384)) == NULL)
+		goto nomem;
+	for (;;) {
+		if (len == t->len - 1) {
+			if ((tmp = realloc(t, sizeof(*t) + t->len * 2)) == NULL)
+				goto nomem;
+			t = tmp;
+			t->len *= 2;
+		}
+		nread = read(fd, t->buf + len, t->len - 1 - len);
+		if (nread == -1 && errno == EINTR)
+			continue;
+		if (nread <= 0)
+			break;
+		len += (size_t)nread;
+	}
+	if (nread == -1) {
+		(void)fprintf(stderr, "Error while reading mtab file %s",
+			path);
+		perror(" ");
+	}
+	t->buf[len] = '\0';
+
+	/* we need to close the mtab file now */
+	if (close(fd) == -1)
+		perror("Could not close mtab file ");
+
+	for (line = t->buf; *line != '\0'; line = next) {
+		if ((next = strchr(line, '\n')) != NULL)
+			*next++ = '\0';
+		else
+			next = line + strlen(line);
+
+		if (n == cap) {
+			cap = cap ? cap * 2 : 64;
+			if ((ent = realloc(*ents, cap * sizeof(*ent))) == NULL)
+				goto nomem;
+			*ents = ent;
+		}
+		ent = &(*ents)[n];
+
+		/*
+		 * skip empty lines and comments, missing fields are empty, as
+		 * with getmntent(3)
+		 */
+		ent->mnt_fsname = mtab_field(&line);
+		if (ent->mnt_fsname == NULL || ent->mnt_fsname[0] == '#')
+			continue;
+		if ((ent->mnt_dir = mtab_field(&line)) == NULL)
+			ent->mnt_dir = none;
+		if ((ent->mnt_type = mtab_field(&line)) == NULL)
+			ent->mnt_type = none;
+		if ((ent->mnt_opts = mtab_field(&line)) == NULL)
+			ent->mnt_opts = none;
+		ent->mnt_freq = 0;
+		ent->mnt_passno = 0;
+		n++;
+	}
+
+	*tab = t;
+
+	return n;
+
+nomem:
+	(void)fputs("Error while allocating memory to read mtab", stderr);
+	exit(EXIT_FAILURE);
+	/* NOTREACHED */
+}
+
+/*
+ * Store a stated entry of the mount table into the queue
+ * @lst: queue in which to store information
+ * @fmi: fsmntinfo to fill
+ * @entbuf: entry of the mount table
+ * @tab: strings the entry points into
+ * @vfsbuf: statistics of the file system
+ * @dev: device of the file system, 0 if unknown
+ */
+static void
+store_entry(struct list *lst, struct fsmntinfo *fmi,
+    const struct mntent *entbuf, struct strtab *tab,
+    const struct statvfs *vfsbuf, uint64_t dev)
+{
+	/* infos from getmntent, which point into the cached mount table */
+	fmi->fsname = entbuf->mnt_fsname;
+	fmi->mntdir = entbuf->mnt_dir;
+	fmi->fstype = entbuf->mnt_type;
+	fmi->mntopts = entbuf->mnt_opts;
+	fmi->strtab = strtab_ref(tab);
+
+	/* infos from statvfs */
+	fmi->bsize    = vfsbuf->f_bsize;
+	fmi->frsize   = vfsbuf->f_frsize;
+	fmi->blocks   = vfsbuf->f_blocks;
+	fmi->bfree    = vfsbuf->f_bfree;
+	fmi->bavail   = vfsbuf->f_bavail;
+	fmi->files    = vfsbuf->f_files;
+	fmi->ffree    = vfsbuf->f_ffree;
+	fmi->favail   = vfsbuf->f_favail;
+	fmi->dev      = dev;
+
+	/* compute, available, % used, etc. */
+	compute_fs_stats(fmi);
+
+	/* pointer to the next element */
+	fmi->next = NULL;
+
+	/* enqueue the element into the queue */
+	enqueue(lst, *fmi);
+}
+
+/*
+ * Handle an autofs trigger point without stating it, as it would mount it.
+ * Whether something is mounted on it is told by the mount table: if so, the
+ * file system is the one of a following entry, otherwise the trigger is
+ * stored as not mounted, without sizes.
+ * Return 1 if the entry is a trigger point, which must not be stated, 0
+ * otherwise.
+ * @lst: queue in which to store information
+ * @fmi: fsmntinfo to fill
+ * @ents: entries of the mount table
+ * @nents: number of entries
+ * @i: entry to look at
+ * @tab: strings the entry points into
+ */
+static int
+skip_trigger(struct list *lst, struct fsmntinfo *fmi,
+    const struct mntent *ents, size_t nents, size_t i, struct strtab *tab)
+{
+	static char unmounted_str[] = "not mounted";
+	struct mntent trigger;
 	struct statvfs vfsbuf;
+	size_t j;
+
+	if (automountflag || strcmp(ents[i].mnt_type, "autofs") != 0)
+		return 0;
+
+	for (j = i + 1; j < nents; j++)
+		if (strcmp(ents[j].mnt_dir, ents[i].mnt_dir) == 0)
+			return 1;
+
+	trigger = ents[i];
+	trigger.mnt_opts = unmounted_str;
+	(void)memset(&vfsbuf, 0, sizeof(vfsbuf));
+	store_entry(lst, fmi, &trigger, tab, &vfsbuf, 0);
+
+	return 1;
+}
+
+/*
+ * Tell whether the cached mount table can still be used, that is when
+ * sampling repeatedly and the watched mount table did not change since it
+ * was read: the kernel flags /proc mount tables with POLLPRI on changes.
+ * Return 1 if it can, 0 otherwise.
+ * @watched: mount table to poll
+ */
+static int
+cache_valid(const char *watched)
+{
+	struct pollfd pfd;
+
+	if (!watchflag)
+		return 0;
+
+	/* first sample: watch from now on, before reading the table */
+	if (cache.pollfd == -1) {
+		cache.pollfd = open(watched, O_RDONLY);
+		return 0;
+	}
+
+	pfd.fd = cache.pollfd;
+	pfd.events = POLLPRI;
+	pfd.revents = 0;
+	if (poll(&pfd, 1, 0) == -1)
+		return 0;
+
+	return !(pfd.revents & (POLLPRI | POLLERR));
+}
+
+/*
+ * Release the mount table of the cache
+ */
+static void
+cache_clear(void)
+{
+	size_t i;
+
+	for (i = 0; i < cache.nents; i++)
+		if (cache.tabs != NULL)
+			strtab_unref(cache.tabs[i]);
+	free(cache.tabs);
+	free(cache.ents);
+	free(cache.mnts);
+	free(cache.usec);
+	free(cache.selected);
+	cache.tabs = NULL;
+	cache.ents = NULL;
+	cache.nents = 0;
+	cache.cap = 0;
+	cache.mnts = NULL;
+	cache.usec = NULL;
+	cache.selected = NULL;
+	cache.ret = 0;
+}
+
+/*
+ * Take the mount table out of the cache, which is then cleared, before it is
+ * replaced (see cache_keep)
+ * @old: set to the mount table
+ */
+static void
+cache_save(struct cache_old *old)
+{
+	old->tabs = cache.tabs;
+	old->ents = cache.ents;
+	old->usec = cache.usec;
+	old->nents = cache.nents;
+	cache.tabs = NULL;
+	cache.ents = NULL;
+	cache.usec = NULL;
+	cache.nents = 0;
+	cache_clear();
+}
+
+/*
+ * Carry the time the last stat of each mount point took over to the new mount
+ * table of the cache, so that the slow ones stay on the slow lane, and free
+ * the previous one
+ * @old: previous mount table (see cache_save)
+ */
+static void
+cache_keep(struct cache_old *old)
+{
+	size_t i, j = 0, k;
+
+	for (i = 0; i < cache.nents && old->nents > 0; i++) {
+		/* mount tables mostly keep their order */
+		for (k = 0; k < old->nents; k++) {
+			if (strcmp(old->ents[j].mnt_dir,
+			    cache.ents[i].mnt_dir) == 0)
+				break;
+			j = (j + 1) % old->nents;
+		}
+		if (k == old->nents)
+			continue;
+		cache.usec[i] = old->usec[j];
+		j = (j + 1) % old->nents;
+	}
+
+	for (i = 0; i < old->nents; i++)
+		strtab_unref(old->tabs[i]);
+	free(old->tabs);
+	free(old->ents);
+	free(old->usec);
+}
+
+/*
+ * Return the path of a mount point relative to the root of the cache
+ * @dir: mount point
+ */
+static const char *
+cache_path(const char *dir)
+{
+	if (cache.rootfd == AT_FDCWD)
+		return dir;
+	while (*dir == '/')
+		dir++;
+
+	return *dir == '\0' ? "." : dir;
+}
+
+/*
+ * Tell whether a mount point is to be stated
+ * Return 1 if it is, 0 otherwise.
+ * @i: entry of the mount table of the cache
+ */
+static int
+cache_wanted(size_t i)
+{
+	if (cache.selected && !cache.selected[i])
+		return 0;
+	/* stating an autofs trigger point mounts it */
+	if (!automountflag && strcmp(cache.ents[i].mnt_type, "autofs") == 0)
+		return 0;
+	/* avoid stating remote fs because they may hang */
+	if (lflag && is_remotefs(cache.ents[i].mnt_type))
+		return 0;
+	/* --where may not need the statistics to tell */
+	if (!where_match_mount(cache.ents[i].mnt_fsname, cache.ents[i].mnt_type,
+	    cache.ents[i].mnt_dir, cache.ents[i].mnt_opts))
+		return 0;
+
+	return 1;
+}
+
+/*
+ * Read a mount table into the cache and select the mount points of the given
+ * paths
+ * @table: mount table to read
+ * @paths: paths which file systems to show, all of them if npaths is 0
+ * @npaths: number of paths
+ */
+static void
+cache_load(const char *table, char *const paths[], int npaths)
+{
+	struct cache_old old;
+	struct strtab *tab;
+	size_t i;
+
+	cache_save(&old);
+	cache.nents = read_mtab(table, &tab, &cache.ents);
+
+	cache.tabs = malloc((cache.nents + 1) * sizeof(*cache.tabs));
+	cache.usec = calloc(cache.nents + 1, sizeof(*cache.usec));
+	if (cache.tabs == NULL || cache.usec == NULL) {
+		(void)fputs("Error while allocating memory to read mtab",
+			stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	for (i = 0; i < cache.nents; i++)
+		cache.tabs[i] = strtab_ref(tab);
+	strtab_unref(tab);
+	cache_keep(&old);
+
+	cache_select(paths, npaths);
+}
+
+/*
+ * Select the mount points of the given paths in the cache: only those are
+ * stated
+ * @paths: paths which file systems to show, all of them if npaths is 0
+ * @npaths: number of paths
+ */
+static void
+cache_select(char *const paths[], int npaths)
+{
+	const char **dirs;
+	size_t i;
+
+	free(cache.selected);
+	cache.selected = NULL;
+	if (npaths == 0)
+		return;
+
+	dirs = malloc((cache.nents + 1) * sizeof(*dirs));
+	cache.selected = calloc(cache.nents + 1, sizeof(*cache.selected));
+	if (dirs == NULL || cache.selected == NULL) {
+		(void)fputs("Error while allocating memory to read mtab",
+			stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	for (i = 0; i < cache.nents; i++)
+		dirs[i] = cache.ents[i].mnt_dir;
+	cache.ret = select_mounts(dirs, cache.nents, paths, npaths,
+		cache.selected);
+	free(dirs);
+}
+
+/*
+ * Tell about a mount by its identifier
+ * Return the answer of statmount(2), to be freed, or NULL if the mount cannot
+ * be looked at (errno is ENOTSUP when the kernel cannot tell enough).
+ * @id: mount identifier
+ */
+static struct mnt_stat *
+mount_stat(uint64_t id)
+{
+	struct mnt_req req;
+	struct mnt_stat *sm = NULL, *tmp;
+	size_t size = 4096;
+	uint64_t needed = MNT_STAT_SB_BASIC | MNT_STAT_MNT_BASIC |
+		MNT_STAT_MNT_POINT | MNT_STAT_FS_TYPE;
+
+	(void)memset(&req, 0, sizeof(req));
+	req.size = sizeof(req);
+	req.mnt_id = id;
+	req.param = MNT_STAT_WANTED;
+
+	for (;;) {
+		if ((tmp = realloc(sm, size)) == NULL) {
+			(void)fputs("Error while allocating memory to read "
+				"mtab", stderr);
+			exit(EXIT_FAILURE);
+			/* NOTREACHED */
+		}
+		sm = tmp;
+		if (syscall(__NR_statmount, &req, sm, size, 0) == 0)
+			break;
+		/* the strings did not fit */
+		if (errno != EOVERFLOW || size >= 1024 * 1024) {
+			free(sm);
+			return NULL;
+		}
+		size *= 2;
+	}
+
+	/* empty strings may not be told */
+	if ((sm->mask & needed) != needed) {
+		free(sm);
+		errno = ENOTSUP;
+		return NULL;
+	}
+
+	return sm;
+}
+
+/*
+ * Look for a mount in the cache, which identifiers are ascending
+ * Return where it is or else where it would go.
+ * @id: mount identifier
+ * @found: set to 1 if the mount is in the cache, 0 otherwise
+ */
+static size_t
+cache_find(uint64_t id, int *found)
+{
+	size_t lo = 0, hi = cache.nents, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (cache.mnts[mid].id < id)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	*found = lo < cache.nents && cache.mnts[lo].id == id;
+
+	return lo;
+}
+
+/*
+ * Build the entry of a mount as it would read in /proc/mounts: its options are
+ * the ones of the mount, then the ones of its super block
+ * Return the strings the entry points into.
+ * @sm: answer of statmount(2) about the mount
+ * @ent: entry to fill
+ * @flags: set to the flags statvfs(3) tells about the mount
+ */
+static struct strtab *
+mount_entry(const struct mnt_stat *sm, struct mntent *ent,
+    unsigned long *flags)
+{
+	/* see show_sb_opts and show_mnt_opts in fs/proc_namespace.c */
+	static const struct {
+		int sb;		/* 1 for a flag of the super block */
+		uint64_t mask;
+		uint64_t value;
+		unsigned long st; /* matching flag of statvfs(3) */
+		const char *name;
+	} opts[] = {
+		{ 1, 0x00000010, 0x00000010, ST_SYNCHRONOUS, ",sync" },
+		{ 1, 0x00000080, 0x00000080, 0, ",dirsync" },
+		{ 1, 0x02000000, 0x02000000, 0, ",lazytime" },
+		{ 0, 0x00000002, 0x00000002, ST_NOSUID, ",nosuid" },
+		{ 0, 0x00000004, 0x00000004, ST_NODEV, ",nodev" },
+		{ 0, 0x00000008, 0x00000008, ST_NOEXEC, ",noexec" },
+		{ 0, 0x00000070, 0x00000010, ST_NOATIME, ",noatime" },
+		{ 0, 0x00000080, 0x00000080, ST_NODIRATIME, ",nodiratime" },
+		{ 0, 0x00000070, 0x00000000, ST_RELATIME, ",relatime" },
+		{ 0, 0x00200000, 0x00200000, ST_NOSYMFOLLOW, ",nosymfollow" },
+		{ 0, 0x00100000, 0x00100000, 0, ",idmapped" }
+	};
+	char vfsopts[128];
+	const char *src, *dir, *type, *sub, *sbopts;
+	struct strtab *tab;
+	uint64_t bits;
+	size_t j;
+	char *p;
+
+	/* read-only if either the mount or the super block is */
+	*flags = 0;
+	if ((sm->sb_flags & 0x1) || (sm->mnt_attr & 0x1)) {
+		(void)strcpy(vfsopts, "ro");
+		*flags |= ST_RDONLY;
+	} else {
+		(void)strcpy(vfsopts, "rw");
+	}
+	for (j = 0; j < sizeof(opts) / sizeof(opts[0]); j++) {
+		bits = opts[j].sb ? sm->sb_flags : sm->mnt_attr;
+		if ((bits & opts[j].mask) == opts[j].value) {
+			(void)strcat(vfsopts, opts[j].name);
+			*flags |= opts[j].st;
+		}
+	}
+	src = sm->mask & MNT_STAT_SB_SOURCE ? sm->str + sm->sb_source : "none";
+	dir = sm->str + sm->mnt_point;
+	type = sm->str + sm->fs_type;
+	sub = sm->mask & MNT_STAT_FS_SUBTYPE ? sm->str + sm->fs_subtype : "";
+	sbopts = sm->mask & MNT_STAT_MNT_OPTS ? sm->str + sm->mnt_opts : "";
+
+	if ((tab = strtab_new(strlen(src) + strlen(dir) + strlen(type) +
+	    strlen(sub) + strlen(vfsopts) + strlen(sbopts) + 6)) == NULL) {
+		(void)fputs("Error while allocating memory to read mtab",
+			stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+
+	/* the type includes the subtype, such as fuse.sshfs */
+	p = tab->buf;
+	ent->mnt_fsname = p;
+	p = stpcpy(p, src) + 1;
+	ent->mnt_dir = p;
+	p = stpcpy(p, dir) + 1;
+	ent->mnt_type = p;
+	p = stpcpy(p, type);
+	if (*sub != '\0') {
+		*p++ = '.';
+		p = stpcpy(p, sub);
+	}
+	ent->mnt_opts = ++p;
+	p = stpcpy(p, vfsopts);
+	if (*sbopts != '\0') {
+		*p++ = ',';
+		(void)strcpy(p, sbopts);
+	}
+	ent->mnt_freq = 0;
+	ent->mnt_passno = 0;
+
+	return tab;
+}
+
+/*
+ * Add a mount to the cache
+ * Return -1 if the kernel cannot tell enough about mounts, 0 otherwise (a
+ * mount which is already known, or already gone, is not added).
+ * @id: mount identifier
+ */
+static int
+cache_attach(uint64_t id)
+{
+	struct mnt_stat *sm;
+	size_t pos, n;
+	void *tmp;
+	int found;
+
+	pos = cache_find(id, &found);
+	if (found)
+		return 0;
+	if ((sm = mount_stat(id)) == NULL)
+		return errno == ENOTSUP ? -1 : 0;
+	/* not reachable from our root directory */
+	if (sm->str[sm->mnt_point] == '\0') {
+		free(sm);
+		return 0;
+	}
+
+	/* make room for the entry */
+	if (cache.nents + 1 >= cache.cap) {
+		cache.cap = cache.cap * 2 + 16;
+		if ((tmp = realloc(cache.ents,
+		    cache.cap * sizeof(*cache.ents))) == NULL)
+			goto nomem;
+		cache.ents = tmp;
+		if ((tmp = realloc(cache.tabs,
+		    cache.cap * sizeof(*cache.tabs))) == NULL)
+			goto nomem;
+		cache.tabs = tmp;
+		if ((tmp = realloc(cache.mnts,
+		    cache.cap * sizeof(*cache.mnts))) == NULL)
+			goto nomem;
+		cache.mnts = tmp;
+		if ((tmp = realloc(cache.usec,
+		    cache.cap * sizeof(*cache.usec))) == NULL)
+			goto nomem;
+		cache.usec = tmp;
+	}
+	n = cache.nents - pos;
+	(void)memmove(&cache.ents[pos + 1], &cache.ents[pos],
+		n * sizeof(*cache.ents));
+	(void)memmove(&cache.tabs[pos + 1], &cache.tabs[pos],
+		n * sizeof(*cache.tabs));
+	(void)memmove(&cache.mnts[pos + 1], &cache.mnts[pos],
+		n * sizeof(*cache.mnts));
+	(void)memmove(&cache.usec[pos + 1], &cache.usec[pos],
+		n * sizeof(*cache.usec));
+	cache.nents++;
+
+	cache.tabs[pos] = mount_entry(sm, &cache.ents[pos],
+		&cache.mnts[pos].flags);
+	cache.mnts[pos].id = id;
+	cache.usec[pos] = 0;
+	free(sm);
+
+	return 0;
+
+nomem:
+	(void)fputs("Error while allocating memory to read mtab", stderr);
+	exit(EXIT_FAILURE);
+	/* NOTREACHED */
+}
+
+/*
+ * Build the entry of a mount of the cache again when what statvfs(3) tells
+ * about it shows it was remounted, which is not notified
+ * @i: entry of the mount table of the cache
+ * @flag: flags told by statvfs(3)
+ */
+static void
+cache_check(size_t i, unsigned long flag)
+{
+	struct mnt_stat *sm;
+
+	if (cache.mnts == NULL ||
+	    (flag & MNT_ST_FLAGS) == cache.mnts[i].flags)
+		return;
+	if ((sm = mount_stat(cache.mnts[i].id)) == NULL)
+		return;
+
+	strtab_unref(cache.tabs[i]);
+	cache.tabs[i] = mount_entry(sm, &cache.ents[i], &cache.mnts[i].flags);
+	free(sm);
+}
+
+/*
+ * Remove a mount from the cache, if it is there
+ * @id: mount identifier
+ */
+static void
+cache_detach(uint64_t id)
+{
+	size_t pos, n;
+	int found;
+
+	pos = cache_find(id, &found);
+	if (!found)
+		return;
+
+	strtab_unref(cache.tabs[pos]);
+
+	n = cache.nents - pos - 1;
+	(void)memmove(&cache.ents[pos], &cache.ents[pos + 1],
+		n * sizeof(*cache.ents));
+	(void)memmove(&cache.tabs[pos], &cache.tabs[pos + 1],
+		n * sizeof(*cache.tabs));
+	(void)memmove(&cache.mnts[pos], &cache.mnts[pos + 1],
+		n * sizeof(*cache.mnts));
+	(void)memmove(&cache.usec[pos], &cache.usec[pos + 1],
+		n * sizeof(*cache.usec));
+	cache.nents--;
+}
+
+/*
+ * Fill the cache with the mounts of our mount namespace, listed by their
+ * identifiers: they come in the order of /proc/mounts
+ * Return -1 if the kernel cannot list or tell about mounts, 0 otherwise.
+ */
+static int
+cache_list(void)
+{
+	struct cache_old old;
+	struct mnt_req req;
+	uint64_t ids[MNT_LIST_BATCH];
+	long n, i;
+	int ret = 0;
+
+	cache_save(&old);
+
+	(void)memset(&req, 0, sizeof(req));
+	req.size = sizeof(req);
+	req.mnt_id = MNT_LIST_ROOT;
+	do {
+		if ((n = syscall(__NR_listmount, &req, ids, MNT_LIST_BATCH,
+		    0)) == -1) {
+			ret = -1;
+			break;
+		}
+		for (i = 0; i < n && ret == 0; i++)
+			ret = cache_attach(ids[i]);
+		/* carry on after the last one */
+		if (n > 0)
+			req.param = ids[n - 1];
+	} while (ret == 0 && n == MNT_LIST_BATCH);
+
+	cache_keep(&old);
+
+	return ret;
+}
+
+/*
+ * Apply the pending mount notifications to the cache
+ * Return the number of mounts attached or detached, -1 if notifications were
+ * lost.
+ */
+static int
+cache_events(void)
+{
+	union {
+		struct fanotify_event_metadata meta;
+		char buf[4096];
+	} u;
+	struct fanotify_event_metadata *meta;
+	const struct mnt_event *ev;
+	ssize_t len;
+	size_t off;
+	int n = 0;
+
+	while ((len = read(cache.evfd, u.buf, sizeof(u.buf))) > 0) {
+		for (meta = &u.meta; FAN_EVENT_OK(meta, len);
+		    meta = FAN_EVENT_NEXT(meta, len)) {
+			if (meta->mask & FAN_Q_OVERFLOW)
+				return -1;
+			for (off = meta->metadata_len;
+			    off + sizeof(*ev) <= meta->event_len;
+			    off += ev->hdr.len) {
+				ev = (const struct mnt_event *)(void *)
+					((char *)meta + off);
+				if (ev->hdr.len == 0)
+					break;
+				if (ev->hdr.info_type !=
+				    FAN_EVENT_INFO_TYPE_MNT)
+					continue;
+				if (meta->mask & FAN_MNT_ATTACH)
+					(void)cache_attach(ev->mnt_id);
+				else if (meta->mask & FAN_MNT_DETACH)
+					cache_detach(ev->mnt_id);
+				n++;
+			}
+		}
+	}
+
+	return len == -1 && errno != EAGAIN ? -1 : n;
+}
+
+/*
+ * Subscribe to the mounts being attached to and detached from our mount
+ * namespace and fill the cache with its mounts. Nothing is left behind when
+ * the kernel cannot tell (before Linux 6.14, or without the privileges to).
+ * @paths: paths which file systems to show, all of them if npaths is 0
+ * @npaths: number of paths
+ */
+static void
+cache_subscribe(char *const paths[], int npaths)
+{
+	int nsfd = -1;
+
+	if ((cache.evfd = fanotify_init(FAN_REPORT_MNT | FAN_CLOEXEC |
+	    FAN_NONBLOCK, O_RDONLY)) == -1)
+		return;
+
+	/* notified first, then listed: no mount can be missed */
+	if ((nsfd = open("/proc/self/ns/mnt", O_RDONLY | O_CLOEXEC)) == -1 ||
+	    fanotify_mark(cache.evfd, FAN_MARK_ADD | FAN_MARK_MNTNS,
+	    FAN_MNT_ATTACH | FAN_MNT_DETACH, nsfd, NULL) == -1 ||
+	    (cache.pollfd = open("/proc/self/mounts", O_RDONLY |
+	    O_CLOEXEC)) == -1 ||
+	    cache_list() == -1) {
+		cache_clear();
+		(void)close(cache.evfd);
+		cache.evfd = -1;
+		if (cache.pollfd != -1)
+			(void)close(cache.pollfd);
+		cache.pollfd = -1;
+	}
+	if (nsfd != -1)
+		(void)close(nsfd);
+	if (cache.evfd == -1)
+		return;
+
+	cache_select(paths, npaths);
+}
+
+/*
+ * Bring the cache up to date with the mount notifications received since the
+ * previous sample: mounts are added or removed one by one. Other changes of
+ * the mount table, such as remounts, are not notified: the mounts are listed
+ * again when the mount table changed without a notification, or when some
+ * were lost.
+ * @paths: paths which file systems to show, all of them if npaths is 0
+ * @npaths: number of paths
+ */
+static void
+cache_follow(char *const paths[], int npaths)
+{
+	if (cache_valid("/proc/self/mounts"))
+		return;
+
+	if (cache_events() <= 0 && cache_list() == -1) {
+		/* back to reading the mount table */
+		(void)close(cache.evfd);
+		cache.evfd = -1;
+		cache_load("/etc/mtab", paths, npaths);
+		return;
+	}
+
+	cache_select(paths, npaths);
+}
+
+/*
+ * Get the statistics of a file system of the cache
+ * Return -1 on error (errno is set), 0 otherwise.
+ * @i: entry of the mount table of the cache
+ * @vfsbuf: statistics of the file system
+ * @dev: set to the device of the file system, NULL not to look for it
+ */
+static int
+cache_stat(size_t i, struct statvfs *vfsbuf, uint64_t *dev)
+{
+	return stat_at(cache.rootfd, cache_path(cache.ents[i].mnt_dir), vfsbuf,
+		dev);
+}
+
+/*
+ * Store all the wanted file systems of the cache into the queue. Local file
+ * systems are stated here, in the order of the mount table, while the remote
+ * ones and the ones which were slow to state on the previous sample go to the
+ * slow lane, fed first so that both run at once. The file systems stated
+ * here never wait for the slow lane: they are displayed first when displayed
+ * as soon as stored, otherwise every file system is stored in the order of
+ * the mount table once the slow lane is done.
+ * @lst: queue in which to store information
+ */
+static void
+cache_fetch(struct list *lst)
+{
+	struct fsmntinfo *fmi;
+	struct timespec deadline;
+	struct lane_job **jobs;
+	struct stat_res *res;
+	enum lane_id *lanes;
+	size_t i;
+
 	/* init fsmntinfo */
-	if ((fmi = malloc(sizeof(struct fsmntinfo))) == NULL) {
+	if ((fmi = malloc(sizeof(struct fsmntinfo))) == NULL ||
+	    (lanes = malloc((cache.nents + 1) * sizeof(*lanes))) == NULL ||
+	    (jobs = malloc((cache.nents + 1) * sizeof(*jobs))) == NULL ||
+	    (res = malloc((cache.nents + 1) * sizeof(*res))) == NULL) {
 		(void)fputs("Error while allocating memory to fmi", stderr);
 		exit(EXIT_FAILURE);
 		/* NOTREACHED */
 	}
 	*fmi = fmi_init();
-	/* open mtab file */
-	if ((mtab = fopen("/etc/mtab", "r")) == NULL) {
-		perror("Error while opening mtab file ");
+
+	for (i = 0; i < cache.nents; i++) {
+		lanes[i] = entry_lane(i);
+		if (lanes[i] == LANE_SLOW && (jobs[i] = lane_queue(i)) == NULL) {
+			lanes[i] = LANE_NONE;
+			(void)fprintf(stderr, _("WARNING: %s was skipped "
+				"because it still did not answer\n"),
+				cache.ents[i].mnt_dir);
+		}
+	}
+	(void)clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += LANE_DEADLINE;
+
+	for (i = 0; i < cache.nents; i++) {
+		if (lanes[i] != LANE_FAST)
+			continue;
+		fetch_fast(i, &res[i]);
+		/* displayed as soon as stored: the slow lane comes last */
+		if (lst->stream != NULL)
+			store_res(lst, fmi, i, &res[i]);
+	}
+	for (i = 0; i < cache.nents; i++) {
+		if (lanes[i] == LANE_FAST && lst->stream == NULL)
+			store_res(lst, fmi, i, &res[i]);
+		else if (lanes[i] == LANE_SLOW)
+			fetch_slow(lst, fmi, jobs[i], i, &deadline);
+	}
+
+	free(res);
+	free(jobs);
+	free(lanes);
+	free(fmi);
+}
+
+/*
+ * Get the statistics of a file system. Its device is told through the same
+ * descriptor, so that the deleted files it holds are found without going
+ * through its mount point again (see held.c).
+ * Return -1 on error (errno is set), 0 otherwise.
+ * @dirfd: directory the path is relative to, or AT_FDCWD
+ * @path: mount point
+ * @vfsbuf: statistics of the file system
+ * @dev: set to the device of the file system, 0 if unknown, NULL not to look
+ * for it
+ */
+static int
+stat_at(int dirfd, const char *path, struct statvfs *vfsbuf, uint64_t *dev)
+{
+	struct stat st;
+	int fd, ret, err;
+
+	if (dirfd == AT_FDCWD && dev == NULL)
+		return statvfs(path, vfsbuf);
+
+	if ((fd = openat(dirfd, path, O_PATH | O_CLOEXEC)) == -1)
+		return -1;
+	ret = fstatvfs(fd, vfsbuf);
+	err = errno;
+	if (ret == 0 && dev != NULL)
+		*dev = fstat(fd, &st) == 0 ? (uint64_t)st.st_dev : 0;
+	(void)close(fd);
+	errno = err;
+
+	return ret;
+}
+
+/*
+ * Return the number of microseconds elapsed since a time
+ * @start: time, from the monotonic clock
+ */
+static unsigned long
+elapsed_usec(const struct timespec *start)
+{
+	struct timespec now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (unsigned long)(now.tv_sec - start->tv_sec) * 1000000UL +
+		(unsigned long)(now.tv_nsec / 1000) -
+		(unsigned long)(start->tv_nsec / 1000);
+}
+
+/*
+ * Warn about a file system of the cache which could not be stated, unless
+ * the reason is a lack of permissions
+ * @i: entry of the mount table of the cache
+ * @err: errno
+ */
+static void
+stat_failed(size_t i, int err)
+{
+	/* show only "real" errors, not lack of permissions */
+	if (err == EACCES)
+		return;
+
+	/* display a warning when a FS cannot be stated */
+	(void)fprintf(stderr, _("WARNING: %s was skipped because it could not "
+		"be stated"), cache.ents[i].mnt_dir);
+	errno = err;
+	perror(" ");
+}
+
+/*
+ * Return the lane an entry of the cache is to be stated on: remote file
+ * systems and the ones which were slow to state on the previous sample are
+ * isolated on the slow lane
+ * @i: entry of the mount table of the cache
+ */
+static enum lane_id
+entry_lane(size_t i)
+{
+	if (cache.selected && !cache.selected[i])
+		return LANE_NONE;
+	/* trigger points are not stated (see skip_trigger) */
+	if (!automountflag && strcmp(cache.ents[i].mnt_type, "autofs") == 0)
+		return LANE_FAST;
+	if (!cache_wanted(i))
+		return LANE_NONE;
+	if (is_remotefs(cache.ents[i].mnt_type) ||
+	    cache.usec[i] > LANE_SLOW_USEC)
+		return LANE_SLOW;
+
+	return LANE_FAST;
+}
+
+/*
+ * State a file system of the cache here
+ * @i: entry of the mount table of the cache
+ * @res: what stating it told
+ */
+static void
+fetch_fast(size_t i, struct stat_res *res)
+{
+	struct timespec start;
+
+	/* trigger points are not stated (see skip_trigger) */
+	if (!automountflag && strcmp(cache.ents[i].mnt_type, "autofs") == 0)
+		return;
+
+	/* get infos from statvfs */
+	(void)clock_gettime(CLOCK_MONOTONIC, &start);
+	res->dev = 0;
+	res->ret = cache_stat(i, &res->vfs, heldflag ? &res->dev : NULL);
+	res->err = errno;
+	res->usec = cache.usec[i] = elapsed_usec(&start);
+
+	if (res->ret == 0)
+		classify_magic(i);
+}
+
+/*
+ * Wait for a file system of the slow lane to be stated and store it into the
+ * queue, or skip it if it does not answer before the deadline
+ * @lst: queue in which to store information
+ * @fmi: fsmntinfo to fill
+ * @job: job of the file system, which is over once this returns
+ * @i: entry of the mount table of the cache
+ * @deadline: time after which the slow lane is not waited for
+ */
+static void
+fetch_slow(struct list *lst, struct fsmntinfo *fmi, struct lane_job *job,
+    size_t i, const struct timespec *deadline)
+{
+	if (lane_wait(job, deadline) == -1) {
+		cache.usec[i] = LANE_DEADLINE * 1000000UL;
+		(void)fprintf(stderr, _("WARNING: %s was skipped because it "
+			"did not answer within %d seconds\n"),
+			cache.ents[i].mnt_dir, LANE_DEADLINE);
+		return;
+	}
+
+	cache.usec[i] = job->res.usec;
+	store_res(lst, fmi, i, &job->res);
+	lane_free(job);
+}
+
+/*
+ * Store a stated file system of the cache into the queue
+ * @lst: queue in which to store information
+ * @fmi: fsmntinfo to fill
+ * @i: entry of the mount table of the cache
+ * @res: what stating it told
+ */
+static void
+store_res(struct list *lst, struct fsmntinfo *fmi, size_t i,
+    const struct stat_res *res)
+{
+	if (skip_trigger(lst, fmi, cache.ents, cache.nents, i, cache.tabs[i]))
+		return;
+
+	if (res->ret == -1) {
+		stat_failed(i, res->err);
+		return;
+	}
+	cache_check(i, res->vfs.f_flag);
+	store_entry(lst, fmi, &cache.ents[i], cache.tabs[i], &res->vfs,
+		res->dev);
+}
+
+/*
+ * Queue a file system of the cache on the slow lane, starting a thread when
+ * none is waiting for a job and there is room for one more
+ * Return the job, or NULL if the file system is still being stated since a
+ * previous sample.
+ * @i: entry of the mount table of the cache
+ */
+static struct lane_job *
+lane_queue(size_t i)
+{
+	struct lane_job *job, **p;
+	pthread_t thread;
+
+	if ((job = calloc(1, sizeof(*job))) == NULL ||
+	    (job->path = strdup(cache_path(cache.ents[i].mnt_dir))) == NULL) {
+		(void)fputs("Error while allocating memory to stat file "
+			"systems", stderr);
 		exit(EXIT_FAILURE);
 		/* NOTREACHED */
 	}
+	job->dirfd = cache.rootfd == AT_FDCWD ? AT_FDCWD :
+		fcntl(cache.rootfd, F_DUPFD_CLOEXEC, 0);
 
-	/* loop to get infos from all the mounted fs */
-	while ((entbuf = getmntent(mtab)) != NULL) {
-		/* avoid stating remote fs because they may hang */
-		if (lflag && is_remotefs(entbuf->mnt_type))
-			continue;
-		/* get infos from statvfs */
-		if (statvfs(entbuf->mnt_dir, &vfsbuf) == -1) {
-			/* show only "real" errors, not lack of permissions */
-			if (errno == EACCES)
-				continue;
-			/* display a warning when a FS cannot be stated */
-			(void)fprintf(stderr, _("WARNING: %s was skipped "
-				"because it could not be stated"),
-				entbuf->mnt_dir);
-			perror(" ");
+	/* the jobs of a previous sample still there were abandoned */
+	(void)pthread_mutex_lock(&lane.lock);
+	for (p = &lane.jobs; *p != NULL; p = &(*p)->next) {
+		if ((*p)->abandoned && strcmp((*p)->path, job->path) == 0) {
+			(void)pthread_mutex_unlock(&lane.lock);
+			lane_free(job);
+			return NULL;
+		}
+	}
+
+	if ((size_t)lane.nidle <= lane.nqueued &&
+	    lane.nthreads < LANE_MAXTHREADS &&
+	    pthread_create(&thread, NULL, lane_worker, NULL) == 0) {
+		(void)pthread_detach(thread);
+		lane.nthreads++;
+	}
+	if (lane.nthreads == 0) {
+		(void)pthread_mutex_unlock(&lane.lock);
+		job->here = 1;
+		return job;
+	}
+
+	*p = job;
+	lane.nqueued++;
+	(void)pthread_cond_signal(&lane.queued);
+	(void)pthread_mutex_unlock(&lane.lock);
+
+	return job;
+}
+
+/*
+ * Remove a job from the jobs of the slow lane, which lock is held
+ * @job: job
+ */
+static void
+lane_unlink(struct lane_job *job)
+{
+	struct lane_job **p;
+
+	for (p = &lane.jobs; *p != NULL; p = &(*p)->next) {
+		if (*p == job) {
+			*p = job->next;
+			break;
+		}
+	}
+}
+
+/*
+ * Free a job of the slow lane
+ * @job: job, which is not one of the jobs of the slow lane
+ */
+static void
+lane_free(struct lane_job *job)
+{
+	if (job->dirfd != AT_FDCWD && job->dirfd != -1)
+		(void)close(job->dirfd);
+	free(job->path);
+	free(job);
+}
+
+/*
+ * State the file system of a job of the slow lane
+ * @job: job, which result is set
+ */
+static void
+lane_run(struct lane_job *job)
+{
+	struct timespec start;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &start);
+	job->res.ret = stat_at(job->dirfd, job->path, &job->res.vfs,
+		heldflag ? &job->res.dev : NULL);
+	job->res.err = errno;
+	job->res.usec = elapsed_usec(&start);
+}
+
+/*
+ * Thread of the slow lane, taking its jobs in order for the whole run
+ * @arg: ignored here
+ */
+static void *
+lane_worker(void *arg)
+{
+	struct lane_job *job;
+
+	(void)arg;
+
+	(void)pthread_mutex_lock(&lane.lock);
+	for (;;) {
+		for (job = lane.jobs; job != NULL && job->running;
+		    job = job->next)
+			;
+		if (job == NULL) {
+			lane.nidle++;
+			(void)pthread_cond_wait(&lane.queued, &lane.lock);
+			lane.nidle--;
 			continue;
 		}
-		/* infos from getmntent */
-		if ((fmi->fsnameog = strdup(entbuf->mnt_fsname)) == NULL)
-			fmi->fsnameog = g_unknown_str;
-		if ((fmi->mntdirog = strdup(entbuf->mnt_dir)) == NULL)
-			fmi->mntdirog = g_unknown_str;
-		if ((fmi->fstypeog = strdup(entbuf->mnt_type)) == NULL)
-			fmi->fstypeog = g_unknown_str;
-		if (Wflag) { /* Wflag to avoid name truncation */
-			fmi->fsname = fmi->fsnameog;
-			fmi->mntdir = fmi->mntdirog;
-			fmi->fstype = fmi->fstypeog;
-		} else {
-			if ((fmi->fsname = strdup(shortenstr(
-				entbuf->mnt_fsname, STRMAXLEN))) == NULL) {
-				fmi->fsname = g_unknown_str;
-			}
-			if ((fmi->mntdir = strdup(shortenstr(
-				entbuf->mnt_dir, STRMAXLEN))) == NULL) {
-				fmi->mntdir = g_unknown_str;
-			}
-			if ((fmi->fstype = strdup(shortenstr(
-				entbuf->mnt_type, STRMAXLEN))) == NULL) {
-				fmi->fstype = g_unknown_str;
-			}
+		job->running = 1;
+		lane.nqueued--;
+		(void)pthread_mutex_unlock(&lane.lock);
+
+		lane_run(job);
+
+		(void)pthread_mutex_lock(&lane.lock);
+		lane_unlink(job);
+		job->done = 1;
+		if (job->abandoned)
+			lane_free(job);
+		else
+			(void)pthread_cond_broadcast(&lane.done);
+	}
+
+	/* NOTREACHED */
+	return NULL;
+}
+
+/*
+ * Wait for a job of the slow lane to be done, stating its file system here
+ * if no thread could be started. A job which is not done by the deadline is
+ * abandoned: it is dropped if no thread took it yet, or else freed by its
+ * thread once done.
+ * Return -1 if the deadline passed before, 0 otherwise.
+ * @job: job
+ * @deadline: time after which the job is not waited for
+ */
+static int
+lane_wait(struct lane_job *job, const struct timespec *deadline)
+{
+	int done;
+
+	if (job->here) {
+		lane_run(job);
+		return 0;
+	}
+
+	(void)pthread_mutex_lock(&lane.lock);
+	while (!job->done) {
+		if (pthread_cond_timedwait(&lane.done, &lane.lock,
+		    deadline) == ETIMEDOUT)
+			break;
+	}
+	if (!(done = job->done)) {
+		job->abandoned = 1;
+		if (!job->running) {
+			lane_unlink(job);
+			lane.nqueued--;
+			lane_free(job);
 		}
+	}
+	(void)pthread_mutex_unlock(&lane.lock);
+
+	return done ? 0 : -1;
+}
+
+/*
+ * Classify the type of a stated file system of the cache from the magic
+ * number of its super block, if it is not a well known one. This is only done
+ * until a file system of that type tells a known magic number.
+ * @i: entry of the mount table of the cache
+ */
+static void
+classify_magic(size_t i)
+{
+	const char *type = cache.ents[i].mnt_type;
+	struct statfs sfs;
+	int fd, ret;
+
+	if (fsclass_get(type).source != FSCLASS_GUESS)
+		return;
+
+	if (cache.rootfd == AT_FDCWD) {
+		ret = statfs(cache.ents[i].mnt_dir, &sfs);
+	} else {
+		if ((fd = openat(cache.rootfd,
+		    cache_path(cache.ents[i].mnt_dir),
+		    O_PATH | O_CLOEXEC)) == -1)
+			return;
+		ret = fstatfs(fd, &sfs);
+		(void)close(fd);
+	}
+	if (ret == 0)
+		fsclass_magic(type, (unsigned long)sfs.f_type);
+}
+
+int
+fetch_info(struct list *lst, char *const paths[], int npaths)
+{
+	int ret;
+
+	/* first sample: follow the mounts when the kernel tells about them */
+	if (watchflag && cache.evfd == -1 && cache.pollfd == -1)
+		cache_subscribe(paths, npaths);
+
+	if (cache.evfd != -1)
+		cache_follow(paths, npaths);
+	else if (!cache_valid("/proc/self/mounts"))
+		cache_load("/etc/mtab", paths, npaths);
+
+	cache_fetch(lst);
+	ret = cache.ret;
 
-		if ((fmi->mntopts = strdup(entbuf->mnt_opts)) == NULL)
-			fmi->mntopts = g_none_str;
+	if (!watchflag)
+		cache_clear();
 
-		/* infos from statvfs */
-		fmi->bsize    = vfsbuf.f_bsize;
-		fmi->frsize   = vfsbuf.f_frsize;
-		fmi->blocks   = vfsbuf.f_blocks;
-		fmi->bfree    = vfsbuf.f_bfree;
-		fmi->bavail   = vfsbuf.f_bavail;
-		fmi->files    = vfsbuf.f_files;
-		fmi->ffree    = vfsbuf.f_ffree;
-		fmi->favail   = vfsbuf.f_favail;
+	return ret;
+}
 
-		/* compute, available, % used, etc. */
-		compute_fs_stats(fmi);
+int
+fetch_info_root(struct list *lst, const char *prefix)
+{
+	char *table, *watched;
+	size_t len;
 
-		/* pointer to the next element */
-		fmi->next = NULL;
+	/* resolve the prefix once, mount points are opened relative to it */
+	if (cache.rootfd == AT_FDCWD &&
+	    (cache.rootfd = open(prefix, O_RDONLY | O_DIRECTORY |
+	    O_CLOEXEC)) == -1) {
+		perror(prefix);
+		cache.rootfd = AT_FDCWD;
+		return -1;
+	}
 
-		/* enqueue the element into the queue */
-		enqueue(lst, *fmi);
+	/* the mount table of the init process is the one of the host */
+	len = strlen(prefix) + sizeof("/proc/1/mountinfo");
+	if ((table = malloc(len)) == NULL || (watched = malloc(len)) == NULL) {
+		(void)fputs("Error while allocating memory to read mtab",
+			stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+	(void)snprintf(table, len, "%s/proc/1/mounts", prefix);
+	(void)snprintf(watched, len, "%s/proc/1/mountinfo", prefix);
 
-		update_maxwidth(fmi);
+	if (!cache_valid(watched))
+		cache_load(table, NULL, 0);
+
+	cache_fetch(lst);
+
+	if (!watchflag) {
+		cache_clear();
+		(void)close(cache.rootfd);
+		cache.rootfd = AT_FDCWD;
 	}
-	/* we need to close the mtab file now */
-	if (fclose(mtab) == EOF)
-		perror("Could not close mtab file ");
-	free(fmi);
+	free(table);
+	free(watched);
+
+	return 0;
 }
 
 void
 compute_fs_stats(struct fsmntinfo *fmi)
 {
-	fmi->total = (double)fmi->frsize * (double)fmi->blocks;
-	fmi->avail = (double)fmi->frsize * (double)fmi->bavail;
-	fmi->used  = (double)fmi->frsize * ((double)fmi->blocks - (double)fmi->bfree);
-	if ((int)fmi->total == 0)
+	fmi->total = (uint64_t)fmi->frsize * (uint64_t)fmi->blocks;
+	fmi->avail = (uint64_t)fmi->frsize * (uint64_t)fmi->bavail;
+	fmi->used  = (uint64_t)fmi->frsize * (uint64_t)(fmi->blocks - fmi->bfree);
+	if (fmi->total == 0)
 		fmi->perctused = 100.0;
 	else
 		fmi->perctused = 100.0 -
@@ -50,25 +50,36 @@
 #include <sys/statvfs.h>
 
 #include "extern.h"
+#include "fsclass.h"
+#include "mntindex.h"
 #include "services.h"
 #include "util.h"
+#include "where.h"
+
+/* static function declaration */
+static size_t read_mnttab(struct mnttab **ents);
 
 int
 is_mnt_ignore(const struct fsmntinfo *fs)
 {
+	struct fsclass cls;
+
 	/* if the size is zero, it is most likely a fs that we want to ignore */
 	if (fs->blocks == 0)
 		return 1;
 
-	/* treat tmpfs/devtmpfs/... as a special case */
-	if (fs->fstype && strstr(fs->fstype, "tmpfs"))
+	/* the displayed type may be shortened */
+	cls = fsclass_get(fs->fstype);
+
+	/* treat tmpfs/devtmpfs/... as a special case, unless configured */
+	if (cls.source != FSCLASS_CONFIG && strstr(cls.name, "tmpfs"))
 		return 0;
 
 	/* libc is dynamically mounted into /lib, treat it as a special case */
 	if (fs->mntdir && (strncmp(fs->mntdir, "/lib/", 5) == 0))
 		return 1;
 
-	return is_pseudofs(fs->fstype);
+	return (cls.flags & FSCLASS_PSEUDO) != 0;
 }
 
 int
@@ -77,15 +88,75 @@ is_remote(const struct fsmntinfo *fs)
 	return is_remotefs(fs->fstype);
 }
 
-void
-fetch_info(struct list *lst)
+/*
+ * Read the mount table into an array of entries, which strings are copied
+ * Return the number of entries.
+ * @ents: set to the array of entries
+ */
+static size_t
+read_mnttab(struct mnttab **ents)
 {
-	struct fsmntinfo *fmi;
 	FILE *mnttab;
-	struct mnttab mnttabbuf;
-	struct statvfs vfsbuf;
+	struct mnttab mnttabbuf, *tmp;
+	size_t n = 0, cap = 0;
 	int ret;
 
+	*ents = NULL;
+
+	/* open mnttab file */
+	if ((mnttab = fopen("/etc/mnttab", "r")) == NULL) {
+		perror("Error while opening mnttab file ");
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+
+	/* getmntent(3C) reuses its buffers: copy every entry */
+	while ((ret = getmntent(mnttab, &mnttabbuf)) == 0) {
+		if (n == cap) {
+			cap = cap ? cap * 2 : 64;
+			if ((tmp = realloc(*ents, cap * sizeof(*tmp))) == NULL)
+				goto nomem;
+			*ents = tmp;
+		}
+		tmp = &(*ents)[n];
+		tmp->mnt_special = strdup(mnttabbuf.mnt_special);
+		tmp->mnt_mountp  = strdup(mnttabbuf.mnt_mountp);
+		tmp->mnt_fstype  = strdup(mnttabbuf.mnt_fstype);
+		tmp->mnt_mntopts = strdup(mnttabbuf.mnt_mntopts);
+		tmp->mnt_time    = NULL;
+		if (!tmp->mnt_special || !tmp->mnt_mountp ||
+		    !tmp->mnt_fstype || !tmp->mnt_mntopts)
+			goto nomem;
+		n++;
+	}
+	if (ret > 0) {
+		(void)fprintf(stderr, "An error occured while reading the "
+				"mnttab file\n");
+	}
+
+	/* we need to close the mnttab file now */
+	if (fclose(mnttab) == EOF)
+		perror("Could not close mnttab file ");
+
+	return n;
+
+nomem:
+	(void)fputs("Error while allocating memory to read mnttab", stderr);
+	exit(EXIT_FAILURE);
+	/* NOTREACHED */
+}
+
+int
+fetch_info(struct list *lst, char *const paths[], int npaths)
+{
+	struct fsmntinfo *fmi;
+	struct mnttab *ents, *ent;
+	struct statvfs vfsbuf;
+	const char **dirs = NULL;
+	unsigned char *selected = NULL;
+	size_t nents, i;
+	int ret = 0;
+
 	/* init fsmntinfo */
 	if ((fmi = malloc(sizeof(struct fsmntinfo))) == NULL) {
 		(void)fputs("Error while allocating memory to fmi", stderr);
@@ -94,48 +165,50 @@ fetch_info(struct list *lst)
 	}
 	*fmi = fmi_init();
 
-	/* open mnttab file */
-	if ((mnttab = fopen("/etc/mnttab", "r")) == NULL) {
-		perror("Error while opening mnttab file ");
-		exit(EXIT_FAILURE);
-		/* NOTREACHED */
+	nents = read_mnttab(&ents);
+
+	/* only the mount points of the given paths are stated */
+	if (npaths > 0) {
+		dirs = malloc((nents + 1) * sizeof(*dirs));
+		selected = calloc(nents + 1, sizeof(*selected));
+		if (dirs == NULL || selected == NULL) {
+			(void)fputs("Error while allocating memory to resolve "
+				"paths", stderr);
+			exit(EXIT_FAILURE);
+			/* NOTREACHED */
+		}
+		for (i = 0; i < nents; i++)
+			dirs[i] = ents[i].mnt_mountp;
+		ret = select_mounts(dirs, nents, paths, npaths, selected);
 	}
 
 	/* loop to get infos from all the mounted fs */
-	while ((ret = getmntent(mnttab, &mnttabbuf)) == 0) {
-		if (statvfs(mnttabbuf.mnt_mountp, &vfsbuf) == -1) {
+	for (i = 0; i < nents; i++) {
+		ent = &ents[i];
+		if (selected && !selected[i])
+			continue;
+		/* stating an autofs trigger point mounts it */
+		if (!automountflag && strcmp(ent->mnt_fstype, "autofs") == 0)
+			continue;
+		/* --where may not need the statistics to tell */
+		if (!where_match_mount(ent->mnt_special, ent->mnt_fstype,
+		    ent->mnt_mountp, ent->mnt_mntopts))
+			continue;
+		if (statvfs(ent->mnt_mountp, &vfsbuf) == -1) {
 			(void)fprintf(stderr, _("WARNING: %s was skipped "
 				"because it could not be stated"),
-				mnttabbuf.mnt_mountp);
+				ent->mnt_mountp);
 			perror(" ");
 			continue;
 		}
-		if ((fmi->fsnameog = strdup(mnttabbuf.mnt_special)) == NULL)
-			fmi->fsnameog = g_unknown_str;
-		if ((fmi->mntdirog = strdup(mnttabbuf.mnt_mountp))== NULL)
-			fmi->mntdirog = g_unknown_str;
-		if ((fmi->fstypeog = strdup(mnttabbuf.mnt_fstype)) == NULL)
-			fmi->fstypeog = g_unknown_str;
-		if (Wflag) { /* Wflag to avoid name truncation */
-			fmi->fsname = fmi->fsnameog;
-			fmi->mntdir = fmi->mntdirog;
-			fmi->fstype = fmi->fstypeog;
-		} else {
-			if ((fmi->fsname = strdup(shortenstr(
-				mnttabbuf.mnt_special, STRMAXLEN))) == NULL) {
-				fmi->fsname = g_unknown_str;
-			}
-			if ((fmi->mntdir = strdup(shortenstr
-				(mnttabbuf.mnt_mountp, STRMAXLEN))) == NULL) {
-				fmi->mntdir = g_unknown_str;
-			}
-			if ((fmi->fstype = strdup(shortenstr(
-				mnttabbuf.mnt_fstype, STRMAXLEN))) == NULL) {
-				fmi->fstype = g_unknown_str;
-			}
-		}
+		if ((fmi->fsname = strdup(ent->mnt_special)) == NULL)
+			fmi->fsname = g_unknown_str;
+		if ((fmi->mntdir = strdup(ent->mnt_mountp))== NULL)
+			fmi->mntdir = g_unknown_str;
+		if ((fmi->fstype = strdup(ent->mnt_fstype)) == NULL)
+			fmi->fstype = g_unknown_str;
 
-		if ((fmi->mntopts = strdup(mnttabbuf.mnt_mntopts)) == NULL)
+		if ((fmi->mntopts = strdup(ent->mnt_mntopts)) == NULL)
 			fmi->mntopts = g_none_str;
 
 		fmi->bsize  = vfsbuf.f_bsize;
@@ -150,28 +223,74 @@ fetch_info(struct list *lst)
 		compute_fs_stats(fmi);
 
 		fmi->next = NULL;
-		enqueue(lst, *fmi);
 
-		update_maxwidth(fmi);
-	}
-	if (ret > 0) {
-		(void)fprintf(stderr, "An error occured while reading the "
-				"mnttab file\n");
+		enqueue(lst, *fmi);
 	}
 
-	/* we need to close the mnttab file now */
-	if (fclose(mnttab) == EOF)
-		perror("Could not close mnttab file ");
+	for (i = 0; i < nents; i++) {
+		free(ents[i].mnt_special);
+		free(ents[i].mnt_mountp);
+		free(ents[i].mnt_fstype);
+		free(ents[i].mnt_mntopts);
+	}
+	free(ents);
+	free(dirs);
+	free(selected);
 	free(fmi);
+
+	return ret;
+}
+
+int
+fetch_info_root(struct list *lst, const char *prefix)
+{
+	(void)lst;
+	(void)prefix;
+	(void)fputs(_("--root is not supported on this platform\n"), stderr);
+
+	return -1;
+}
+
+int
+fetch_info_ns(struct list *lst, pid_t pid)
+{
+	(void)lst;
+	(void)pid;
+	(void)fputs(_("Mount namespaces are not supported on this platform\n"),
+		stderr);
+
+	return -1;
+}
+
+ssize_t
+fetch_held(struct held_file **files)
+{
+	*files = NULL;
+	(void)fputs(_("--held is not supported on this platform\n"), stderr);
+
+	return -1;
+}
+
+int
+fetch_drill(const char *path, int depth, size_t topk,
+    struct drill_result *res)
+{
+	(void)path;
+	(void)depth;
+	(void)topk;
+	(void)memset(res, 0, sizeof(*res));
+	(void)fputs(_("--drill is not supported on this platform\n"), stderr);
+
+	return -1;
 }
 
 void
 compute_fs_stats(struct fsmntinfo *fmi)
 {
-	fmi->total = (double)fmi->frsize * (double)fmi->blocks;
-	fmi->avail = (double)fmi->frsize * (double)fmi->bavail;
-	fmi->used  = (double)fmi->frsize * ((double)fmi->blocks - (double)fmi->bfree);
-	if ((int)fmi->total == 0)
+	fmi->total = (uint64_t)fmi->frsize * (uint64_t)fmi->blocks;
+	fmi->avail = (uint64_t)fmi->frsize * (uint64_t)fmi->bavail;
+	fmi->used  = (uint64_t)fmi->frsize * (uint64_t)(fmi->blocks - fmi->bfree);
+	if (fmi->total == 0)
 		fmi->perctused = 100.0;
 	else
 		fmi->perctused = 100.0 -
@@ -36,10 +36,10 @@
  *
  * Generic interface for platform-dependent services.
  */
+#include "drill.h"
+#include "held.h"
 #include "list.h"
 
-#define STRMAXLEN 24
-
 /*
  * Return 1 if the current fs should usually be ignored, 0 otherwise.
  * On error, -1 is returned.
@@ -54,9 +54,61 @@ int is_remote(const struct fsmntinfo *fs);
 
 /*
  * fetch information from getmntent and statvfs and store it into the queue
+ * When paths are given, only the file systems they are on are stated.
+ * Return -1 if a path could not be resolved, 0 otherwise.
+ * @lst: queue in which to store information
+ * @paths: paths which file systems to show, all of them if npaths is 0
+ * @npaths: number of paths
+ */
+int fetch_info(struct list *lst, char *const paths[], int npaths);
+
+/*
+ * fetch information about the file systems of a host which root directory is
+ * mounted under a prefix (such as from within a container) and store it into
+ * the queue
+ * The mount table is read from PREFIX/proc/1/mounts and the mount points are
+ * stated relatively to PREFIX.
+ * Return -1 if the prefix cannot be opened or on an unsupported platform,
+ * 0 otherwise.
  * @lst: queue in which to store information
+ * @prefix: directory under which the root of the host is mounted
+ */
+int fetch_info_root(struct list *lst, const char *prefix);
+
+/*
+ * fetch information about the file systems mounted in the mount namespaces of
+ * the running processes and store it into the queue
+ * A file system is only stated and stored once, with the processes of the
+ * namespaces it is mounted in when looking at all of them.
+ * Return -1 if the namespaces could not be read or on an unsupported platform,
+ * 0 otherwise.
+ * @lst: queue in which to store information
+ * @pid: process which namespace to look at, all of them if 0
+ */
+int fetch_info_ns(struct list *lst, pid_t pid);
+
+/*
+ * find the regular files which were deleted while processes still hold them
+ * open, with these processes
+ * Return the number of files, sorted by device and then by decreasing size, or
+ * -1 if the processes cannot be listed or on an unsupported platform.
+ * @files: set to the files, to free with held_files_free
+ */
+ssize_t fetch_held(struct held_file **files);
+
+/*
+ * walk the tree under a directory, without leaving its file system, and find
+ * its largest directories down to a depth and its largest files
+ * Files with several links are only counted once.
+ * Return -1 if the directory cannot be read or on an unsupported platform,
+ * 0 otherwise.
+ * @path: directory to walk, usually a mount point
+ * @depth: depth of the directories to rank, 1 for the ones right under path
+ * @topk: number of directories and of files to keep
+ * @res: set to what was found, to free with drill_free
  */
-void fetch_info(struct list *lst);
+int fetch_drill(const char *path, int depth, size_t topk,
+    struct drill_result *res);
 
 /*
  * compute file systems statistics
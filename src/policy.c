@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * policy.c
+ *
+ * Usage thresholds of each file system. The policy keys of the configuration
+ * file give the thresholds of the file systems which mount point, type or
+ * device matches a pattern, in bytes and in inodes: the other ones use
+ * graph_medium and graph_high. Rules are compiled once, as they are read, and
+ * the first one matching a file system applies: a file system is matched
+ * against them once, when its line is made, whatever is then displayed.
+ */
+#include <fnmatch.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "extern.h"
+#include "policy.h"
+
+/* what the pattern of a rule is matched against */
+enum rule_kind {
+	RULE_MOUNT = 0,
+	RULE_TYPE,
+	RULE_DEVICE
+};
+
+/* a policy key of the configuration file */
+struct rule {
+	enum rule_kind kind;
+	char *pattern;
+	int literal;		/* no wildcard: compared as is */
+	struct limits lim;
+};
+
+/* rules, in the order of the configuration file */
+static struct rule *rules;
+static size_t nrules;
+
+/* static function declaration */
+static int parse_perct(const char *str, int *perct);
+
+/*
+ * Parse a threshold of a rule
+ * Return -1 if it is not a number between 0 and 100, 0 otherwise.
+ * @str: threshold
+ * @perct: set to the threshold
+ */
+static int
+parse_perct(const char *str, int *perct)
+{
+	char *end;
+	long val;
+
+	if (str == NULL)
+		return -1;
+	val = strtol(str, &end, 10);
+	if (end == str || *end != '\0' || val < 0 || val > 100)
+		return -1;
+	*perct = (int)val;
+
+	return 0;
+}
+
+/*
+ * Add a rule of the policy, as given by the configuration file:
+ * "mount:PATTERN", "type:PATTERN" or "device:PATTERN" followed by the medium
+ * and high thresholds in bytes and, optionally, in inodes (they are the same
+ * otherwise). Patterns are shell wildcards (see fnmatch(3)).
+ * Return -1 if the rule is not valid or on error, 0 otherwise.
+ * @rule: rule of the configuration file
+ */
+int
+policy_config(const char *rule)
+{
+	static const char *const kinds[] = { "mount:", "type:", "device:" };
+	struct rule r, *tmp;
+	char *copy, *sel, *tok, *save = NULL;
+	size_t i, len;
+
+	if ((copy = strdup(rule)) == NULL)
+		return -1;
+	(void)memset(&r, 0, sizeof(r));
+
+	if ((sel = strtok_r(copy, " \t", &save)) == NULL)
+		goto err;
+	for (i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++) {
+		len = strlen(kinds[i]);
+		if (strncmp(sel, kinds[i], len) == 0)
+			break;
+	}
+	if (i == sizeof(kinds) / sizeof(kinds[0]) || sel[len] == '\0')
+		goto err;
+	r.kind = (enum rule_kind)i;
+
+	if (parse_perct(strtok_r(NULL, " \t", &save), &r.lim.medium) == -1 ||
+	    parse_perct(strtok_r(NULL, " \t", &save), &r.lim.high) == -1 ||
+	    r.lim.medium > r.lim.high)
+		goto err;
+	r.lim.imedium = r.lim.medium;
+	r.lim.ihigh = r.lim.high;
+	if ((tok = strtok_r(NULL, " \t", &save)) != NULL) {
+		if (parse_perct(tok, &r.lim.imedium) == -1 ||
+		    parse_perct(strtok_r(NULL, " \t", &save),
+		    &r.lim.ihigh) == -1 ||
+		    r.lim.imedium > r.lim.ihigh ||
+		    strtok_r(NULL, " \t", &save) != NULL)
+			goto err;
+	}
+
+	if ((r.pattern = strdup(sel + len)) == NULL)
+		goto err;
+	r.literal = strpbrk(r.pattern, "*?[\\") == NULL;
+	if ((tmp = realloc(rules, (nrules + 1) * sizeof(*rules))) == NULL) {
+		free(r.pattern);
+		goto err;
+	}
+	rules = tmp;
+	rules[nrules++] = r;
+
+	free(copy);
+	return 0;
+
+err:
+	free(copy);
+	return -1;
+}
+
+/*
+ * Return the thresholds of the file systems no rule applies to, which are
+ * the ones of the configuration file (graph_medium and graph_high)
+ */
+const struct limits *
+policy_default(void)
+{
+	static struct limits lim;
+
+	lim.medium = lim.imedium = cnf.gmedium;
+	lim.high = lim.ihigh = cnf.ghigh;
+
+	return &lim;
+}
+
+/*
+ * Return the thresholds of a file system, given by the first rule it matches
+ * @fsname: device of the file system, may be NULL
+ * @fstype: type of the file system, may be NULL
+ * @mntdir: mount point of the file system, may be NULL
+ */
+const struct limits *
+policy_match(const char *fsname, const char *fstype, const char *mntdir)
+{
+	const struct rule *r;
+	const char *s;
+	size_t i;
+
+	for (i = 0; i < nrules; i++) {
+		r = &rules[i];
+		switch (r->kind) {
+		case RULE_MOUNT:
+			s = mntdir;
+			break;
+		case RULE_TYPE:
+			s = fstype;
+			break;
+		case RULE_DEVICE:
+		default:
+			s = fsname;
+			break;
+		}
+		if (s == NULL)
+			continue;
+		if (r->literal ? strcmp(r->pattern, s) == 0 :
+		    fnmatch(r->pattern, s, 0) == 0)
+			return &r->lim;
+	}
+
+	return policy_default();
+}
+
+/*
+ * Return the level of a usage given the thresholds of its file system
+ * @lim: thresholds
+ * @perct: usage, in percent
+ * @inodes: whether this is the usage of the inodes
+ */
+enum level
+policy_level(const struct limits *lim, double perct, int inodes)
+{
+	if (perct >= (double)(inodes ? lim->ihigh : lim->high))
+		return LEVEL_HIGH;
+	if (perct >= (double)(inodes ? lim->imedium : lim->medium))
+		return LEVEL_MEDIUM;
+
+	return LEVEL_LOW;
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * rollup.c
+ *
+ * Sizes of file systems added up by group: a hash table of groups indexed by
+ * their name, using open addressing.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "rollup.h"
+#include "util.h"
+
+/* static function declaration */
+static struct rollup_entry *lookup(struct rollup_entry *slots, size_t nslots,
+    const char *key);
+static int grow(struct rollup *r);
+static int keycmp(const void *a, const void *b);
+
+/*
+ * Return the slot of `key`, or the free slot where it should be stored
+ * @slots: hash table
+ * @nslots: size of the hash table, a power of 2
+ * @key: name of the group
+ */
+static struct rollup_entry *
+lookup(struct rollup_entry *slots, size_t nslots, const char *key)
+{
+	size_t i, mask = nslots - 1;
+
+	for (i = strhash(key) & mask; slots[i].key; i = (i + 1) & mask)
+		if (strcmp(slots[i].key, key) == 0)
+			break;
+
+	return &slots[i];
+}
+
+/*
+ * Double the size of the hash table
+ * Return -1 if it fails, 0 otherwise.
+ * @r: groups
+ */
+static int
+grow(struct rollup *r)
+{
+	struct rollup_entry *slots;
+	size_t nslots, i;
+
+	nslots = r->nslots ? r->nslots * 2 : 64;
+	if ((slots = calloc(nslots, sizeof(*slots))) == NULL)
+		return -1;
+
+	for (i = 0; i < r->nslots; i++)
+		if (r->slots[i].key)
+			*lookup(slots, nslots, r->slots[i].key) = r->slots[i];
+
+	free(r->slots);
+	r->slots = slots;
+	r->nslots = nslots;
+
+	return 0;
+}
+
+/*
+ * Init an empty set of groups
+ * @r: groups
+ */
+void
+rollup_init(struct rollup *r)
+{
+	r->slots = NULL;
+	r->nslots = 0;
+	r->n = 0;
+}
+
+/*
+ * Add the count and sizes of `val` to the group `key`, creating it if needed
+ * Return -1 if it fails, 0 otherwise.
+ * @r: groups
+ * @key: name of the group
+ * @val: count and sizes to add (its key is ignored)
+ */
+int
+rollup_add(struct rollup *r, const char *key, const struct rollup_entry *val)
+{
+	struct rollup_entry *e;
+
+	/* keep the hash table at most half full */
+	if (r->n * 2 >= r->nslots && grow(r) == -1)
+		return -1;
+
+	e = lookup(r->slots, r->nslots, key);
+	if (e->key == NULL) {
+		if ((e->key = strdup(key)) == NULL)
+			return -1;
+		r->n++;
+	}
+
+	e->count  += val->count;
+	e->total  += val->total;
+	e->avail  += val->avail;
+	e->used   += val->used;
+	e->files  += val->files;
+	e->favail += val->favail;
+
+	return 0;
+}
+
+/*
+ * Add all the groups of `src` to `dst`
+ * Return -1 if it fails, 0 otherwise.
+ * @dst: groups to add to
+ * @src: groups to add
+ */
+int
+rollup_merge(struct rollup *dst, const struct rollup *src)
+{
+	size_t i;
+
+	for (i = 0; i < src->nslots; i++) {
+		if (src->slots[i].key &&
+		    rollup_add(dst, src->slots[i].key, &src->slots[i]) == -1)
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Compare two groups by name
+ */
+static int
+keycmp(const void *a, const void *b)
+{
+	const struct rollup_entry *ea = *(const struct rollup_entry * const *)a;
+	const struct rollup_entry *eb = *(const struct rollup_entry * const *)b;
+
+	return strcmp(ea->key, eb->key);
+}
+
+/*
+ * Return the r->n groups sorted by name, or NULL if it fails
+ * @r: groups
+ */
+struct rollup_entry **
+rollup_sorted(const struct rollup *r)
+{
+	struct rollup_entry **arr;
+	size_t i, n = 0;
+
+	if ((arr = malloc((r->n + 1) * sizeof(*arr))) == NULL)
+		return NULL;
+
+	for (i = 0; i < r->nslots; i++)
+		if (r->slots[i].key)
+			arr[n++] = &r->slots[i];
+
+	qsort(arr, n, sizeof(*arr), keycmp);
+
+	return arr;
+}
+
+/*
+ * Return the usage of a group in %, computed like for a single file system
+ * @e: group
+ */
+double
+rollup_perct(const struct rollup_entry *e)
+{
+	if (e->total == 0)
+		return 100.0;
+
+	return 100.0 - ((double)e->avail / (double)e->total) * 100.0;
+}
+
+/*
+ * Free all the groups
+ * @r: groups
+ */
+void
+rollup_free(struct rollup *r)
+{
+	size_t i;
+
+	for (i = 0; i < r->nslots; i++)
+		free(r->slots[i].key);
+	free(r->slots);
+	rollup_init(r);
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef H_ROLLUP
+#define H_ROLLUP
+/*
+ * rollup.h
+ *
+ * Sizes of file systems added up by group
+ */
+
+#include <stddef.h>
+
+#include "list.h"
+
+/* sizes of a group of file systems */
+struct rollup_entry {
+	char *key;		/* name of the group, NULL if the slot is free */
+	unsigned long count;	/* number of file systems in the group */
+	bigsize_t total;
+	bigsize_t avail;
+	bigsize_t used;
+	int64_t files;
+	int64_t favail;
+};
+
+/* groups, indexed by name */
+struct rollup {
+	struct rollup_entry *slots;
+	size_t nslots;
+	size_t n;
+};
+
+/* function declaration */
+void rollup_init(struct rollup *r);
+int rollup_add(struct rollup *r, const char *key,
+    const struct rollup_entry *val);
+int rollup_merge(struct rollup *dst, const struct rollup *src);
+struct rollup_entry **rollup_sorted(const struct rollup *r);
+double rollup_perct(const struct rollup_entry *e);
+void rollup_free(struct rollup *r);
+
+#endif /* ndef H_ROLLUP */
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * snapshot.c
+ *
+ * Read snapshots written by the "bin" export (see snapshot.h for the format)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "snapshot.h"
+#include "extern.h"
+#include "list.h"
+#include "util.h"
+#include "platform/services.h"
+
+#ifdef NLS_ENABLED
+#include <libintl.h>
+#endif
+
+/* static function declaration */
+static uint64_t get_le(const unsigned char *buf, size_t len);
+static int add_row(void *arg, const char *host, char *const str[],
+    const uint64_t num[]);
+static int read_batch(FILE *fp, const unsigned char *hdr, snap_row_fn fn,
+    void *arg);
+
+/*
+ * Return the `len` bytes little-endian integer stored at `buf`
+ */
+static uint64_t
+get_le(const unsigned char *buf, size_t len)
+{
+	uint64_t val = 0;
+
+	while (len-- > 0)
+		val = (val << 8) | buf[len];
+
+	return val;
+}
+
+/*
+ * Fill in `fmi` from a row of a snapshot. Names point to the strings of the
+ * row, they are not copied.
+ * The statvfs-like fields are filled in with a block size of 1 byte so that
+ * compute_fs_stats() finds the exact same values as when the snapshot was
+ * taken.
+ * @fmi: structure to fill in
+ * @str: string columns of the row
+ * @num: numeric columns of the row
+ */
+void
+snapshot_fmi(struct fsmntinfo *fmi, char *const str[], const uint64_t num[])
+{
+	fmi->fsname = str[SNAP_FSNAME];
+	fmi->fstype = str[SNAP_FSTYPE];
+	fmi->mntdir = str[SNAP_MNTDIR];
+	fmi->mntopts = str[SNAP_MNTOPTS];
+
+	fmi->bsize  = 1;
+	fmi->frsize = 1;
+	fmi->blocks = num[SNAP_TOTAL];
+	fmi->bfree  = num[SNAP_TOTAL] - num[SNAP_USED];
+	fmi->bavail = num[SNAP_AVAIL];
+	fmi->files  = num[SNAP_FILES];
+	fmi->ffree  = num[SNAP_FAVAIL];
+	fmi->favail = num[SNAP_FAVAIL];
+
+	compute_fs_stats(fmi);
+}
+
+/*
+ * Turn a row of the snapshot into a fsmntinfo and enqueue it
+ * Return -1 on error, 0 otherwise.
+ * @arg: queue in which to store the row
+ * @host: ignored here
+ * @str: string columns of the row
+ * @num: numeric columns of the row
+ */
+static int
+add_row(void *arg, const char *host, char *const str[], const uint64_t num[])
+{
+	struct list *lst = arg;
+	struct fsmntinfo fmi = fmi_init();
+
+	(void)host;
+
+	snapshot_fmi(&fmi, str, num);
+
+	/* the strings of the row do not outlive the callback */
+	if ((fmi.fsname = strdup(str[SNAP_FSNAME])) == NULL)
+		fmi.fsname = g_unknown_str;
+	if ((fmi.mntdir = strdup(str[SNAP_MNTDIR])) == NULL)
+		fmi.mntdir = g_unknown_str;
+	if ((fmi.fstype = strdup(str[SNAP_FSTYPE])) == NULL)
+		fmi.fstype = g_unknown_str;
+	if ((fmi.mntopts = strdup(str[SNAP_MNTOPTS])) == NULL)
+		fmi.mntopts = g_none_str;
+
+	return enqueue(lst, fmi);
+}
+
+/*
+ * Read the record batch which header is `hdr` and call `fn` for each row
+ * Return -1 on error, 0 otherwise.
+ * @fp: snapshot file, positioned right after the header
+ * @hdr: header of the batch
+ * @fn: function to call for each row
+ * @arg: argument to give to fn
+ */
+static int
+read_batch(FILE *fp, const unsigned char *hdr, snap_row_fn fn, void *arg)
+{
+	unsigned char *buf;
+	const unsigned char *nums, *strs;
+	char *str[SNAP_NSTRS];
+	const char *host;
+	uint64_t num[SNAP_NNUMS];
+	uint64_t off;
+	size_t ncols, nrows, strtablen, rowlen, len, i;
+	int j, ret = -1;
+
+	if (memcmp(hdr, SNAP_MAGIC, 4) != 0) {
+		(void)fputs(_("Not a dfc snapshot\n"), stderr);
+		return -1;
+	}
+	if (get_le(hdr + 4, 2) != SNAP_VERSION) {
+		(void)fprintf(stderr, _("Unsupported snapshot version: %lu\n"),
+			(unsigned long)get_le(hdr + 4, 2));
+		return -1;
+	}
+
+	ncols = (size_t)get_le(hdr + 6, 2);
+	nrows = (size_t)get_le(hdr + 8, 4);
+	strtablen = (size_t)get_le(hdr + 12, 4);
+	rowlen = ncols * 8 + SNAP_NSTRS * 4;
+	if (ncols < SNAP_NNUMS || strtablen == 0 || strtablen % 8 != 0 ||
+	    get_le(hdr + 24, 4) >= strtablen ||
+	    nrows > ((size_t)-1 - SNAP_HDRLEN - strtablen - 7) / rowlen) {
+		(void)fputs(_("Corrupted snapshot header\n"), stderr);
+		return -1;
+	}
+	len = SNAP_HDRLEN + strtablen + nrows * rowlen;
+	len = ((len + 7) & ~(size_t)7) - SNAP_HDRLEN;
+
+	if ((buf = malloc(len)) == NULL) {
+		(void)fputs("Error while allocating memory to read the "
+			"snapshot\n", stderr);
+		return -1;
+	}
+	if (fread(buf, 1, len, fp) != len) {
+		(void)fputs(_("Truncated snapshot\n"), stderr);
+		goto out;
+	}
+	/* strings must not run past the end of the string table */
+	if (buf[strtablen - 1] != '\0') {
+		(void)fputs(_("Corrupted snapshot string table\n"), stderr);
+		goto out;
+	}
+
+	host = (const char *)buf + get_le(hdr + 24, 4);
+	nums = buf + strtablen;
+	strs = nums + ncols * 8 * nrows;
+	for (i = 0; i < nrows; i++) {
+		for (j = 0; j < SNAP_NNUMS; j++)
+			num[j] = get_le(nums + ((size_t)j * nrows + i) * 8, 8);
+		for (j = 0; j < SNAP_NSTRS; j++) {
+			off = get_le(strs + ((size_t)j * nrows + i) * 4, 4);
+			if (off >= strtablen) {
+				(void)fputs(_("Corrupted snapshot string "
+					"offset\n"), stderr);
+				goto out;
+			}
+			str[j] = (char *)buf + off;
+		}
+		if (num[SNAP_USED] > num[SNAP_TOTAL]) {
+			(void)fputs(_("Corrupted snapshot sizes\n"), stderr);
+			goto out;
+		}
+		if (fn(arg, host, str, num) == -1)
+			goto out;
+	}
+	ret = 0;
+
+out:
+	free(buf);
+	return ret;
+}
+
+/*
+ * Read all the record batches of a snapshot file and call `fn` for each row
+ * Return -1 on error, 0 otherwise.
+ * @path: path of the snapshot file, "-" for the standard input
+ * @fn: function to call for each row
+ * @arg: argument to give to fn
+ */
+int
+read_snapshot_rows(const char *path, snap_row_fn fn, void *arg)
+{
+	FILE *fp;
+	unsigned char hdr[SNAP_HDRLEN];
+	size_t n;
+	int ret = 0;
+
+	if (strcmp(path, "-") == 0) {
+		fp = stdin;
+	} else if ((fp = fopen(path, "rb")) == NULL) {
+		(void)fprintf(stderr, _("Cannot read file %s"), path);
+		perror(" ");
+		return -1;
+	}
+
+	while ((n = fread(hdr, 1, sizeof(hdr), fp)) == sizeof(hdr)) {
+		if (read_batch(fp, hdr, fn, arg) == -1) {
+			ret = -1;
+			break;
+		}
+	}
+	if (ret == 0 && (n != 0 || ferror(fp))) {
+		(void)fprintf(stderr, _("Error reading snapshot %s\n"), path);
+		ret = -1;
+	}
+
+	if (fp != stdin && fclose(fp) == EOF)
+		perror("Could not close snapshot file ");
+
+	return ret;
+}
+
+/*
+ * Read all the record batches of a snapshot file and enqueue their rows
+ * Return -1 on error, 0 otherwise.
+ * @path: path of the snapshot file, "-" for the standard input
+ * @lst: queue in which to store the rows
+ */
+int
+read_snapshot(const char *path, struct list *lst)
+{
+	return read_snapshot_rows(path, add_row, lst);
+}
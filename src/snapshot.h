@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef H_SNAPSHOT
+#define H_SNAPSHOT
+/*
+ * snapshot.h
+ *
+ * Binary snapshot format written by the "bin" export and read back with
+ * --read.
+ *
+ * A snapshot file is made of one or more record batches, each of them laid
+ * out as follows (all integers are little-endian):
+ *
+ *	offset	size	content
+ *	0	4	magic: "DFCB"
+ *	4	2	format version (SNAP_VERSION)
+ *	6	2	number of numeric columns (ncols)
+ *	8	4	number of rows (nrows)
+ *	12	4	length of the string table in bytes, multiple of 8
+ *	16	8	capture time, in seconds since the Epoch
+ *	24	4	offset of the host name in the string table
+ *	28	4	reserved, 0
+ *	32	-	string table: null terminated strings, zero padded
+ *	-	-	ncols arrays of nrows uint64 (see the SNAP_* numeric columns)
+ *	-	-	SNAP_NSTRS arrays of nrows uint32 offsets in the string table
+ *	-	-	zero padding up to the next multiple of 8
+ *
+ * Batches can be concatenated: the length of each one can be computed from
+ * its header. Readers must ignore numeric columns past the ones they know.
+ */
+
+#include "list.h"
+
+#define SNAP_MAGIC	"DFCB"
+#define SNAP_VERSION	1
+#define SNAP_HDRLEN	32
+
+/* numeric columns, in the order they are stored */
+enum {
+	SNAP_TOTAL,
+	SNAP_USED,
+	SNAP_AVAIL,
+	SNAP_FILES,
+	SNAP_FAVAIL,
+	SNAP_NNUMS
+};
+
+/* string columns, in the order they are stored */
+enum {
+	SNAP_FSNAME,
+	SNAP_FSTYPE,
+	SNAP_MNTDIR,
+	SNAP_MNTOPTS,
+	SNAP_NSTRS
+};
+
+/*
+ * Function called for each row of a snapshot by read_snapshot_rows().
+ * The strings belong to the reader and are only valid during the call.
+ * It should return -1 to stop reading, 0 otherwise.
+ * @arg: argument given to read_snapshot_rows()
+ * @host: name of the host the row was taken on
+ * @str: string columns of the row (see the SNAP_* string columns)
+ * @num: numeric columns of the row (see the SNAP_* numeric columns)
+ */
+typedef int (*snap_row_fn)(void *arg, const char *host, char *const str[],
+    const uint64_t num[]);
+
+/* function declaration */
+void snapshot_fmi(struct fsmntinfo *fmi, char *const str[],
+    const uint64_t num[]);
+int read_snapshot_rows(const char *path, snap_row_fn fn, void *arg);
+int read_snapshot(const char *path, struct list *lst);
+
+#endif /* ndef H_SNAPSHOT */
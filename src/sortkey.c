@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * sortkey.c
+ *
+ * Sort file systems on several columns, in ascending or descending order.
+ * Keys are computed once per file system before sorting, so that comparing
+ * two file systems never has to look at what was asked for or to collate
+ * strings again: strings are compared through strxfrm(3) keys in which every
+ * run of digits is prefixed by its length, so that "/data2" comes before
+ * "/data10".
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "extern.h"
+#include "sortkey.h"
+
+/* maximum number of sort keys given to -q */
+#define SORT_MAX_KEYS	8
+
+/* columns file systems can be sorted on */
+enum sort_field {
+	SORT_NAME = 0,
+	SORT_TYPE,
+	SORT_MOUNT,
+	SORT_OPTIONS,
+	SORT_USAGE,
+	SORT_USED,
+	SORT_AVAIL,
+	SORT_TOTAL,
+	SORT_INODES,
+	SORT_AVINODES
+};
+
+static const char *sort_fields[] = {
+	"name",
+	"type",
+	"mount",
+	"options",
+	"usage",
+	"used",
+	"avail",
+	"total",
+	"inodes",
+	"avinodes",
+	NULL
+};
+
+/* value of a sort key, depending on its column */
+union sort_value {
+	char *str;	/* collation key */
+	uint64_t num;	/* sizes and inodes */
+	double real;	/* usage */
+};
+
+/* file system along with its sort keys */
+struct sort_row {
+	struct fsmntinfo *fmi;
+	size_t index;	/* position in the list, to keep the sort stable */
+	union sort_value keys[SORT_MAX_KEYS];
+};
+
+/* what to sort on, set by sort_parse() */
+static struct {
+	enum sort_field field[SORT_MAX_KEYS];
+	int desc[SORT_MAX_KEYS];
+	int n;
+} spec;
+
+/* static function declaration */
+static char *collate_key(const char *s);
+static void make_keys(struct sort_row *row);
+static void free_keys(struct sort_row *row);
+static int rowcmp(const void *a, const void *b);
+static void sift_down(struct sort_row *heap, size_t n, size_t i);
+static void select_top(struct sort_row *rows, size_t n, size_t k);
+
+/*
+ * Parse the argument of -q: a comma separated list of columns, each of which
+ * may be followed by ":asc" (default) or ":desc", such as
+ * "usage:desc,avail,mount".
+ * Return -1 if it is not valid, 0 otherwise.
+ * @arg: argument to parse
+ */
+int
+sort_parse(const char *arg)
+{
+	const char *s, *order;
+	size_t len, flen;
+	int i;
+
+	spec.n = 0;
+	for (s = arg; *s != '\0'; s += len + (s[len] == ',')) {
+		len = strcspn(s, ",");
+		if ((order = memchr(s, ':', len)) != NULL)
+			flen = (size_t)(order - s);
+		else
+			flen = len;
+
+		for (i = 0; sort_fields[i] != NULL; i++) {
+			if (strlen(sort_fields[i]) == flen &&
+			    strncmp(s, sort_fields[i], flen) == 0)
+				break;
+		}
+		if (sort_fields[i] == NULL || spec.n == SORT_MAX_KEYS)
+			return -1;
+		spec.field[spec.n] = (enum sort_field)i;
+
+		spec.desc[spec.n] = 0;
+		if (order != NULL) {
+			order++;
+			flen = len - (size_t)(order - s);
+			if (flen == 4 && strncmp(order, "desc", 4) == 0)
+				spec.desc[spec.n] = 1;
+			else if (flen != 3 || strncmp(order, "asc", 3) != 0)
+				return -1;
+		}
+		spec.n++;
+	}
+
+	return spec.n > 0 ? 0 : -1;
+}
+
+/*
+ * Return the collation key of a string, where every run of digits is
+ * prefixed by its number of significant digits so that numbers compare by
+ * value. Exit on memory allocation failure.
+ * @s: string
+ */
+static char *
+collate_key(const char *s)
+{
+	char *nat, *p, *key;
+	size_t len, digits;
+
+	/* a digit may take up to 3 characters: "7" -> "017" */
+	if ((nat = malloc(strlen(s) * 3 + 1)) == NULL)
+		goto nomem;
+
+	p = nat;
+	while (*s != '\0') {
+		if (*s < '0' || *s > '9') {
+			*p++ = *s++;
+			continue;
+		}
+		while (*s == '0' && s[1] >= '0' && s[1] <= '9')
+			s++;
+		digits = strspn(s, "0123456789");
+		len = digits > 99 ? 99 : digits;
+		*p++ = (char)('0' + len / 10);
+		*p++ = (char)('0' + len % 10);
+		(void)memcpy(p, s, digits);
+		p += digits;
+		s += digits;
+	}
+	*p = '\0';
+
+	len = strxfrm(NULL, nat, 0);
+	if ((key = malloc(len + 1)) == NULL)
+		goto nomem;
+	(void)strxfrm(key, nat, len + 1);
+	free(nat);
+
+	return key;
+
+nomem:
+	(void)fputs("Error while allocating memory to sort file systems\n",
+		stderr);
+	exit(EXIT_FAILURE);
+	/* NOTREACHED */
+}
+
+/*
+ * Compute the sort keys of a file system
+ * @row: row holding the file system
+ */
+static void
+make_keys(struct sort_row *row)
+{
+	const struct fsmntinfo *p = row->fmi;
+	union sort_value *v;
+	int i;
+
+	for (i = 0; i < spec.n; i++) {
+		v = &row->keys[i];
+		switch (spec.field[i]) {
+		case SORT_NAME:
+			v->str = collate_key(p->fsname);
+			break;
+		case SORT_TYPE:
+			v->str = collate_key(p->fstype);
+			break;
+		case SORT_MOUNT:
+			v->str = collate_key(p->mntdir);
+			break;
+		case SORT_OPTIONS:
+			v->str = collate_key(p->mntopts);
+			break;
+		case SORT_USAGE:
+			v->real = p->perctused;
+			break;
+		case SORT_USED:
+			v->num = p->used;
+			break;
+		case SORT_AVAIL:
+			v->num = p->avail;
+			break;
+		case SORT_TOTAL:
+			v->num = p->total;
+			break;
+		case SORT_INODES:
+			v->num = (uint64_t)p->files;
+			break;
+		case SORT_AVINODES: /* FALLTHROUGH */
+		default:
+#if defined(__linux__) || defined(__GLIBC__)
+			v->num = (uint64_t)p->favail;
+#else
+			v->num = (int64_t)p->ffree < 0 ? 0 : (uint64_t)p->ffree;
+#endif /* __linux__ */
+			break;
+		}
+	}
+}
+
+/*
+ * Free the collation keys of a row
+ * @row: row holding the file system
+ */
+static void
+free_keys(struct sort_row *row)
+{
+	int i;
+
+	for (i = 0; i < spec.n; i++) {
+		if (spec.field[i] <= SORT_OPTIONS)
+			free(row->keys[i].str);
+	}
+}
+
+/*
+ * Compare two rows on their sort keys, then on their position in the list
+ * @a: first row
+ * @b: second row
+ */
+static int
+rowcmp(const void *a, const void *b)
+{
+	const struct sort_row *ra = a;
+	const struct sort_row *rb = b;
+	const union sort_value *va, *vb;
+	int i, ret;
+
+	for (i = 0; i < spec.n; i++) {
+		va = &ra->keys[i];
+		vb = &rb->keys[i];
+		if (spec.field[i] <= SORT_OPTIONS)
+			ret = strcmp(va->str, vb->str);
+		else if (spec.field[i] == SORT_USAGE)
+			ret = (va->real > vb->real) - (va->real < vb->real);
+		else
+			ret = (va->num > vb->num) - (va->num < vb->num);
+		if (ret != 0)
+			return spec.desc[i] ? -ret : ret;
+	}
+
+	return (ra->index > rb->index) - (ra->index < rb->index);
+}
+
+/*
+ * Restore the order of a heap of rows which root is the last in order
+ * @heap: rows
+ * @n: number of rows
+ * @i: row which may be out of place
+ */
+static void
+sift_down(struct sort_row *heap, size_t n, size_t i)
+{
+	struct sort_row tmp;
+	size_t child;
+
+	while ((child = 2 * i + 1) < n) {
+		if (child + 1 < n && rowcmp(&heap[child + 1], &heap[child]) > 0)
+			child++;
+		if (rowcmp(&heap[child], &heap[i]) <= 0)
+			break;
+		tmp = heap[i];
+		heap[i] = heap[child];
+		heap[child] = tmp;
+		i = child;
+	}
+}
+
+/*
+ * Move the first k rows in order to the beginning of an array, sorted,
+ * without sorting the other ones: O(n log k) instead of O(n log n)
+ * @rows: rows
+ * @n: number of rows
+ * @k: number of rows to select, lower than n
+ */
+static void
+select_top(struct sort_row *rows, size_t n, size_t k)
+{
+	struct sort_row tmp;
+	size_t i;
+
+	/* the first k rows are a heap which root is the last one kept */
+	for (i = k / 2; i-- > 0;)
+		sift_down(rows, k, i);
+
+	for (i = k; i < n; i++) {
+		if (rowcmp(&rows[i], &rows[0]) >= 0)
+			continue;
+		tmp = rows[0];
+		rows[0] = rows[i];
+		rows[i] = tmp;
+		sift_down(rows, k, 0);
+	}
+
+	qsort(rows, k, sizeof(*rows), rowcmp);
+}
+
+/*
+ * Sort the file systems of a list which are not ignored as asked with -q.
+ * Ignored ones are moved to the end of the list.
+ * @lst: list of file systems
+ * @limit: if not 0, only the first limit file systems are sorted and the
+ *	   other ones follow them in no particular order
+ */
+void
+sort_list(struct list *lst, size_t limit)
+{
+	struct sort_row *rows;
+	struct fsmntinfo *p, *last = NULL;
+	struct fsmntinfo *ignored = NULL, **tail = &ignored;
+	size_t i, n = 0;
+
+	for (p = lst->head; p != NULL; p = p->next)
+		n++;
+	if (n == 0)
+		return;
+	/* names are collated according to the locale */
+	locale_init();
+	if ((rows = malloc(n * sizeof(*rows))) == NULL) {
+		(void)fputs("Error while allocating memory to sort file "
+			"systems\n", stderr);
+		exit(EXIT_FAILURE);
+	}
+
+	n = 0;
+	for (p = lst->head; p != NULL; p = p->next) {
+		if (p->ignored) {
+			*tail = last = p;
+			tail = &p->next;
+			continue;
+		}
+		rows[n].fmi = p;
+		rows[n].index = n;
+		make_keys(&rows[n]);
+		n++;
+	}
+	*tail = NULL;
+
+	if (limit > 0 && limit < n)
+		select_top(rows, n, limit);
+	else
+		qsort(rows, n, sizeof(*rows), rowcmp);
+
+	/* link the file systems again, in order */
+	tail = &lst->head;
+	for (i = 0; i < n; i++) {
+		*tail = rows[i].fmi;
+		tail = &rows[i].fmi->next;
+		free_keys(&rows[i]);
+	}
+	*tail = ignored;
+	if (last == NULL)
+		last = rows[n - 1].fmi;
+	lst->tail = last;
+
+	free(rows);
+}
+
+/*
+ * Start keeping the first k file systems in order among the ones pushed
+ * @heap: heap to start
+ * @k: number of file systems to keep, greater than 0
+ */
+void
+sort_heap_init(struct sort_heap *heap, size_t k)
+{
+	/* names are collated according to the locale */
+	locale_init();
+	if ((heap->rows = malloc(k * sizeof(*heap->rows))) == NULL) {
+		(void)fputs("Error while allocating memory to sort file "
+			"systems\n", stderr);
+		exit(EXIT_FAILURE);
+	}
+	heap->n = 0;
+	heap->k = k;
+	heap->npushed = 0;
+}
+
+/*
+ * Push a file system to a heap: it is kept if it is among the first ones in
+ * order so far, in which case the last one kept so far may be let go.
+ * Return the file system which is not kept, if any, NULL otherwise. It is
+ * up to the caller to free it.
+ * @heap: heap started with sort_heap_init
+ * @fmi: file system to push
+ */
+struct fsmntinfo *
+sort_heap_push(struct sort_heap *heap, struct fsmntinfo *fmi)
+{
+	struct sort_row row;
+	size_t i;
+
+	row.fmi = fmi;
+	row.index = heap->npushed++;
+	make_keys(&row);
+
+	if (heap->n < heap->k) {
+		heap->rows[heap->n++] = row;
+		/* only a full heap has to be in heap order */
+		if (heap->n == heap->k) {
+			for (i = heap->k / 2; i-- > 0;)
+				sift_down(heap->rows, heap->k, i);
+		}
+		return NULL;
+	}
+
+	/* the root is the last one kept: it is replaced by a better one */
+	if (rowcmp(&row, &heap->rows[0]) >= 0) {
+		free_keys(&row);
+		return fmi;
+	}
+	fmi = heap->rows[0].fmi;
+	free_keys(&heap->rows[0]);
+	heap->rows[0] = row;
+	sift_down(heap->rows, heap->k, 0);
+
+	return fmi;
+}
+
+/*
+ * Queue the file systems kept in a heap, in order, and free the heap
+ * @heap: heap started with sort_heap_init
+ * @lst: queue to append the file systems to
+ */
+void
+sort_heap_list(struct sort_heap *heap, struct list *lst)
+{
+	struct fsmntinfo **tail;
+	size_t i;
+
+	qsort(heap->rows, heap->n, sizeof(*heap->rows), rowcmp);
+
+	tail = lst->head == NULL ? &lst->head : &lst->tail->next;
+	for (i = 0; i < heap->n; i++) {
+		*tail = lst->tail = heap->rows[i].fmi;
+		tail = &heap->rows[i].fmi->next;
+		free_keys(&heap->rows[i]);
+	}
+	*tail = NULL;
+
+	free(heap->rows);
+	heap->rows = NULL;
+	heap->n = 0;
+}
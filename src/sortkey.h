@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef H_SORTKEY
+#define H_SORTKEY
+/*
+ * sortkey.h
+ *
+ * Sort file systems on several columns (-q)
+ */
+
+#include <stddef.h>
+
+#include "list.h"
+
+struct sort_row;
+
+/*
+ * First file systems in sort order among the ones pushed to it, kept while
+ * they are fetched instead of sorting all of them afterwards (--top)
+ */
+struct sort_heap {
+	struct sort_row *rows;	/* heap which root is the last one kept */
+	size_t n;		/* number of rows kept */
+	size_t k;		/* maximum number of rows kept */
+	size_t npushed;		/* number of file systems pushed so far */
+};
+
+/* function declaration */
+int sort_parse(const char *spec);
+void sort_list(struct list *lst, size_t limit);
+void sort_heap_init(struct sort_heap *heap, size_t k);
+struct fsmntinfo *sort_heap_push(struct sort_heap *heap,
+    struct fsmntinfo *fmi);
+void sort_heap_list(struct sort_heap *heap, struct list *lst);
+
+#endif /* ndef H_SORTKEY */
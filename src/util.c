@@ -38,40 +38,116 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#include <locale.h>
 #include <unistd.h>
 #include <string.h>
 #include <ctype.h>
 #include <time.h>
 #include <sys/ioctl.h>
-#include <math.h>
 
 #if defined(__sun)
 #include <termios.h> /* on solaris, this is where struct winsize is declared */
 #endif /* __sun */
 
+#include "column.h"
+#include "fsclass.h"
 #include "util.h"
+#include "export/display.h"
 
 #ifdef NLS_ENABLED
 #include <libintl.h>
 #endif
 
-/* static functions declaration */
-static int typecmp(const void *e1, const void *e2);
+/*
+ * Set up the locale and the translations, once, the first time they are
+ * needed: machine readable exports, which translate nothing, are spared the
+ * loading of the locale and of the message catalog
+ */
+void
+locale_init(void)
+{
+	static int done = 0;
 
+	if (done)
+		return;
+	done = 1;
+
+#ifdef NLS_ENABLED
+	if (setlocale(LC_ALL, "") == NULL)
+		(void)fputs("Locale cannot be set\n", stderr);
+	if (bindtextdomain(PACKAGE, LOCALEDIR) == NULL)
+		(void)fputs("Cannot bind locale\n", stderr);
+	if (bind_textdomain_codeset(PACKAGE, "") == NULL)
+		(void)fputs("Cannot bind locale codeset\n", stderr);
+	if (textdomain(PACKAGE) == NULL)
+		(void)fputs("Cannot set translation domain\n", stderr);
+#else
+	/* names are still sorted according to the locale (see -q) */
+	(void)setlocale(LC_COLLATE, "");
+#endif /* NLS_ENABLED */
+}
+
+#ifdef NLS_ENABLED
 /*
- * Return the number of digits in `n`
- * @n: a positive integer.
+ * Translate a message, setting up the translations first if needed
+ * @msgid: message to translate
  */
-static int
-count_digit(unsigned long long n)
+char *
+translate(const char *msgid)
 {
-	int i = 0;
+	locale_init();
+	return gettext(msgid);
+}
 
-	do {
-		++i;
-		n /= 10;
-	} while (n != 0);
-	return i;
+/*
+ * Translate a message which depends on a number, setting up the translations
+ * first if needed
+ * @msgid: message to translate, when the number is one
+ * @plural: message to translate otherwise
+ * @n: number
+ */
+char *
+translate_plural(const char *msgid, const char *plural, unsigned long n)
+{
+	locale_init();
+	return ngettext(msgid, plural, n);
+}
+#endif /* NLS_ENABLED */
+
+/*
+ * Units in which a size can be displayed, as selected with the -u option. The
+ * position in the table is the power of 1024 (or 1000 when using SI units) by
+ * which the size in bytes is divided.
+ */
+static const struct unit {
+	char flag;	/* -u sub option */
+	char symbol;	/* letter printed after the value */
+} units[] = {
+	{ 'b', 'B' },
+	{ 'k', 'K' },
+	{ 'm', 'M' },
+	{ 'g', 'G' },
+	{ 't', 'T' },
+	{ 'p', 'P' },
+	{ 'e', 'E' },
+	{ 'z', 'Z' },
+	{ 'y', 'Y' }
+};
+#define NUNITS ((int)(sizeof(units) / sizeof(units[0])))
+
+/*
+ * djb2 hash of a string
+ * @str: string to hash
+ */
+size_t
+strhash(const char *str)
+{
+	size_t h = 5381;
+
+	for (; *str != '\0'; str++)
+		h = h * 33 + (unsigned char)*str;
+
+	return h;
 }
 
 /*
@@ -113,249 +189,171 @@ strtrim(char *str)
 }
 
 /*
- * Shorten the input string to the specified length
- * @str: string to shorten
- * @len: the length the new string should be
+ * convert to human readable format and return the information i to format
+ * correctly the output. This one is intended to convert inodes to h-r
+ * @n: address of the number to convert
  */
-char *
-shortenstr(char *str, int len)
+int
+humanize_i(int64_t *n)
 {
-	int slen = (int)strlen(str);
-
-	if (slen < len + 1)
-		return str;
-
-	str += (slen - len);
+	int i = 0;
 
-	str[0] = '+';
+	while ((*n >= 10000 || *n <= -10000) && (i < 8)) {
+		*n /= 1000;
+		i++;
+	}
 
-	return str;
+    return i;
 }
 
 /*
- * Given a string S, returns the same string where the '_' character is replaced
- * by "\_". The returned string must be freed by the caller.
- * Return NULL if it fails.
+ * Print a letter according to the desired unit
+ * @out: stream to print to
+ * @i: index of the unit in the units table, as returned by size_exp() or
+ *     humanize_i()
+ * @mode: either 0 or 1. 1 mode should be used when called to print filesystem
+ *	  unit and 0 should be used when wanting to display "inodes unit"
  */
-char *
-sanitizestr(const char *str)
+void
+print_unit(FILE *out, int i, int mode)
 {
-	int i = 0;
-	int j = 0;
-	size_t nchars = 1; /* Trailing \0 */
-	char *new;
-
-	for (i = 0; str[i] != '\0'; i++) {
-		if (str[i] == '_')
-			nchars += 2;
-		else
-			nchars++;
-	}
-
-	if (i == (int)nchars) /* No '_' was found. */
-		return strdup(str);
-
-	if ((new = malloc(nchars)) == NULL)
-		return NULL;
-
-	for (i = 0; str[i] != '\0'; i++) {
-		if (str[i] == '_') {
-			new[j] = '\\';
-			new[j+1] = '_';
-			j += 2;
-		} else {
-			new[j] = str[i];
-			j++;
-		}
+	if (i < 0 || i >= NUNITS) {
+		(void)fputs("Could not print unit type\n", stderr);
+		return;
 	}
 
-	new[nchars-1] = '\0';
-
-	return new;
+	/* inodes are not a size in bytes: no unit when there is no prefix */
+	if (i == 0 && !mode)
+		(void)fputc(' ', out);
+	else
+		(void)fputc(units[i].symbol, out);
 }
 
 /*
- * convert to human readable format and return the information i to format
- * correctly the output.
- * @n: address of the number to convert
+ * Return the index in the units table of the unit in which `n` has to be
+ * displayed, according to unitflag. When using the human readable format, it
+ * is the smallest unit in which `n` is below 1000.
+ * @n: size in bytes, possibly negative
  */
 int
-humanize(double *n)
+size_exp(bigsize_t n)
 {
-	int i = 0;
-	double divider = 1024.0;
+	int i;
+	bigsize_t divider, base;
+
+	if (unitflag != 'h') {
+		for (i = 0; i < NUNITS; i++)
+			if (units[i].flag == unitflag)
+				return i;
+		(void)fputs("Could not convert unit size\n", stderr);
+		return 0;
+	}
+
+	if (n < 0)
+		n = -n;
 
 	/* when using SI units... */
-	if (mflag)
-		divider = 1000.0;
+	base = mflag ? 1000 : 1024;
 
-	while ((*n >= 1000) && (i < 8)) {
-		*n /= divider;
-		i++;
+	divider = 1;
+	for (i = 0; i < NUNITS - 1 && n / divider >= 1000; i++) {
+		if (divider > BIGSIZE_MAX / base)
+			break;
+		divider *= base;
 	}
 
-    return i;
+	return i;
 }
 
 /*
- * convert to human readable format and return the information i to format
- * correctly the output. This one is intended to convert inodes to h-r
- * @n: address of the number to convert
+ * Format the size `n` in the unit of index `exp` into `buf`, rounded to the
+ * nearest value with `prec` decimals (0 or 1). Everything is computed using
+ * integers so the result is exact whatever the size. When showing differences,
+ * positive values get an explicit "+" sign.
+ * @buf: output buffer, should be at least SIZE_BUFLEN long
+ * @len: length of buf
+ * @n: size in bytes, possibly negative
+ * @exp: index of the unit in the units table (see size_exp())
+ * @prec: number of decimals, either 0 or 1
  */
-int
-humanize_i(uint64_t *n)
+void
+fmt_size(char *buf, size_t len, bigsize_t n, int exp, int prec)
 {
-	int i = 0;
+	char digits[SIZE_BUFLEN];
+	char *p = digits + sizeof(digits);
+	const char *sign = "";
+	bigsize_t divider, base, whole, rem, q, r, part;
+	unsigned int tenths = 0;
+	int i;
 
-	while ((*n >= 10000) && (i < 8)) {
-		*n /= 1000;
-		i++;
+	if (n < 0) {
+		sign = "-";
+		n = -n;
+	} else if (diffflag && n > 0) {
+		sign = "+";
 	}
 
-    return i;
-}
+	base = mflag ? 1000 : 1024;
+	divider = 1;
+	for (i = 0; i < exp; i++) {
+		/* only happens when bigsize_t is 64 bits wide */
+		if (divider > BIGSIZE_MAX / base) {
+			n = 0;
+			break;
+		}
+		divider *= base;
+	}
 
-/*
- * Print a letter according to the desired unit
- * @i: should be the result of the humanize or humanize_i function when humanize
- *     is used
- * @mode: either 0 or 1. 1 mode should be used when called to print filesystem
- *	  unit and 0 should be used when wanting to display "inodes unit"
- */
-void
-print_unit(int i, int mode)
-{
-	switch (unitflag) {
-	case 'h':
-		switch (i) {
-		case 0: /* bytes */
-			if (mode)
-				(void)printf("B");
-			else
-				(void)printf(" ");
-			return;
-		case 1: /* Kio  or Ko */
-			(void)printf("K");
-			return;
-		case 2: /* Mio or Mo */
-			(void)printf("M");
-			return;
-		case 3: /* Gio or Go*/
-			(void)printf("G");
-			return;
-		case 4: /* Tio or To*/
-			(void)printf("T");
-			return;
-		case 5: /* Pio or Po*/
-			(void)printf("P");
-			return;
-		case 6: /* Eio or Eo*/
-			   (void)printf("E");
-			return;
-		case 7: /* Zio or Zo*/
-			(void)printf("Z");
-			return;
-		case 8: /* Yio or Yo*/
-			(void)printf("Y");
-			return;
-		default:
-			(void)fputs("Could not print unit type in"
-					" human-readable format\n", stderr);
-			return;
+	whole = n / divider;
+	rem = n % divider;
+	if (prec > 0) {
+		/*
+		 * rem * 10 overflows when bigsize_t is 64 bits wide and the
+		 * unit is an EiB or larger: with divider = q * 10 + r, the
+		 * rounded tenths are the largest t for which rem * 10 +
+		 * divider / 2 >= t * divider, that is rem >= t * q +
+		 * ceil((t * r - divider / 2) / 10), where nothing overflows
+		 */
+		q = divider / 10;
+		r = divider % 10;
+		for (; tenths < 10; tenths++) {
+			part = (bigsize_t)(tenths + 1) * r - divider / 2;
+			part = part > 0 ? (part + 9) / 10 : part / 10;
+			if (rem < (bigsize_t)(tenths + 1) * q + part)
+				break;
 		}
-	case 'b':
-		if (mode)
-			(void)printf("B");
-		else
-			(void)printf(" ");
-		return;
-	case 'k':
-		(void)printf("K");
-		return;
-	case 'm':
-		(void)printf("M");
-		return;
-	case 'g':
-		(void)printf("G");
-		return;
-	case 't':
-		(void)printf("T");
-		return;
-	case 'p':
-		(void)printf("P");
-		return;
-	case 'e':
-		(void)printf("E");
-		return;
-	case 'z':
-		(void)printf("Z");
-		return;
-	case 'y':
-		(void)printf("Y");
-		return;
-	default:
-		(void)fputs("Could not print unit type\n", stderr);
+		if (tenths == 10) {
+			whole++;
+			tenths = 0;
+		}
+	} else if (rem >= divider - divider / 2) {
+		whole++;
 	}
+
+	*--p = '\0';
+	do {
+		*--p = (char)('0' + (int)(whole % 10));
+		whole /= 10;
+	} while (whole != 0);
+
+	if (prec > 0)
+		(void)snprintf(buf, len, "%s%s.%u", sign, p, tenths);
+	else
+		(void)snprintf(buf, len, "%s%s", sign, p);
 }
 
 /*
- * Converts the argument to the correct unit
- * TODO: pretty crapy function... should do it in a smart way!
- * Plus there probably is some roundings errors...
- * Need to clean this crap ASAP
- * @n: number to convert
+ * Format the number of inodes `n` into `buf`. When showing differences,
+ * positive values get an explicit "+" sign.
+ * @buf: output buffer, should be at least SIZE_BUFLEN long
+ * @len: length of buf
+ * @n: number of inodes, possibly negative
  */
-double
-cvrt(double n)
+void
+fmt_count(char *buf, size_t len, int64_t n)
 {
-	switch (unitflag) {
-	case 'b':
-		return n;
-	case 'e':
-		if (mflag) /* 1000^6 */
-			return n / 1000000000000000000.0;
-		else /* 1024^6 */
-			return n / 1152921504606846976.0;
-	case 'g':
-		if (mflag) /* 1000^3 */
-			return n / 1000000000.0;
-		else /* 1024^3 */
-			return n / 1073741824.0;
-	case 'k':
-		if (mflag)
-			return n / 1000.0;
-		else
-			return n / 1024.0;
-	case 'm':
-		if (mflag) /* 1000^2 */
-			return n / 1000000.0;
-		else /* 1024^2 */
-			return n / 1048576.0;
-	case 'p':
-		if (mflag) /* 1000^5 */
-			return n / 1000000000000000.0;
-		else /* 1024^5 */
-			return n / 1125899906842624.0;
-	case 't':
-		if (mflag) /* 1000^4 */
-			return n / 1000000000000.0;
-		else /* 1024^4 */
-			return n / 1099511627776.0;
-	case 'y':
-		if (mflag) /* 1000^8 */
-			return n / 1000000000000000000000000.0;
-		else /* 1024^8 */
-			return n / 1208925819614629174706176.0;
-	case 'z':
-		if (mflag)
-			/* 1000^7 */
-			return n / 1000000000000000000000.0;
-		else /* 1024^7 */
-			return n / 1180591620717411303424.0;
-	default:
-		(void)fputs("Could not convert unit size\n", stderr);
-		return n;
-	}
+	(void)snprintf(buf, len, "%s%" PRId64, (diffflag && n > 0) ? "+" : "",
+		n);
 }
 
 /*
@@ -370,114 +368,27 @@ int
 fsfilter(const char *fs, const char *filter, int nm)
 {
 	int ret = 0; /* assume it should not be shown */
-	char *stropt;
-	char *strtmp;
-
-	if ((strtmp = strdup(filter)) == NULL) {
-		(void)fputs("Cannot duplicate filter\n", stderr);
-		exit(EXIT_FAILURE);
-		/* NOTREACHED */
-	}
+	size_t len;
 
-	stropt = strtok(strtmp, ",");
-	while (stropt != NULL) {
-		if (strncmp(fs, stropt, strlen(stropt)) == 0) {
+	/*
+	 * filter is a comma separated list of prefixes; walk it in place rather
+	 * than with strtok(3) so that it can be used from several threads
+	 */
+	while (*filter != '\0') {
+		len = strcspn(filter, ",");
+		if (len > 0 && strncmp(fs, filter, len) == 0) {
 			ret = 1;
 			break;
 		}
-		stropt = strtok(NULL, ",");
+		filter += len;
+		if (*filter == ',')
+			filter++;
 	}
-	free(strtmp);
 
 	/* reverse result if negative matching activated */
 	return nm ? !ret : ret;
 }
 
-/*
- * Compares regarding qflag
- * @a: first element of comparison
- * @b: second element of comparison
- */
-int
-cmp(struct fsmntinfo *a, struct fsmntinfo *b)
-{
-	switch(qflag) {
-	case 1:
-		return strcmp(a->fsname, b->fsname);
-	case 2:
-		return strcmp(a->fstype, b->fstype);
-	case 3:
-		return strcmp(a->mntdir, b->mntdir);
-	default:
-		return -1;
-	}
-}
-
-/*
- * Perform a mergesort algorithm to sort the list by ascending
- * Results depends on what was chosen for comparison (fsname, fstype or mntdir)
- * @fmi: pointer to the first element of the linked list structure to be sorted
- */
-struct fsmntinfo *
-msort(struct fsmntinfo *fmi)
-{
-	struct fsmntinfo *tail, *left, *right, *next;
-	int nmerges, lsize, rsize;
-	int size = 1;
-
-	/*
-	 * trivial case: list is sorted if there is no or only one element in
-	 * the linked list
-	 */
-	if (fmi == NULL || fmi->next == NULL)
-		return fmi;
-
-	do {
-		nmerges = 0;
-		left = fmi;
-		tail = fmi = NULL;
-		while (left) {
-			nmerges++;
-			right = left;
-			lsize = 0;
-			rsize = size;
-			while (right && lsize < size) {
-				lsize++;
-				right = right->next;
-			}
-			while (lsize > 0 || (rsize > 0 && right)) {
-				if (!lsize) {
-					next = right;
-					right = right->next;
-					rsize--;
-				} else if (!rsize || !right) {
-					next = left;
-					left = left->next;
-					lsize--;
-				} else if (cmp(left, right) <= 0) {
-					next = left;
-					left = left->next;
-					lsize--;
-				} else {
-					next = right;
-					right = right->next;
-					rsize--;
-				}
-				if (tail)
-					tail->next = next;
-				else
-					fmi = next;
-				tail = next;
-			}
-			left = right;
-		}
-		tail->next = NULL;
-		size *= 2;
-	} while (nmerges > 1);
-
-	return fmi;
-}
-
 /*
  * Get the with of TTY and retun it.
  * 0 is returned if stdout is not a tty.
@@ -505,19 +416,11 @@ init_maxwidths(void)
 {
 	/*
 	 * init min width to header names and width of the graph bar + 1 to have
-	 * a space between each column.
+	 * a space between each column. Columns which are not shown are not
+	 * taken into account anyway.
 	 */
-	max.fsname	= (int)strlen(_("FILESYSTEM")) + 1;
-	max.fstype	= Tflag ? (int)strlen(_("TYPE")) + 1 : 0;
-	max.bar		= bflag ? 0 : wflag ? GRAPHBAR_WIDE : GRAPHBAR_SHORT;
-	max.perctused	= (int)strlen(_("%USED")) + 1;
-	max.used	= dflag ? (int)strlen(_("USED")) + 1 : 0;
-	max.avail	= (int)strlen(_("AVAILABLE")) + 1;
-	max.total	= (int)strlen(_("TOTAL")) + 1;
-	max.nbinodes	= iflag ? (int)strlen(_("#INODES")) + 1 : 0;
-	max.avinodes	= iflag ? (int)strlen(_("AV.INODES")) + 1 : 0;
-	max.mntdir	= Mflag ? 0 : (int)strlen(_("MOUNTED ON")) + 1;
-	max.mntopts	= oflag ? (int)strlen(_("MOUNT OPTIONS")) + 1: 0;
+	column_title_widths();
+	max.bar		= wflag ? GRAPHBAR_WIDE : GRAPHBAR_SHORT;
 }
 
 /*
@@ -527,45 +430,21 @@ init_maxwidths(void)
  * should be computed.
  */
 int
-get_req_width(double fs_size)
+get_req_width(bigsize_t fs_size)
 {
-	long i, index;
+	char buf[SIZE_BUFLEN];
 	int req_width, req_min;
-	const char *unitstring = "bkmgtpezy";
-	char *match;
 
 	/* spaces for the unit symbol and floating point */
 	req_min = 4;
-	req_width = req_min;
-
-	if (unitflag == 'h') {
-		req_width += 3;
-	} else {
-		if ((match = strchr(unitstring, unitflag)) == NULL) {
-			(void)fputs(_("Cannot compute required width\n"),
-			stderr);
-			return -1;
-		}
 
-		if ((fs_size > 0.0) && isnormal(fs_size)) {
-			/*
-			 * casting from double to int shall be safe here since
-			 * log10 of even the largest possible double value (ie:
-			 * around 309 in most cases) shall fit into an integer
-			 */
-			req_width += (int)(1.0 + trunc(log10(fs_size)));
-		}
+	/* differences are signed */
+	if (unitflag == 'h')
+		return req_min + 3 + (diffflag ? 1 : 0);
 
-		index = match - unitstring + 1;
-		for (i = 1; i < index; i++) {
-			/*
-			 * displaying the same number in a "greater" unit (cf
-			 * unitstring) requires 3 digits less than what was
-			 * previously required
-			 */
-			req_width -= 3;
-		}
-	}
+	/* + 1 for the unit symbol and + 1 for a space between each column */
+	fmt_size(buf, sizeof(buf), fs_size, size_exp(fs_size), 1);
+	req_width = (int)strlen(buf) + 2;
 
 	return (req_width < req_min) ? req_min : req_width;
 }
@@ -580,87 +459,64 @@ update_maxwidth(struct fsmntinfo *fmi)
 	if (!aflag && (is_mnt_ignore(fmi) == 1))
 		return;
 
-	/* + 1 for a space between each column */
-	max.fsname = imax((int)strlen(fmi->fsname) + 1, max.fsname);
-	max.fstype = imax((int)strlen(fmi->fstype) + 1, max.fstype);
-
-	if (!Mflag)
-		max.mntdir = imax((int)strlen(fmi->mntdir) + 1, max.mntdir);
-
-	if (oflag)
-		max.mntopts = imax((int)strlen(fmi->mntopts) + 1, max.mntopts);
+	update_row_maxwidth(fmi);
+}
 
-	if (dflag)
-		max.used = imax(get_req_width(fmi->used), max.used);
-	max.avail = imax(get_req_width(fmi->avail), max.avail);
-	max.total = imax(get_req_width(fmi->total), max.total);
+/*
+ * Update values of the maxwidth structure for a row which is always shown,
+ * whatever the file system it describes.
+ * @fmi: structure containing the information of the row
+ */
+void
+update_row_maxwidth(const struct fsmntinfo *fmi)
+{
+	struct row r;
 
-	if (iflag) {
-		max.nbinodes = imax(2 + count_digit(fmi->files), max.nbinodes);
-		max.avinodes = imax(3 + count_digit(fmi->ffree), max.avinodes);
-	}
+	row_of_fmi(&r, fmi);
+	row_maxwidth(&r);
 }
 
 /*
- * auto-adjust options based on the size needed to display the information
- * @lst: list containing info
+ * auto-adjust the columns shown based on the size needed to display the
+ * information
+ * @sdisp: display interface, which columns are adjusted
  * @tty_width: width of the output terminal
  */
 void
-auto_adjust(int tty_width)
+auto_adjust(struct display *sdisp, int tty_width)
 {
-	int req_width;
+	/* columns given up first, a group at a time */
+	static const enum column_id drop_order[] = {
+		COL_BAR, COL_NCOLUMNS,
+		COL_USED, COL_NCOLUMNS,
+		COL_FSTYPE, COL_NCOLUMNS,
+		COL_NAMESPACES, COL_NCOLUMNS,
+		COL_TARGET, COL_NCOLUMNS,
+		COL_ITOTAL, COL_IAVAIL, COL_IUSED, COL_IPCENT, COL_NCOLUMNS,
+		COL_OPTIONS, COL_NCOLUMNS
+	};
+	int req_width = 0;
+	size_t i;
 
-	req_width = max.fsname + max.fstype + max.bar + max.perctused + max.used
-		    + max.avail + max.total + max.nbinodes + max.avinodes
-		    + max.mntdir + max.mntopts;
+	for (i = 0; i < sdisp->ncolumns; i++)
+		req_width += *sdisp->columns[i]->width;
 
 	if (tty_width > req_width)
 		return; /* nothing to adjust */
 
 	(void)fputs(_("WARNING: TTY too narrow. Some options have been disabled"
 		" to make dfc output fit (use -f to override).\n"), stderr);
-	if (!bflag) {
-		if (wflag) {
-			wflag = 0;
-			req_width -= GRAPHBAR_WIDE - GRAPHBAR_SHORT;
-			if (tty_width >= req_width)
-				return;
-		}
-		bflag = 1;
-		req_width -= GRAPHBAR_SHORT;
-		if (tty_width >= req_width)
-			return;
-	}
-	if (dflag) {
-		dflag = 0;
-		req_width -= max.used;
-		if (tty_width >= req_width)
-			return;
-	}
-	if (Tflag) {
-		Tflag = 0;
-		req_width -= max.fstype;
-		if (tty_width >= req_width)
-			return;
-	}
-	if (!Mflag) {
-		Mflag = 1;
-		req_width -= max.mntdir;
-		if (tty_width >= req_width)
-			return;
-	}
-	if (iflag) {
-		iflag = 0;
-		req_width -= max.nbinodes;
-		req_width -= max.avinodes;
+	if (max.bar == GRAPHBAR_WIDE && column_shown(sdisp, COL_BAR)) {
+		sdisp->shortbar = 1;
+		max.bar = GRAPHBAR_SHORT;
+		req_width -= GRAPHBAR_WIDE - GRAPHBAR_SHORT;
 		if (tty_width >= req_width)
 			return;
 	}
-	if (oflag) {
-		oflag = 0;
-		req_width -= max.mntopts;
-		if (tty_width >= req_width)
+	for (i = 0; i < sizeof(drop_order) / sizeof(drop_order[0]); i++) {
+		if (drop_order[i] != COL_NCOLUMNS)
+			req_width -= column_drop(sdisp, drop_order[i]);
+		else if (tty_width >= req_width)
 			return;
 	}
 
@@ -775,17 +631,6 @@ chk_html_colorcode(const char *color)
 }
 
 
-/*
- * Comparison function needed for is_pseudofs and is_remotefs bsearch call.
- */
-static int
-typecmp(const void *e1, const void *e2)
-{
-	const char *s1 = *(const char * const *)e1;
-	const char *s2 = *(const char * const *)e2;
-	return strcmp(s1, s2);
-}
-
 /*
  * Determine if fsname is a pseudo filesystem or not.
  * This function is useless under *BSD and OSX systems.
@@ -794,77 +639,21 @@ typecmp(const void *e1, const void *e2)
 int
 is_pseudofs(const char *type)
 {
-	/* keep sorted for binary search */
-	static const char *pseudofs[] = {
-		"anon_inodefs",
-		"autofs",
-		"bdev",
-		"binfmt_misc",
-		"cgroup",
-		"configfs",
-		"cpuset",
-		"debugfs",
-		"devfs",
-		"devpts",
-		"devtmpfs",
-		"dlmfs",
-		"fdescfs",
-		"fuse.gvfs-fuse-daemon",
-		"fusectl",
-		"hugetlbfs",
-		"linprocfs",
-		"mqueue",
-		"nfsd",
-		"none",
-		"pipefs",
-		"proc",
-		"pstore",
-		"ramfs",
-		"rootfs",
-		"rpc_pipefs",
-		"securityfs",
-		"sockfs",
-		"spufs",
-		"sysfs",
-		"tmpfs"
-	};
-
 	if (!type)
 		return 0;
 
-	if (bsearch(&type, pseudofs, sizeof(pseudofs) / sizeof(pseudofs[0]),
-		sizeof(*pseudofs), typecmp) == NULL) {
-		return 0;
-	}
-
-	return 1;
+	return (fsclass_get(type).flags & FSCLASS_PSEUDO) != 0;
 }
 
+/*
+ * Determine if fsname is a remote filesystem or not.
+ * Return 1 if it is, 0 otherwise.
+ */
 int
 is_remotefs(const char *type)
 {
-	/* keep sorted for binary search */
-	static const char *remotefs[] = {
-		"afs",
-		"cifs",
-		"coda",
-		"ftpfs",
-		"fuse.sshfs",
-		"mfs",
-		"ncpfs",
-		"nfs",
-		"nfs4",
-		"smbfs",
-		"sshfs"
-	};
-
 	if (!type)
 		return 0;
 
-	if (bsearch(&type, remotefs, sizeof(remotefs) / sizeof(remotefs[0]),
-		sizeof(*remotefs), typecmp) == NULL) {
-		return 0;
-	}
-
-	return 1;
+	return (fsclass_get(type).flags & FSCLASS_REMOTE) != 0;
 }
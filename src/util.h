@@ -37,28 +37,38 @@
  * Util functions
  */
 #include <inttypes.h>
+#include <stdio.h>
 
 #include "extern.h"
 #include "list.h"
 #include "platform/services.h"
 
+/*
+ * Buffer length large enough to hold any size formatted by fmt_size(), that is
+ * a sign, the 39 digits of the largest bigsize_t, a decimal point, one decimal
+ * and the terminating null byte. It also fits any count formatted by
+ * fmt_count().
+ */
+#define SIZE_BUFLEN 48
+
+struct display;
+
 /* function declaration */
+size_t strhash(const char *str);
 int imax(int a, int b);
 char * strtrim(char *str);
-char * shortenstr(char *str, int len);
-char * sanitizestr(const char *str);
-int humanize(double *n);
-int humanize_i(uint64_t *n);
-void print_unit(int i, int mode);
-double cvrt(double n);
+int humanize_i(int64_t *n);
+void print_unit(FILE *out, int i, int mode);
+int size_exp(bigsize_t n);
+void fmt_size(char *buf, size_t len, bigsize_t n, int exp, int prec);
+void fmt_count(char *buf, size_t len, int64_t n);
 int fsfilter(const char *fs, const char *filter, int nm);
-int cmp(struct fsmntinfo *a, struct fsmntinfo *b);
-struct fsmntinfo * msort(struct fsmntinfo *fmi);
 int getttywidth(void);
 void init_maxwidths(void);
-int get_req_width(double fs_size);
+int get_req_width(bigsize_t fs_size);
 void update_maxwidth(struct fsmntinfo *fmi);
-void auto_adjust(int tty_width);
+void update_row_maxwidth(const struct fsmntinfo *fmi);
+void auto_adjust(struct display *sdisp, int tty_width);
 char * fetchdate(void);
 const char * colortostr(int color);
 int colortoint(const char *col);
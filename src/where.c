@@ -0,0 +1,640 @@
+/*
+ * Copyright (c) 2026, Robin Hahling
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the author nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * where.c
+ *
+ * Compile the expression given to --where, such as
+ *	use% > 85 && type != "tmpfs" && opts ~ "rw"
+ * into a postfix program, once, and run it for every file system with a
+ * fixed size stack, without allocating memory.
+ *
+ * Comparisons on the columns of the mount table (name, type, mount, opts) can
+ * be decided before a file system is stated; the other ones are unknown
+ * until then. The program is thus evaluated with three valued logic, so that
+ * file systems which cannot match whatever their statistics are never
+ * stated (see where_match_mount).
+ */
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "extern.h"
+#include "where.h"
+
+#ifdef NLS_ENABLED
+#include <libintl.h>
+#endif
+
+/* maximum number of comparisons and depth of the stack */
+#define WHERE_MAX_INSNS	128
+#define WHERE_MAX_DEPTH	32
+
+/* results of the evaluation of a condition */
+#define W_FALSE		0
+#define W_TRUE		1
+#define W_UNKNOWN	2
+
+/* columns, string ones first */
+enum where_field {
+	WF_NAME = 0,
+	WF_TYPE,
+	WF_MOUNT,
+	WF_OPTS,
+	WF_NSTR,		/* number of string columns */
+	WF_USAGE = WF_NSTR,
+	WF_USED,
+	WF_AVAIL,
+	WF_TOTAL,
+	WF_INODES,
+	WF_AVINODES,
+	WF_NFIELDS
+};
+
+static const struct {
+	const char *name;
+	enum where_field field;
+} where_fields[] = {
+	{ "name",	WF_NAME },
+	{ "type",	WF_TYPE },
+	{ "mount",	WF_MOUNT },
+	{ "opts",	WF_OPTS },
+	{ "options",	WF_OPTS },
+	{ "use%",	WF_USAGE },
+	{ "usage",	WF_USAGE },
+	{ "used",	WF_USED },
+	{ "avail",	WF_AVAIL },
+	{ "total",	WF_TOTAL },
+	{ "inodes",	WF_INODES },
+	{ "avinodes",	WF_AVINODES },
+	{ NULL,		WF_NFIELDS }
+};
+
+enum where_op {
+	WO_CMP,		/* push the result of a comparison */
+	WO_AND,
+	WO_OR,
+	WO_NOT
+};
+
+enum where_cmp {
+	WC_EQ,
+	WC_NE,
+	WC_LT,
+	WC_LE,
+	WC_GT,
+	WC_GE,
+	WC_MATCH,	/* string contains */
+	WC_NMATCH	/* string does not contain */
+};
+
+struct where_insn {
+	enum where_op op;
+	enum where_field field;
+	enum where_cmp cmp;
+	double num;		/* value compared to a numeric column */
+	const char *str;	/* value compared to a string column */
+};
+
+/* compiled expression */
+static struct {
+	char *buf;		/* copy of the expression holding strings */
+	struct where_insn code[WHERE_MAX_INSNS];
+	int n;
+} prog;
+
+/* state of the parser */
+struct where_parser {
+	char *s;		/* next character to read */
+	int depth;		/* depth of the stack after the code so far */
+	const char *err;
+};
+
+/* static function declaration */
+static void skip_blanks(struct where_parser *ps);
+static int accept(struct where_parser *ps, const char *tok);
+static int emit(struct where_parser *ps, const struct where_insn *insn);
+static int parse_or(struct where_parser *ps);
+static int parse_and(struct where_parser *ps);
+static int parse_unary(struct where_parser *ps);
+static int parse_cmp(struct where_parser *ps);
+static int parse_string(struct where_parser *ps, struct where_insn *insn);
+static int parse_number(struct where_parser *ps, struct where_insn *insn);
+static int test(enum where_cmp cmp, int diff);
+static int compare_str(const struct where_insn *insn, const char *str);
+static int compare_num(const struct where_insn *insn, double num);
+static int run(const char *const strs[], const double *nums);
+
+/*
+ * Skip the blanks at the current position of the parser
+ * @ps: parser
+ */
+static void
+skip_blanks(struct where_parser *ps)
+{
+	while (isspace((unsigned char)*ps->s))
+		ps->s++;
+}
+
+/*
+ * Consume a token if it is at the current position of the parser
+ * Return 1 if it was, 0 otherwise.
+ * @ps: parser
+ * @tok: token
+ */
+static int
+accept(struct where_parser *ps, const char *tok)
+{
+	size_t len = strlen(tok);
+
+	skip_blanks(ps);
+	if (strncmp(ps->s, tok, len) != 0)
+		return 0;
+	ps->s += len;
+
+	return 1;
+}
+
+/*
+ * Append an instruction to the program, keeping track of the depth of the
+ * stack it needs
+ * Return -1 if the expression is too long, 0 otherwise.
+ * @ps: parser
+ * @insn: instruction
+ */
+static int
+emit(struct where_parser *ps, const struct where_insn *insn)
+{
+	if (prog.n == WHERE_MAX_INSNS) {
+		ps->err = "expression too long";
+		return -1;
+	}
+	prog.code[prog.n++] = *insn;
+
+	if (insn->op == WO_CMP)
+		ps->depth++;
+	else if (insn->op != WO_NOT)
+		ps->depth--;
+	if (ps->depth > WHERE_MAX_DEPTH) {
+		ps->err = "expression too deep";
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * or := and ( "||" and )*
+ * @ps: parser
+ */
+static int
+parse_or(struct where_parser *ps)
+{
+	struct where_insn insn = { WO_OR, WF_NAME, WC_EQ, 0.0, NULL };
+
+	if (parse_and(ps) == -1)
+		return -1;
+	while (accept(ps, "||")) {
+		if (parse_and(ps) == -1 || emit(ps, &insn) == -1)
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * and := unary ( "&&" unary )*
+ * @ps: parser
+ */
+static int
+parse_and(struct where_parser *ps)
+{
+	struct where_insn insn = { WO_AND, WF_NAME, WC_EQ, 0.0, NULL };
+
+	if (parse_unary(ps) == -1)
+		return -1;
+	while (accept(ps, "&&")) {
+		if (parse_unary(ps) == -1 || emit(ps, &insn) == -1)
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * unary := "!" unary | "(" or ")" | cmp
+ * @ps: parser
+ */
+static int
+parse_unary(struct where_parser *ps)
+{
+	struct where_insn insn = { WO_NOT, WF_NAME, WC_EQ, 0.0, NULL };
+
+	skip_blanks(ps);
+	if (ps->s[0] == '!' && ps->s[1] != '=' && ps->s[1] != '~') {
+		ps->s++;
+		if (parse_unary(ps) == -1)
+			return -1;
+		return emit(ps, &insn);
+	}
+	if (accept(ps, "(")) {
+		if (parse_or(ps) == -1)
+			return -1;
+		if (!accept(ps, ")")) {
+			ps->err = "missing )";
+			return -1;
+		}
+		return 0;
+	}
+
+	return parse_cmp(ps);
+}
+
+/*
+ * cmp := column operator value
+ * @ps: parser
+ */
+static int
+parse_cmp(struct where_parser *ps)
+{
+	static const struct {
+		const char *tok;
+		enum where_cmp cmp;
+	} ops[] = {
+		/* longest first */
+		{ "==", WC_EQ },
+		{ "!=", WC_NE },
+		{ "<=", WC_LE },
+		{ ">=", WC_GE },
+		{ "!~", WC_NMATCH },
+		{ "<", WC_LT },
+		{ ">", WC_GT },
+		{ "~", WC_MATCH },
+		{ "=", WC_EQ },
+		{ NULL, WC_EQ }
+	};
+	struct where_insn insn = { WO_CMP, WF_NAME, WC_EQ, 0.0, NULL };
+	size_t len;
+	int i;
+
+	skip_blanks(ps);
+	len = 0;
+	while (isalnum((unsigned char)ps->s[len]) || ps->s[len] == '%' ||
+	    ps->s[len] == '_')
+		len++;
+	for (i = 0; where_fields[i].name != NULL; i++) {
+		if (strlen(where_fields[i].name) == len &&
+		    strncmp(ps->s, where_fields[i].name, len) == 0)
+			break;
+	}
+	if (where_fields[i].name == NULL) {
+		ps->err = "unknown column";
+		return -1;
+	}
+	insn.field = where_fields[i].field;
+	ps->s += len;
+
+	for (i = 0; ops[i].tok != NULL; i++) {
+		if (accept(ps, ops[i].tok))
+			break;
+	}
+	if (ops[i].tok == NULL) {
+		ps->err = "missing operator";
+		return -1;
+	}
+	insn.cmp = ops[i].cmp;
+
+	skip_blanks(ps);
+	if (insn.field < WF_NSTR) {
+		if (insn.cmp != WC_EQ && insn.cmp != WC_NE &&
+		    insn.cmp != WC_MATCH && insn.cmp != WC_NMATCH) {
+			ps->err = "strings can only be compared with ==, !=, "
+				"~ and !~";
+			return -1;
+		}
+		if (parse_string(ps, &insn) == -1)
+			return -1;
+	} else {
+		if (insn.cmp == WC_MATCH || insn.cmp == WC_NMATCH) {
+			ps->err = "numbers cannot be compared with ~ and !~";
+			return -1;
+		}
+		if (parse_number(ps, &insn) == -1)
+			return -1;
+	}
+
+	return emit(ps, &insn);
+}
+
+/*
+ * Parse a string between double quotes, in which \" and \\ stand for " and \.
+ * The string is stored in place, in the copy of the expression.
+ * @ps: parser
+ * @insn: comparison to set the value of
+ */
+static int
+parse_string(struct where_parser *ps, struct where_insn *insn)
+{
+	char *dst;
+
+	if (*ps->s != '"') {
+		ps->err = "expected a string between double quotes";
+		return -1;
+	}
+	insn->str = dst = ++ps->s;
+	while (*ps->s != '"') {
+		if (*ps->s == '\0') {
+			ps->err = "missing closing double quote";
+			return -1;
+		}
+		if (*ps->s == '\\' && ps->s[1] != '\0')
+			ps->s++;
+		*dst++ = *ps->s++;
+	}
+	/* overwrites at most the closing quote */
+	*dst = '\0';
+	ps->s++;
+
+	return 0;
+}
+
+/*
+ * Parse a number, optionally followed by a unit (K, M, G, T, P or E, powers
+ * of 1024) or by "%"
+ * @ps: parser
+ * @insn: comparison to set the value of
+ */
+static int
+parse_number(struct where_parser *ps, struct where_insn *insn)
+{
+	static const char units[] = "KMGTPE";
+	const char *u;
+	char *end;
+	long i;
+
+	errno = 0;
+	insn->num = strtod(ps->s, &end);
+	if (end == ps->s || errno != 0) {
+		ps->err = "expected a number";
+		return -1;
+	}
+	ps->s = end;
+
+	if (*ps->s != '\0' &&
+	    (u = strchr(units, toupper((unsigned char)*ps->s))) != NULL) {
+		for (i = u - units; i >= 0; i--)
+			insn->num *= 1024.0;
+		ps->s++;
+	} else if (*ps->s == '%') {
+		ps->s++;
+	}
+
+	return 0;
+}
+
+/*
+ * Compile an expression, replacing the previous one
+ * Return -1 on syntax error (which is reported), 0 otherwise.
+ * @expr: expression
+ */
+int
+where_compile(const char *expr)
+{
+	struct where_parser ps;
+
+	free(prog.buf);
+	prog.n = 0;
+	if ((prog.buf = strdup(expr)) == NULL) {
+		(void)fputs("Error while allocating memory to compile the "
+			"expression\n", stderr);
+		exit(EXIT_FAILURE);
+		/* NOTREACHED */
+	}
+
+	ps.s = prog.buf;
+	ps.depth = 0;
+	ps.err = NULL;
+	if (parse_or(&ps) == 0) {
+		skip_blanks(&ps);
+		if (*ps.s == '\0')
+			return 0;
+		ps.err = "unexpected characters";
+	}
+
+	(void)fprintf(stderr, _("--where: %s at \"%s\"\n"), ps.err,
+		expr + (ps.s - prog.buf));
+	prog.n = 0;
+
+	return -1;
+}
+
+/*
+ * Tell whether a comparison holds
+ * Return 1 if it does, 0 otherwise.
+ * @cmp: comparison
+ * @diff: negative, zero or positive if the column is lower than, equal to or
+ *	  greater than the value
+ */
+static int
+test(enum where_cmp cmp, int diff)
+{
+	switch (cmp) {
+	case WC_NE: /* FALLTHROUGH */
+	case WC_NMATCH:
+		return diff != 0;
+	case WC_LT:
+		return diff < 0;
+	case WC_LE:
+		return diff <= 0;
+	case WC_GT:
+		return diff > 0;
+	case WC_GE:
+		return diff >= 0;
+	case WC_EQ: /* FALLTHROUGH */
+	case WC_MATCH: /* FALLTHROUGH */
+	default:
+		return diff == 0;
+	}
+}
+
+/*
+ * Compare a string column
+ * Return 1 if the comparison holds, 0 otherwise.
+ * @insn: comparison
+ * @str: value of the column
+ */
+static int
+compare_str(const struct where_insn *insn, const char *str)
+{
+	/* "contains" is "equal" to the part of the column which matches */
+	if (insn->cmp == WC_MATCH || insn->cmp == WC_NMATCH)
+		return test(insn->cmp, strstr(str, insn->str) == NULL);
+
+	return test(insn->cmp, strcmp(str, insn->str));
+}
+
+/*
+ * Compare a numeric column
+ * Return 1 if the comparison holds, 0 otherwise.
+ * @insn: comparison
+ * @num: value of the column
+ */
+static int
+compare_num(const struct where_insn *insn, double num)
+{
+	return test(insn->cmp, (num > insn->num) - (num < insn->num));
+}
+
+/*
+ * Run the program
+ * Return W_TRUE, W_FALSE or W_UNKNOWN if the result depends on the numeric
+ * columns and they are not known.
+ * @strs: string columns
+ * @nums: numeric columns, NULL if they are not known
+ */
+static int
+run(const char *const strs[], const double *nums)
+{
+	const struct where_insn *insn;
+	unsigned char stack[WHERE_MAX_DEPTH];
+	int sp = 0;
+	int i, a, b, r;
+
+	if (prog.n == 0)
+		return W_TRUE;
+
+	for (i = 0; i < prog.n; i++) {
+		insn = &prog.code[i];
+		switch (insn->op) {
+		case WO_AND:
+			b = stack[--sp];
+			a = stack[sp - 1];
+			if (a == W_FALSE || b == W_FALSE)
+				r = W_FALSE;
+			else if (a == W_TRUE && b == W_TRUE)
+				r = W_TRUE;
+			else
+				r = W_UNKNOWN;
+			stack[sp - 1] = (unsigned char)r;
+			break;
+		case WO_OR:
+			b = stack[--sp];
+			a = stack[sp - 1];
+			if (a == W_TRUE || b == W_TRUE)
+				r = W_TRUE;
+			else if (a == W_FALSE && b == W_FALSE)
+				r = W_FALSE;
+			else
+				r = W_UNKNOWN;
+			stack[sp - 1] = (unsigned char)r;
+			break;
+		case WO_NOT:
+			if (stack[sp - 1] != W_UNKNOWN)
+				stack[sp - 1] = !stack[sp - 1];
+			break;
+		case WO_CMP: /* FALLTHROUGH */
+		default:
+			if (insn->field < WF_NSTR)
+				r = compare_str(insn, strs[insn->field]);
+			else if (nums == NULL)
+				r = W_UNKNOWN;
+			else
+				r = compare_num(insn,
+					nums[insn->field - WF_NSTR]);
+			stack[sp++] = (unsigned char)r;
+			break;
+		}
+	}
+
+	return stack[0];
+}
+
+/*
+ * Tell whether a file system matches the expression given to --where
+ * Return 1 if it does (or if there is no expression), 0 otherwise.
+ * @p: file system
+ */
+int
+where_match(const struct fsmntinfo *p)
+{
+	const char *strs[WF_NSTR];
+	double nums[WF_NFIELDS - WF_NSTR];
+
+	if (prog.n == 0)
+		return 1;
+
+	strs[WF_NAME]  = p->fsname;
+	strs[WF_TYPE]  = p->fstype;
+	strs[WF_MOUNT] = p->mntdir;
+	strs[WF_OPTS]  = p->mntopts;
+
+	nums[WF_USAGE - WF_NSTR]  = p->perctused;
+	nums[WF_USED - WF_NSTR]   = (double)p->used;
+	nums[WF_AVAIL - WF_NSTR]  = (double)p->avail;
+	nums[WF_TOTAL - WF_NSTR]  = (double)p->total;
+	nums[WF_INODES - WF_NSTR] = (double)p->files;
+#if defined(__linux__) || defined(__GLIBC__)
+	nums[WF_AVINODES - WF_NSTR] = (double)p->favail;
+#else
+	nums[WF_AVINODES - WF_NSTR] = (double)p->ffree;
+#endif /* __linux__ */
+
+	return run(strs, nums) == W_TRUE;
+}
+
+/*
+ * Tell whether a file system may match the expression given to --where,
+ * knowing only its entry in the mount table, so that it is not stated if it
+ * cannot
+ * Return 0 if it cannot match, 1 otherwise.
+ * @fsname: name of the file system
+ * @fstype: type of the file system
+ * @mntdir: mount point
+ * @mntopts: mount options
+ */
+int
+where_match_mount(const char *fsname, const char *fstype, const char *mntdir,
+    const char *mntopts)
+{
+	const char *strs[WF_NSTR];
+
+	if (prog.n == 0)
+		return 1;
+
+	strs[WF_NAME]  = fsname;
+	strs[WF_TYPE]  = fstype;
+	strs[WF_MOUNT] = mntdir;
+	strs[WF_OPTS]  = mntopts;
+
+	return run(strs, NULL) != W_FALSE;
+}